@@ -0,0 +1,406 @@
+/**
+ * @file        basicwatermodel.hpp
+ * 
+ * @brief       Declaration of the water diffusion model with a custom precision.
+ * 
+ * @details     This file contains the declaration of a class template that evaluates
+ *              the water diffusion model storing its state in a given scalar type,
+ *              and of its single precision and mixed precision instances.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/graph/graph.hpp>
+#include <pwd/solvers/solvers.hpp>
+#include <pwd/watermodel.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       The water diffusion model with a custom precision.
+ * 
+ * @details     The class template pwd::BasicWaterModel evaluates the water diffusion
+ *              model storing the water, the history of the time stepping and the
+ *              eigenvectors in the type <code>Scalar</code>, and computing the sums of
+ *              the evaluation in the type <code>AccumScalar</code>.\n
+ *              The system is assembled, decomposed and factorized in double precision
+ *              by an inner pwd::WaterModel, and only the data read at each evaluation
+ *              is converted. The eigenvectors are only kept in the stored type, and the
+ *              time stepping shares the factorizations of the inner model. With
+ *              <code>float</code> storage, the memory traffic of
+ *              an evaluation is halved: this is enough for visualization and large
+ *              ensembles, which do not need all the digits of a double.\n
+ *              The IDs of the nodes are the ones of the input file, as in
+ *              pwd::WaterModel.\n
+ *              The model supports the stepping and the spectral evaluation modes. The
+ *              class is instantiated for pwd::FloatWaterModel, pwd::MixedWaterModel
+ *              and <code>BasicWaterModel<double></code>.
+ * 
+ * @tparam Scalar       The type of the stored state.
+ * @tparam AccumScalar  The type of the accumulations.
+ */
+template<typename Scalar, typename AccumScalar = Scalar>
+class BasicWaterModel
+{
+public:
+    /**
+     * @brief       A vector of stored values.
+     */
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> VectorType;
+
+    /**
+     * @brief       A matrix of stored values.
+     */
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> MatrixType;
+
+    /**
+     * @brief       A vector of accumulated values.
+     */
+    typedef Eigen::Matrix<AccumScalar, Eigen::Dynamic, 1> AccumVectorType;
+
+    /**
+     * @brief       A matrix of accumulated values.
+     */
+    typedef Eigen::Matrix<AccumScalar, Eigen::Dynamic, Eigen::Dynamic> AccumMatrixType;
+
+private:
+    /**
+     * @brief       The model in double precision.
+     * 
+     * @details     The model that assembles the system, computes its
+     *              eigendecomposition and factorizes the time steps. Its eigenvectors
+     *              are released once converted.
+     */
+    pwd::WaterModel m_Model;
+
+    /**
+     * @brief       The water.
+     * 
+     * @details     The water at the last evaluated time point.
+     */
+    VectorType m_Water;
+
+    /**
+     * @brief       The water in input order.
+     * 
+     * @details     The last evaluated water with the IDs of the input file, only used if
+     *              the graph has been reordered.
+     */
+    VectorType m_InputWater;
+
+    /**
+     * @brief       Last evaluation time.
+     * 
+     * @details     The time point of the last evaluation.
+     */
+    double m_LastTime;
+
+    /**
+     * @brief       The evaluation mode.
+     * 
+     * @details     The strategy used to evaluate the model.
+     */
+    pwd::EvaluationMode m_Mode;
+
+    /**
+     * @brief       The eigenvectors.
+     * 
+     * @details     The eigenvectors of the system matrix, converted to the stored type.
+     */
+    MatrixType m_Evecs;
+
+    /**
+     * @brief       The eigenvalues.
+     * 
+     * @details     The eigenvalues of the system matrix.
+     */
+    AccumVectorType m_Evals;
+
+    /**
+     * @brief       The spectral coefficients.
+     * 
+     * @details     The coefficients of the starting water in the eigenbasis.
+     */
+    AccumVectorType m_Xi;
+
+    /**
+     * @brief       Support vector.
+     * 
+     * @details     Support vector for the scaled spectral coefficients.
+     */
+    AccumVectorType m_Xi2;
+
+    /**
+     * @brief       The coefficients of a trajectory.
+     * 
+     * @details     The work matrix holding the coefficients of the water in the
+     *              eigenbasis at each time point of EvaluateMany().
+     */
+    AccumMatrixType m_ModeCoeffs;
+
+    /**
+     * @brief       The permuted trajectory.
+     * 
+     * @details     The work matrix receiving the rows of EvaluateMany() in the input
+     *              order, reused across the calls.
+     */
+    MatrixType m_Permuted;
+
+    /**
+     * @brief       Support matrices.
+     * 
+     * @details     Support matrices for a panel of eigenvectors converted to the type
+     *              <code>AccumScalar</code> and for the accumulation of the water.
+     */
+    AccumMatrixType m_Panel;
+    AccumMatrixType m_Accum;
+
+    /**
+     * @brief       The history of the time stepping.
+     * 
+     * @details     The last six states of the BDF scheme, in a circular buffer.
+     */
+    Eigen::Matrix<Scalar, Eigen::Dynamic, 6> m_Spt;
+
+    /**
+     * @brief       Oldest entry of the history.
+     * 
+     * @details     The column of the oldest step inside the history.
+     */
+    int m_SptHead;
+
+    /**
+     * @brief       The factorized time step.
+     * 
+     * @details     The time step for which the implicit system has been factorized.
+     */
+    double m_DT;
+
+    /**
+     * @brief       The right-hand side of the time step.
+     * 
+     * @details     The work vector in which each BDF step is solved.
+     */
+    Eigen::VectorXd m_StepRhs;
+
+
+    /**
+     * @brief       Copy the data of the inner model.
+     * 
+     * @details     This method converts the data of the evaluation mode of the inner
+     *              model, and restarts from the initial water.
+     */
+    void Reset();
+
+    /**
+     * @brief       Advance the water by time stepping.
+     * 
+     * @param Time      The evaluation time.
+     */
+    void Step(double Time);
+
+    /**
+     * @brief       Evaluate the spectral formula.
+     * 
+     * @details     This method computes the water at the given time point from the
+     *              eigenvectors, accumulating the sum in the type
+     *              <code>AccumScalar</code>.
+     * 
+     * @param Time      The evaluation time.
+     * @param Out       The water at the given time point.
+     */
+    void EvaluateSpectral(double Time, Eigen::Ref<VectorType> Out);
+
+    /**
+     * @brief       Combine the eigenvectors.
+     * 
+     * @details     This method computes the water from its coefficients in the
+     *              eigenbasis, one column for each time point. When the accumulation
+     *              type differs from the stored one, the eigenvectors are converted by
+     *              panels of columns, so that the products read them once and never
+     *              convert the whole matrix.
+     * 
+     * @param Coeffs    The coefficients of the water.
+     * @param Out       The water at each time point.
+     */
+    void CombineModes(const Eigen::Ref<const AccumMatrixType>& Coeffs, Eigen::Ref<MatrixType> Out);
+
+    /**
+     * @brief       Update the water in input order.
+     * 
+     * @details     This method copies the last evaluated water in input order, if the
+     *              graph has been reordered.
+     */
+    void UpdateInputWater();
+
+public:
+    /**
+     * @brief       Initializes a water model from a graph.
+     * 
+     * @details     This constructor initializes a water model from an input pwd::Graph,
+     *              with the given loss rate at the leaves.\n
+     *              If the input graph is null, the constructor throws a
+     *              pwd::NullPointerException.
+     * 
+     * @param Graph         The graph of which constructing the system.
+     * @param LossRate      The loss rate of the leaf nodes.
+     * @param InitialWater  The total amount of initial water.
+     * 
+     * @throws pwd::NullPointerException if <code>Graph</code> is nullptr.
+     */
+    BasicWaterModel(const pwd::Graph* Graph,
+                    double LossRate,
+                    double InitialWater);
+
+    /**
+     * @brief       Initializes a water model with dead edges from a graph.
+     * 
+     * @details     This constructor initializes a water model with the given loss
+     *              rates and dead edges from an input pwd::Graph.\n
+     *              If the input graph is null, the constructor throws a
+     *              pwd::NullPointerException.
+     * 
+     * @param Graph         The graph of which constructing the system.
+     * @param LossRates     The vector of loss rates.
+     * @param InitialWater  The total amount of initial water.
+     * @param DeadEdges     The list of dead edges.
+     * 
+     * @throws pwd::NullPointerException if <code>Graph</code> is nullptr.
+     */
+    BasicWaterModel(const pwd::Graph* Graph,
+                    const Eigen::VectorXd& LossRates,
+                    double InitialWater,
+                    const std::vector<std::pair<int, int>>& DeadEdges);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~BasicWaterModel();
+
+
+    /**
+     * @brief       Get the last evaluated water.
+     * 
+     * @return const VectorType& the last evaluated water.
+     */
+    const VectorType& Water() const;
+
+    /**
+     * @brief       Get the last evaluated water at a node.
+     * 
+     * @param i     The ID of a node in the input file.
+     * @return Scalar the last evaluated water at node <code>i</code>.
+     */
+    Scalar Water(int i) const;
+
+    /**
+     * @brief       Returns the last evaluation time.
+     * 
+     * @return double the last evaluation time.
+     */
+    double LastEvaluationTime() const;
+
+    /**
+     * @brief       Returns the evaluation mode.
+     * 
+     * @return pwd::EvaluationMode the evaluation mode.
+     */
+    pwd::EvaluationMode GetEvaluationMode() const;
+
+    /**
+     * @brief       Set the solver backend.
+     * 
+     * @details     This method sets the direct solver used by the time stepping.
+     * 
+     * @param Backend   The solver backend.
+     */
+    void SetSolverBackend(pwd::SolverBackend Backend);
+
+    /**
+     * @brief       Returns the solver backend.
+     * 
+     * @return pwd::SolverBackend the solver backend.
+     */
+    pwd::SolverBackend GetSolverBackend() const;
+
+
+    /**
+     * @brief       Build the water model.
+     * 
+     * @details     This method computes the spectral decomposition of the system in
+     *              double precision, as pwd::WaterModel::Build(), and converts the
+     *              eigenvectors to the stored type.
+     */
+    void Build();
+
+    /**
+     * @brief       Build the water model on the slowest modes.
+     * 
+     * @details     This method computes the slowest modes of the system, as
+     *              pwd::WaterModel::Build(int, double). Before the time at which the
+     *              neglected modes are below the tolerance, the model is evaluated in
+     *              double precision and the water is converted.
+     * 
+     * @param NumModes      The number of modes.
+     * @param Tolerance     The relative tolerance of the evaluation.
+     * 
+     * @throws pwd::AssertFailException if <code>NumModes</code> is out of range or
+     *                                  <code>Tolerance <= 0</code>.
+     */
+    void Build(int NumModes, double Tolerance = 1e-8);
+
+    /**
+     * @brief       Evaluates the model at given time.
+     * 
+     * @details     This method evaluates the water diffusion model at the given time
+     *              point and updates the last evaluation time.\n
+     *              If the given time point is less than zero, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Time      The evaluation time.
+     * 
+     * @throws pwd::AssertFailException if <code>Time < 0.0</code>.
+     */
+    void Evaluate(double Time);
+
+    /**
+     * @brief       Evaluates the model at many time points.
+     * 
+     * @details     This method evaluates the water diffusion model at each of the given
+     *              sorted time points, and writes the water at the j-th time point in
+     *              the j-th column of <code>Out</code>, as
+     *              pwd::WaterModel::EvaluateMany().
+     * 
+     * @param Times     The sorted evaluation times.
+     * @param Out       The matrix of the results.
+     * 
+     * @throws pwd::AssertFailException if the time points are not valid or the size of
+     *                                  <code>Out</code> is wrong.
+     */
+    void EvaluateMany(const std::vector<double>& Times, Eigen::Ref<MatrixType> Out);
+};
+
+
+/**
+ * @brief       The water diffusion model in single precision.
+ */
+typedef BasicWaterModel<float, float> FloatWaterModel;
+
+/**
+ * @brief       The water diffusion model with single precision storage and double
+ *              precision accumulation.
+ */
+typedef BasicWaterModel<float, double> MixedWaterModel;
+
+} // namespace pwd
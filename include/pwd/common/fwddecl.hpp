@@ -20,6 +20,27 @@ namespace pwd
     
 class Node;
 class Graph;
+class TreeSolver;
+class ParallelTreeSolver;
+class SharedSparseLU;
+class LinearSolver;
+class FactorizationCache;
+class KrylovExponential;
+class AdaptiveBDF;
+class BatchedTreeSolver;
+class ShiftInvertEigensolver;
+class TreeOperator;
+class LossSchedule;
+class SourceProfile;
 class WaterModel;
+template<typename Scalar, typename AccumScalar> class BasicWaterModel;
+class Ensemble;
+class Sweep;
+class SimulationWorker;
+class ThreadPool;
+template<typename T> class TripleBuffer;
+class BinaryWriter;
+class BinaryReader;
+class PhaseTimer;
 
 } // namespace pwd
@@ -0,0 +1,294 @@
+/**
+ * @file        ensemble.hpp
+ * 
+ * @brief       Declaration of an ensemble of water diffusion models.
+ * 
+ * @details     This file contains the declaration of a class that simulates at once many
+ *              water diffusion models on the same plant, each one with its own
+ *              parameters.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/graph/graph.hpp>
+#include <pwd/solvers/solvers.hpp>
+#include <pwd/watermodel.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       This class implements an ensemble of water diffusion models.
+ * 
+ * @details     The class pwd::Ensemble simulates K water diffusion models on the same
+ *              graph, with the same dead edges but different loss rates and initial
+ *              water.\n
+ *              The graph-derived part of the system is assembled only once and shared
+ *              by all the members, which only differ on the diagonal of the system
+ *              matrix. The water of the members is stored as the columns of a
+ *              row-major n x K matrix, and all the members are advanced with the same
+ *              BDF6 scheme of pwd::WaterModel, using a single batched tree elimination
+ *              per step.\n
+ *              Each member evolves exactly as a pwd::WaterModel evaluated by time
+ *              stepping with the pwd::SolverBackend::Tree backend. As in
+ *              pwd::WaterModel, the rows of the parameters and of the results follow
+ *              the IDs of the input file, also if the graph has been reordered.
+ */
+class Ensemble
+{
+private:
+    /**
+     * @brief       A constant pointer to the graph.
+     * 
+     * @details     This is a reference to the graph shared by all the members of the
+     *              ensemble.
+     */
+    const pwd::Graph* m_Graph;
+
+    /**
+     * @brief       The initial amount of water of each member.
+     * 
+     * @details     The initial amount of water inside each node (rows) for each member
+     *              (columns).
+     */
+    pwd::RowMatrixXd m_Water0;
+
+    /**
+     * @brief       The amount of water of each member.
+     * 
+     * @details     The amount of water inside each node (rows) for each member (columns)
+     *              at the last evaluated time point.
+     */
+    pwd::RowMatrixXd m_Water;
+
+    /**
+     * @brief       The IDs of the input nodes.
+     * 
+     * @details     The i-th element is the ID in the graph of the node with ID i in the
+     *              input file. The vector is empty if the graph is in input order.
+     */
+    std::vector<int> m_NodeIDs;
+
+    /**
+     * @brief       The water in input order.
+     * 
+     * @details     The initial water and the last evaluated water with the rows in the
+     *              order of the input file. They are only used if the graph has been
+     *              reordered.
+     */
+    pwd::RowMatrixXd m_InputWater0;
+    pwd::RowMatrixXd m_InputWater;
+
+    /**
+     * @brief       The losses of each member.
+     * 
+     * @details     The loss rate times the area of each node (rows) for each member
+     *              (columns).
+     */
+    pwd::RowMatrixXd m_Losses;
+
+    /**
+     * @brief       The shared system matrix.
+     * 
+     * @details     The system matrix of the water flow without losses, shared by all the
+     *              members.
+     */
+    Eigen::SparseMatrix<double> m_S;
+
+    /**
+     * @brief       Diagonal of the shared system matrix.
+     * 
+     * @details     The position of each diagonal entry of <code>m_S</code> inside its
+     *              value array. <code>m_StepMatrix</code> has the same pattern.
+     */
+    std::vector<int> m_DiagIdx;
+
+    /**
+     * @brief       The shared part of the implicit system.
+     * 
+     * @details     The matrix <code>I - Alpha * DT * S</code> of the time stepping
+     *              scheme, with the same pattern of <code>m_S</code>. The losses of the
+     *              members are added as diagonal shifts by the solver.
+     */
+    Eigen::SparseMatrix<double> m_StepMatrix;
+
+    /**
+     * @brief       History of the time stepping scheme.
+     * 
+     * @details     A circular buffer with the water of the last six steps.
+     */
+    pwd::RowMatrixXd m_History[6];
+
+    /**
+     * @brief       Oldest entry of the history.
+     * 
+     * @details     The position of the oldest step inside the circular buffer.
+     */
+    int m_Head;
+
+    /**
+     * @brief       The batched solver.
+     * 
+     * @details     The solver holding the factorization of the implicit systems of all
+     *              the members.
+     */
+    pwd::BatchedTreeSolver m_Solver;
+
+    /**
+     * @brief       The factorized time step.
+     * 
+     * @details     The time step for which the implicit systems have been factorized.
+     *              A change of time step restarts the history of the scheme.
+     */
+    double m_DT;
+
+    /**
+     * @brief       Last evaluated time point.
+     * 
+     * @details     This is the last time point at which the ensemble has been evaluated.
+     */
+    double m_LastTime;
+
+public:
+    /**
+     * @brief       Initializes an ensemble with different leaf loss rates.
+     * 
+     * @details     This constructor initializes an ensemble with one member for each
+     *              given loss rate, which is applied to the leaves of the graph. All the
+     *              members start with the same total amount of water.\n
+     *              If the input graph is null, the constructor throws a
+     *              pwd::NullPointerException.
+     * 
+     * @param Graph         The graph of which constructing the system.
+     * @param LossRates     The loss rate of the leaf nodes of each member.
+     * @param InitialWater  The total amount of initial water.
+     * 
+     * @throws pwd::NullPointerException if <code>Graph</code> is nullptr.
+     * @throws pwd::AssertFailException if <code>LossRates</code> is empty.
+     */
+    Ensemble(const pwd::Graph* Graph,
+             const std::vector<double>& LossRates,
+             double InitialWater);
+
+    /**
+     * @brief       Initializes an ensemble with custom loss rates and dead edges.
+     * 
+     * @details     This constructor initializes an ensemble with one member for each
+     *              column of the loss rates and each entry of the initial water. The
+     *              dead edges are shared by all the members.\n
+     *              If the input graph is null, the constructor throws a
+     *              pwd::NullPointerException.
+     * 
+     * @param Graph         The graph of which constructing the system.
+     * @param LossRates     The loss rate of each node (rows) for each member (columns).
+     * @param InitialWater  The total amount of initial water of each member.
+     * @param DeadEdges     The list of dead edges.
+     * 
+     * @throws pwd::NullPointerException if <code>Graph</code> is nullptr.
+     * @throws pwd::AssertFailException if the sizes of the parameters are wrong.
+     */
+    Ensemble(const pwd::Graph* Graph,
+             const pwd::RowMatrixXd& LossRates,
+             const Eigen::VectorXd& InitialWater,
+             const std::vector<std::pair<int, int>>& DeadEdges);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~Ensemble();
+
+
+    /**
+     * @brief       Returns the graph.
+     * 
+     * @return const pwd::Graph* the graph shared by the members.
+     */
+    const pwd::Graph* GetGraph() const;
+
+    /**
+     * @brief       Returns the number of members.
+     * 
+     * @return int the number of members of the ensemble.
+     */
+    int NumMembers() const;
+
+    /**
+     * @brief       Get the initial water.
+     * 
+     * @details     This method returns the initial amount of water inside each node
+     *              (rows) for each member (columns).
+     * 
+     * @return const pwd::RowMatrixXd& the initial water.
+     */
+    const pwd::RowMatrixXd& Water0() const;
+
+    /**
+     * @brief       Get the last evaluated water.
+     * 
+     * @details     This method returns the amount of water inside each node (rows) for
+     *              each member (columns) at the last evaluated time point.
+     * 
+     * @return const pwd::RowMatrixXd& the last evaluated water.
+     */
+    const pwd::RowMatrixXd& Water() const;
+
+    /**
+     * @brief       Get the last evaluated water of a member at a node.
+     * 
+     * @param i     The ID of a node in the input file.
+     * @param k     The index of a member.
+     * @return double the last evaluated water of member <code>k</code> at node
+     *                <code>i</code>.
+     */
+    double Water(int i, int k) const;
+
+    /**
+     * @brief       Evaluates the ensemble at given time.
+     * 
+     * @details     This method advances all the members to the given time point with a
+     *              single step of the BDF6 scheme, and updates the last evaluation time.\n
+     *              If the given time point is less than zero, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Time      The evaluation time.
+     * 
+     * @throws pwd::AssertFailException if <code>Time < 0.0</code>.
+     */
+    void Evaluate(double Time);
+
+    /**
+     * @brief       Returns the last evaluation time.
+     * 
+     * @return double the last evaluation time.
+     */
+    double LastEvaluationTime() const;
+
+
+    /**
+     * @brief       Initialize the ensemble.
+     * 
+     * @details     This method assembles the shared system and initializes the members
+     *              with the given loss rates and initial water, sharing the dead edges.
+     * 
+     * @param LossRates     The loss rate of each node (rows) for each member (columns).
+     * @param InitialWater  The total amount of initial water of each member.
+     * @param DeadEdges     The list of dead edges.
+     * 
+     * @throws pwd::AssertFailException if the sizes of the parameters are wrong.
+     */
+    void Initialize(const pwd::RowMatrixXd& LossRates,
+                    const Eigen::VectorXd& InitialWater,
+                    const std::vector<std::pair<int, int>>& DeadEdges);
+};
+
+} // namespace pwd
@@ -21,6 +21,35 @@
 
 namespace pwd
 {
+
+/**
+ * @brief       Orderings of the nodes of a graph.
+ * 
+ * @details     This enumeration lists the orders in which pwd::Graph::Reorder() can
+ *              store the nodes of a tree-graph.
+ */
+enum class NodeOrdering
+{
+    /**
+     * @brief       The order of the input file.
+     */
+    Input,
+
+    /**
+     * @brief       Depth-first preorder from the root, each branch is contiguous.
+     */
+    DepthFirst,
+
+    /**
+     * @brief       Breadth-first order from the root.
+     */
+    BreadthFirst,
+
+    /**
+     * @brief       Reverse Cuthill-McKee order, which minimizes the bandwidth.
+     */
+    ReverseCuthillMcKee
+};
     
 /**
  * @brief       A class representing a graph structure.
@@ -62,6 +91,29 @@ private:
      */
     pwd::Node* m_Root;
 
+    /**
+     * @brief       The input IDs of the nodes.
+     * 
+     * @details     The i-th element is the ID in the input file of the node with ID i.
+     *              The IDs only differ after a call to Reorder().
+     */
+    std::vector<int> m_InputIDs;
+
+    /**
+     * @brief       The IDs of the input nodes.
+     * 
+     * @details     The i-th element is the ID of the node with ID i in the input file.
+     *              Formally, <code>m_FromInput[m_InputIDs[i]] == i</code>.
+     */
+    std::vector<int> m_FromInput;
+
+    /**
+     * @brief       The current ordering of the nodes.
+     * 
+     * @details     The ordering applied by the last call to Reorder().
+     */
+    pwd::NodeOrdering m_Ordering;
+
 
 
 
@@ -240,6 +292,65 @@ public:
      * @param KeepTail  Decide wheter or not to recompute the tail.
      */
     void RecomputeHeadsAndTails(bool KeepTail = true);
+
+
+
+    /**
+     * @brief       Reorder the nodes of this tree-graph.
+     * 
+     * @details     This method changes the IDs of the nodes so that they follow the
+     *              given ordering. Each connected component is visited from the root,
+     *              or from its first node in input order, except for the reverse
+     *              Cuthill-McKee ordering which starts from a peripheral node.\n 
+     *              Nodes which are close in the tree get close IDs, so that the systems
+     *              of the models and any loop over the nodes read memory contiguously.
+     *              The nodes themselves are not moved, hence pointers stay valid, but
+     *              the objects created before the call, like a pwd::WaterModel, become
+     *              invalid.\n 
+     *              The input IDs are kept, and can be recovered with InputID() and
+     *              NodeID(). The models take and return the input IDs, and translate
+     *              them internally.
+     * 
+     * @param Ordering  The ordering of the nodes.
+     */
+    void Reorder(pwd::NodeOrdering Ordering);
+
+    /**
+     * @brief       Returns the ordering of the nodes.
+     * 
+     * @return pwd::NodeOrdering the ordering applied by the last call to Reorder().
+     */
+    pwd::NodeOrdering GetOrdering() const;
+
+    /**
+     * @brief       Returns the input ID of a node.
+     * 
+     * @details     This method returns the ID in the input file of the node with the
+     *              given ID.\n 
+     *              If no node in this graph has the given ID, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param ID    The ID of a node.
+     * @return int the ID of the node in the input file.
+     * 
+     * @throws pwd::AssertFailException if no node in the graph has the given ID.
+     */
+    int InputID(int ID) const;
+
+    /**
+     * @brief       Returns the ID of an input node.
+     * 
+     * @details     This method returns the ID of the node with the given ID in the input
+     *              file.\n 
+     *              If no node in the input file has the given ID, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param InputID   The ID of a node in the input file.
+     * @return int the ID of the node.
+     * 
+     * @throws pwd::AssertFailException if no node in the input file has the given ID.
+     */
+    int NodeID(int InputID) const;
 };
 
 } // namespace pwd
@@ -0,0 +1,162 @@
+/**
+ * @file        lossschedule.hpp
+ * 
+ * @brief       Declaration of a periodic schedule of loss rates.
+ * 
+ * @details     This file contains the declaration of a class that describes loss rates
+ *              changing over time as a periodic sequence of constant segments, such as
+ *              the day and night cycle of the transpiration.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A periodic schedule of loss rates.
+ * 
+ * @details     The class pwd::LossSchedule is a sequence of segments, each with a
+ *              duration and a vector of loss rates that stay constant for that duration.
+ *              The sequence repeats forever, with a period equal to the sum of the
+ *              durations.\n
+ *              The times of the schedule are relative to its start: the segment active
+ *              at time t is the one containing t modulo the period.
+ */
+class LossSchedule
+{
+private:
+    /**
+     * @brief       The ends of the segments.
+     * 
+     * @details     The i-th element is the time, relative to the start of the period,
+     *              at which the i-th segment ends. The last one is the period.
+     */
+    std::vector<double> m_Ends;
+
+    /**
+     * @brief       The loss rates of the segments.
+     * 
+     * @details     The i-th element is the vector of loss rates of the i-th segment.
+     */
+    std::vector<Eigen::VectorXd> m_LossRates;
+
+public:
+    /**
+     * @brief       Create an empty schedule.
+     * 
+     * @details     This constructor creates a schedule with no segments.
+     */
+    LossSchedule();
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~LossSchedule();
+
+
+    /**
+     * @brief       Add a segment.
+     * 
+     * @details     This method appends a segment to the period of the schedule.\n
+     *              If the duration is not positive or the size of the loss rates differs
+     *              from the one of the other segments, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Duration      The duration of the segment.
+     * @param LossRates     The vector of loss rates of the segment.
+     * 
+     * @throws pwd::AssertFailException if <code>Duration <= 0</code> or the size of
+     *                                  <code>LossRates</code> is wrong.
+     */
+    void AddSegment(double Duration, const Eigen::VectorXd& LossRates);
+
+    /**
+     * @brief       Returns the number of segments.
+     * 
+     * @return int the number of segments in a period.
+     */
+    int NumSegments() const;
+
+    /**
+     * @brief       Returns the period.
+     * 
+     * @return double the sum of the durations of the segments.
+     */
+    double Period() const;
+
+    /**
+     * @brief       Returns the duration of a segment.
+     * 
+     * @param i     The index of the segment.
+     * @return double the duration of the i-th segment.
+     * 
+     * @throws pwd::AssertFailException if <code>i</code> is out of range.
+     */
+    double Duration(int i) const;
+
+    /**
+     * @brief       Returns the loss rates of a segment.
+     * 
+     * @param i     The index of the segment.
+     * @return const Eigen::VectorXd& the loss rates of the i-th segment.
+     * 
+     * @throws pwd::AssertFailException if <code>i</code> is out of range.
+     */
+    const Eigen::VectorXd& LossRates(int i) const;
+
+    /**
+     * @brief       Returns the segment active at a time point.
+     * 
+     * @details     This method returns the index of the segment containing the given
+     *              time modulo the period. A time point on the boundary between two
+     *              segments belongs to the later one.\n
+     *              If the schedule is empty or the time is negative, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Time  The time since the start of the schedule.
+     * @return int the index of the active segment.
+     * 
+     * @throws pwd::AssertFailException if the schedule is empty or
+     *                                  <code>Time < 0</code>.
+     */
+    int SegmentAt(double Time) const;
+
+
+    /**
+     * @brief       Save the schedule.
+     * 
+     * @details     This method writes the ends and the loss rates of the segments, so
+     *              that Load() can restore the same boundaries bitwise.
+     * 
+     * @param Writer    The binary writer.
+     */
+    void Save(pwd::BinaryWriter& Writer) const;
+
+    /**
+     * @brief       Load the schedule.
+     * 
+     * @details     This method replaces the segments with the ones written by Save().
+
+     *              If the segments are not valid, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Reader    The binary reader.
+     * 
+     * @throws pwd::AssertFailException if the segments are not valid.
+     */
+    void Load(pwd::BinaryReader& Reader);
+};
+
+} // namespace pwd
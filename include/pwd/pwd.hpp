@@ -17,4 +17,11 @@
 #include <pwd/common/common.hpp>
 #include <pwd/utils/utils.hpp>
 #include <pwd/graph/graph.hpp>
-#include <pwd/watermodel.hpp>
\ No newline at end of file
+#include <pwd/solvers/solvers.hpp>
+#include <pwd/lossschedule.hpp>
+#include <pwd/sourceprofile.hpp>
+#include <pwd/watermodel.hpp>
+#include <pwd/ensemble.hpp>
+#include <pwd/sweep.hpp>
+#include <pwd/simulationworker.hpp>
+#include <pwd/basicwatermodel.hpp>
\ No newline at end of file
@@ -0,0 +1,302 @@
+/**
+ * @file        simulationworker.hpp
+ * 
+ * @brief       Declaration of a water model running on its own thread.
+ * 
+ * @details     This file contains the declaration of a class that advances a water
+ *              diffusion model on a dedicated thread, publishing its states to another
+ *              thread, such as the one of a viewer, without blocking it.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/utils/utils.hpp>
+#include <pwd/graph/graph.hpp>
+#include <pwd/watermodel.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A state published by a simulation.
+ * 
+ * @details     A copy of the water of a model, with the time it has been evaluated at.
+ */
+struct SimulationState
+{
+    /**
+     * @brief       The amount of water in each node.
+     */
+    Eigen::VectorXd Water;
+
+    /**
+     * @brief       The time point of the water.
+     */
+    double Time;
+
+    /**
+     * @brief       The number of evaluations done by the simulation.
+     */
+    size_t NumEvaluations;
+
+    /**
+     * @brief       The total time spent in the evaluations, in milliseconds.
+     */
+    double EvaluationTime;
+};
+
+/**
+ * @brief       This class runs a water model on its own thread.
+ * 
+ * @details     The class pwd::SimulationWorker owns a pwd::WaterModel and a thread that
+ *              evaluates it at the time points <code>t + dt, t + 2 * dt, ...</code>, as
+ *              fast as possible or at a target number of evaluations per second.\n
+ *              After each evaluation, the water is published through a
+ *              pwd::TripleBuffer, so that a single reader thread can take the latest state
+ *              at any moment without waiting for the evaluations.\n
+ *              The model can only be accessed by the worker thread. Any other thread
+ *              changes the model and the simulation by submitting commands, which are
+ *              executed in order by the worker before its next evaluation.
+ */
+class SimulationWorker
+{
+private:
+    /**
+     * @brief       The water model.
+     * 
+     * @details     The model owned by the worker thread.
+     */
+    pwd::WaterModel m_Model;
+
+    /**
+     * @brief       The published states.
+     * 
+     * @details     The buffer passing the states from the worker thread to the reader.
+     */
+    pwd::TripleBuffer<pwd::SimulationState> m_States;
+
+    /**
+     * @brief       The number of evaluations.
+     * 
+     * @details     The number of evaluations done by the worker thread.
+     */
+    size_t m_NumEvaluations;
+
+    /**
+     * @brief       The evaluation time.
+     * 
+     * @details     The total time spent by the worker thread in the evaluations, in
+     *              milliseconds.
+     */
+    double m_EvaluationTime;
+
+    /**
+     * @brief       The simulated time step.
+     * 
+     * @details     The time between two consecutive evaluations.
+     */
+    double m_TimeStep;
+
+    /**
+     * @brief       The target rate.
+     * 
+     * @details     The number of evaluations per second, or zero to evaluate as fast as
+     *              possible.
+     */
+    double m_TargetRate;
+
+    /**
+     * @brief       Paused status.
+     * 
+     * @details     Tells if the evaluations are paused. Commands are executed anyway.
+     */
+    bool m_IsPaused;
+
+    /**
+     * @brief       The pending commands.
+     * 
+     * @details     The commands submitted and not yet executed, from the oldest.
+     */
+    std::deque<std::function<void(pwd::WaterModel&)>> m_Commands;
+
+    /**
+     * @brief       The first error.
+     * 
+     * @details     The first exception thrown by a command or by an evaluation, not yet
+     *              rethrown to the reader.
+     */
+    std::exception_ptr m_Error;
+
+    /**
+     * @brief       Stop signal.
+     * 
+     * @details     Tells the worker thread to stop.
+     */
+    bool m_Stop;
+
+    /**
+     * @brief       Mutex of the commands.
+     * 
+     * @details     The mutex protecting the commands, the error and the stop signal.
+     */
+    std::mutex m_Mutex;
+
+    /**
+     * @brief       Condition of the commands.
+     * 
+     * @details     The condition variable waking the worker thread on a new command.
+     */
+    std::condition_variable m_CommandCV;
+
+    /**
+     * @brief       The worker thread.
+     * 
+     * @details     The thread evaluating the model.
+     */
+    std::thread m_Worker;
+
+
+    /**
+     * @brief       Publish the water of the model.
+     * 
+     * @details     This method copies the water of the model in the buffer of the writer
+     *              and publishes it.
+     */
+    void Publish();
+
+    /**
+     * @brief       Body of the worker thread.
+     * 
+     * @details     This method executes the commands and the evaluations until the
+     *              worker is stopped.
+     */
+    void WorkerLoop();
+
+public:
+    /**
+     * @brief       Create a simulation.
+     * 
+     * @details     This constructor creates the model of the given graph, with the given
+     *              loss rate and total amount of initial water, and starts the worker
+     *              thread. The simulation starts paused.\n
+     *              If the input graph is null, the constructor throws a
+     *              pwd::NullPointerException.
+     * 
+     * @param Graph         The graph of the model.
+     * @param LossRate      The loss rate of each node.
+     * @param InitialWater  The total amount of initial water.
+     * 
+     * @throws pwd::NullPointerException if <code>Graph</code> is nullptr.
+     */
+    SimulationWorker(const pwd::Graph* Graph,
+                     double LossRate,
+                     double InitialWater);
+
+    /**
+     * @brief       Stop the simulation.
+     * 
+     * @details     This destructor stops the worker thread after its current command or
+     *              evaluation, discarding the pending commands.
+     */
+    ~SimulationWorker();
+
+
+    /**
+     * @brief       Submit a command.
+     * 
+     * @details     This method queues a function that the worker thread calls with the
+     *              model, before its next evaluation. Commands are executed in the order
+     *              they are submitted, and the water is published after them.\n
+     *              The function must not access the model after it returns, and should
+     *              copy the data it needs from the caller.
+     * 
+     * @param Command   The function to call with the model.
+     */
+    void Submit(std::function<void(pwd::WaterModel&)> Command);
+
+    /**
+     * @brief       Pause or resume the simulation.
+     * 
+     * @details     This method submits a command pausing or resuming the evaluations.
+     * 
+     * @param Paused    true to pause the evaluations, false to resume them.
+     */
+    void SetPaused(bool Paused);
+
+    /**
+     * @brief       Change the simulated time step.
+     * 
+     * @details     This method submits a command changing the time between two
+     *              evaluations. The evaluations wait while the time step is zero.\n
+     *              If the time step is negative, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param TimeStep  The new time step.
+     * 
+     * @throws pwd::AssertFailException if <code>TimeStep < 0</code>.
+     */
+    void SetTimeStep(double TimeStep);
+
+    /**
+     * @brief       Change the target rate.
+     * 
+     * @details     This method submits a command changing the number of evaluations per
+     *              second. With a zero rate the model is evaluated as fast as possible.\n
+     *              If the rate is negative, the method throws a pwd::AssertFailException.
+     * 
+     * @param Rate  The number of evaluations per second.
+     * 
+     * @throws pwd::AssertFailException if <code>Rate < 0</code>.
+     */
+    void SetTargetRate(double Rate);
+
+    /**
+     * @brief       Evaluate the model at a given time.
+     * 
+     * @details     This method submits a command evaluating the model at the given
+     *              time, from which the simulation continues.
+     * 
+     * @param Time  The time point.
+     */
+    void SetTime(double Time);
+
+
+    /**
+     * @brief       Take the latest state.
+     * 
+     * @details     This method takes the latest state published by the worker thread.
+     *              It never waits for the worker, and must always be called by the same
+     *              thread.\n
+     *              If a command or an evaluation threw an exception, the simulation is
+     *              paused and the exception is rethrown by this method.
+     * 
+     * @return true if a new state has been taken.
+     * @return false if the latest state was already taken.
+     */
+    bool Update();
+
+    /**
+     * @brief       Returns the latest state.
+     * 
+     * @details     This method returns the state taken by the last call to Update(). The
+     *              state is not modified by the worker thread.
+     * 
+     * @return const pwd::SimulationState& the latest state taken.
+     */
+    const pwd::SimulationState& State() const;
+};
+
+} // namespace pwd
@@ -0,0 +1,493 @@
+/**
+ * @file        adaptivebdf.hpp
+ * 
+ * @brief       Declaration of an adaptive BDF integrator.
+ * 
+ * @details     This file contains the declaration of a variable-step, variable-order
+ *              BDF integrator for linear systems of ordinary differential equations.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/solvers/linearsolver.hpp>
+#include <pwd/utils/binaryio.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       Adaptive BDF integrator.
+ * 
+ * @details     The class pwd::AdaptiveBDF integrates the linear system
+ *              <code>y' = S * y</code> with the backward differentiation formulas of
+ *              order 1 to 6, taking internal substeps of variable size.\n
+ *              The coefficients are derived from the interpolating polynomial on the
+ *              actual, possibly nonuniform, time grid. The local error is estimated by
+ *              comparing the solution with the extrapolation of the history, and it is
+ *              measured in a weighted RMS norm against a relative and an absolute
+ *              tolerance. Steps with a too large error are rejected and retried.\n
+ *              The integration starts at order 1 and raises the order as the history
+ *              grows, choosing at each step the order that allows the largest next step.
+ *              The implicit system is factorized again only when its leading
+ *              coefficient changes, hence the step size is kept fixed when it could
+ *              only grow slightly.
+ */
+class AdaptiveBDF
+{
+private:
+    /**
+     * @brief       The system matrix.
+     * 
+     * @details     The matrix <code>S</code> of the system <code>y' = S * y</code>.
+     */
+    Eigen::SparseMatrix<double> m_S;
+
+    /**
+     * @brief       Sparse identity matrix.
+     * 
+     * @details     The identity matrix with the same size of the system.
+     */
+    Eigen::SparseMatrix<double> m_Eye;
+
+    /**
+     * @brief       The relative tolerance.
+     * 
+     * @details     The relative tolerance on the local error of each step.
+     */
+    double m_RelTol;
+
+    /**
+     * @brief       The absolute tolerance.
+     * 
+     * @details     The absolute tolerance on the local error of each step.
+     */
+    double m_AbsTol;
+
+    /**
+     * @brief       The maximum order.
+     * 
+     * @details     The maximum order of the BDF formulas, between 1 and 6.
+     */
+    int m_MaxOrder;
+
+    /**
+     * @brief       The solver for the implicit system.
+     * 
+     * @details     The direct solver holding the factorization of
+     *              <code>I - Gamma * S</code>.
+     */
+    pwd::LinearSolver m_Solver;
+
+    /**
+     * @brief       The coefficient of the factorized system.
+     * 
+     * @details     The value <code>Gamma</code> such that the factorized matrix is
+     *              <code>I - Gamma * S</code>. A non-positive value means that no
+     *              factorization is available.
+     */
+    double m_Gamma;
+
+    /**
+     * @brief       The implicit system.
+     * 
+     * @details     The factorized matrix <code>I - Gamma * S</code>.
+     */
+    Eigen::SparseMatrix<double> m_Shifted;
+
+    /**
+     * @brief       The history of the solution.
+     * 
+     * @details     A circular buffer holding the last accepted solutions, one per column.
+     */
+    Eigen::MatrixXd m_History;
+
+    /**
+     * @brief       The history of the time points.
+     * 
+     * @details     A circular buffer holding the time points of the accepted solutions.
+     */
+    std::vector<double> m_Times;
+
+    /**
+     * @brief       The newest entry of the history.
+     * 
+     * @details     The position of the last accepted solution inside the circular buffer.
+     */
+    int m_Head;
+
+    /**
+     * @brief       The length of the history.
+     * 
+     * @details     The number of valid entries inside the circular buffer.
+     */
+    int m_NumHistory;
+
+    /**
+     * @brief       The initial derivative.
+     * 
+     * @details     The derivative <code>S * y</code> at the initial time, used to estimate
+     *              the error of the first step.
+     */
+    Eigen::VectorXd m_F0;
+
+    /**
+     * @brief       The current step size.
+     * 
+     * @details     The size of the next step attempted by the integrator.
+     */
+    double m_Step;
+
+    /**
+     * @brief       The current order.
+     * 
+     * @details     The order of the next step attempted by the integrator.
+     */
+    int m_Order;
+
+    /**
+     * @brief       Steps at the current order.
+     * 
+     * @details     The number of consecutive steps accepted at the current order.
+     */
+    int m_StepsAtOrder;
+
+    /**
+     * @brief       Consecutive failures.
+     * 
+     * @details     The number of consecutive rejected steps.
+     */
+    int m_NumFailures;
+
+    /**
+     * @brief       Number of accepted steps.
+     * 
+     * @details     The number of steps accepted since the last reset.
+     */
+    int m_NumSteps;
+
+    /**
+     * @brief       Number of rejected steps.
+     * 
+     * @details     The number of steps rejected since the last reset.
+     */
+    int m_NumRejected;
+
+    /**
+     * @brief       Number of factorizations.
+     * 
+     * @details     The number of numerical factorizations since the last reset.
+     */
+    int m_NumFactorizations;
+
+    /**
+     * @brief       Support vectors.
+     * 
+     * @details     Support vectors for the right-hand side, the new solution and the
+     *              predictions.
+     */
+    Eigen::VectorXd m_Rhs;
+    Eigen::VectorXd m_Y;
+    Eigen::VectorXd m_Pred;
+
+
+    /**
+     * @brief       Get an entry of the history.
+     * 
+     * @details     This method returns the j-th last accepted solution, where
+     *              <code>j = 0</code> is the newest one.
+     * 
+     * @param j     The age of the entry.
+     * @return Eigen::MatrixXd::ColXpr the j-th last accepted solution.
+     */
+    Eigen::MatrixXd::ColXpr HistoryValue(int j);
+
+    /**
+     * @brief       Get a time point of the history.
+     * 
+     * @details     This method returns the time of the j-th last accepted solution,
+     *              where <code>j = 0</code> is the newest one.
+     * 
+     * @param j     The age of the entry.
+     * @return double the time of the j-th last accepted solution.
+     */
+    double HistoryTime(int j) const;
+
+    /**
+     * @brief       Extrapolate the history.
+     * 
+     * @details     This method evaluates at time <code>t</code> the polynomial
+     *              interpolating the last <code>NumPoints</code> accepted solutions,
+     *              and stores the result in the prediction vector.
+     * 
+     * @param t         The evaluation time.
+     * @param NumPoints The number of interpolated solutions.
+     */
+    void Predict(double t, int NumPoints);
+
+    /**
+     * @brief       Estimate the error of a step.
+     * 
+     * @details     This method estimates the weighted norm of the local error that the
+     *              BDF formula of order <code>q</code> commits in the step to time
+     *              <code>t</code>, ending in the new solution.\n
+     *              The history must contain at least <code>q + 1</code> solutions,
+     *              except for <code>q = 1</code> at the first step.
+     * 
+     * @param t     The time of the new solution.
+     * @param q     The order.
+     * @return double the weighted norm of the local error.
+     */
+    double EstimateError(double t, int q);
+
+    /**
+     * @brief       Weighted RMS norm.
+     * 
+     * @details     This method computes the RMS norm of a vector, weighted with the
+     *              tolerances relative to the magnitude of the new solution.
+     * 
+     * @param v     The vector.
+     * @return double the weighted RMS norm of the vector.
+     */
+    double WeightedNorm(const Eigen::VectorXd& v) const;
+
+    /**
+     * @brief       Factorize the implicit system.
+     * 
+     * @details     This method factorizes <code>I - Gamma * S</code>, unless the current
+     *              factorization already uses the given coefficient.
+     * 
+     * @param Gamma The coefficient of the implicit system.
+     */
+    void Factorize(double Gamma);
+
+public:
+    /**
+     * @brief       Create an adaptive BDF integrator.
+     * 
+     * @details     This constructor creates an integrator with the given tolerances and
+     *              maximum order.\n
+     *              If the tolerances are not positive or the order is not between 1 and 6,
+     *              the constructor throws a pwd::AssertFailException.
+     * 
+     * @param RelTol    The relative tolerance.
+     * @param AbsTol    The absolute tolerance.
+     * @param MaxOrder  The maximum order.
+     * 
+     * @throws pwd::AssertFailException if the tolerances are not positive, or
+     *                                  <code>MaxOrder</code> is not in <code>[1, 6]</code>.
+     */
+    AdaptiveBDF(double RelTol = 1e-6,
+                double AbsTol = 1e-9,
+                int MaxOrder = 6);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~AdaptiveBDF();
+
+
+    /**
+     * @brief       Set the system matrix.
+     * 
+     * @details     This method sets the matrix <code>S</code> of the system
+     *              <code>y' = S * y</code> and analyzes its pattern.\n
+     *              The integrator must be reset before advancing it.
+     * 
+     * @param S     The system matrix.
+     * 
+     * @throws pwd::AssertFailException if <code>S</code> is not square.
+     */
+    void SetMatrix(const Eigen::SparseMatrix<double>& S);
+
+    /**
+     * @brief       Update the system matrix after a local change.
+     * 
+     * @details     This method copies the entries <code>S(i, j)</code> where both
+     *              <code>i</code> and <code>j</code> are in <code>Nodes</code>, and updates
+     *              the factorization accordingly, instead of discarding it.\n
+     *              The given matrix must have the same sparsity pattern of the current
+     *              one, otherwise the method throws a pwd::AssertFailException. The
+     *              integrator must be reset before advancing it.
+     * 
+     * @param S     The changed system matrix.
+     * @param Nodes The nodes whose entries changed.
+     * 
+     * @throws pwd::AssertFailException if the pattern of <code>S</code> differs.
+     */
+    void UpdateMatrix(const Eigen::SparseMatrix<double>& S, const std::vector<int>& Nodes);
+
+    /**
+     * @brief       Set the tolerances.
+     * 
+     * @details     This method sets the relative and absolute tolerances on the local
+     *              error of each step.
+     * 
+     * @param RelTol    The relative tolerance.
+     * @param AbsTol    The absolute tolerance.
+     * 
+     * @throws pwd::AssertFailException if the tolerances are not positive.
+     */
+    void SetTolerances(double RelTol, double AbsTol);
+
+    /**
+     * @brief       Returns the relative tolerance.
+     * 
+     * @return double the relative tolerance.
+     */
+    double GetRelTolerance() const;
+
+    /**
+     * @brief       Returns the absolute tolerance.
+     * 
+     * @return double the absolute tolerance.
+     */
+    double GetAbsTolerance() const;
+
+    /**
+     * @brief       Set the maximum order.
+     * 
+     * @param MaxOrder  The maximum order.
+     * 
+     * @throws pwd::AssertFailException if <code>MaxOrder</code> is not in
+     *                                  <code>[1, 6]</code>.
+     */
+    void SetMaxOrder(int MaxOrder);
+
+    /**
+     * @brief       Returns the maximum order.
+     * 
+     * @return int the maximum order.
+     */
+    int GetMaxOrder() const;
+
+    /**
+     * @brief       Set the backend of the implicit solver.
+     * 
+     * @details     This method sets the direct solver used to factorize the implicit
+     *              system.\n
+     *              The integrator must be reset before advancing it.
+     * 
+     * @param Backend   The backend of the implicit solver.
+     */
+    void SetBackend(pwd::SolverBackend Backend);
+
+    /**
+     * @brief       Returns the backend of the implicit solver.
+     * 
+     * @return pwd::SolverBackend the backend of the implicit solver.
+     */
+    pwd::SolverBackend GetBackend() const;
+
+
+    /**
+     * @brief       Reset the integrator.
+     * 
+     * @details     This method restarts the integration from the given initial state,
+     *              discarding the history and the statistics.
+     * 
+     * @param y0    The initial state.
+     * @param t0    The initial time.
+     * 
+     * @throws pwd::AssertFailException if the size of <code>y0</code> is wrong.
+     */
+    void Reset(const Eigen::VectorXd& y0, double t0 = 0.0);
+
+    /**
+     * @brief       Advance the integration.
+     * 
+     * @details     This method integrates the system up to the given time, taking as
+     *              many internal steps as needed. The last step is shortened to end
+     *              exactly at <code>Time</code>.
+     * 
+     * @param Time  The target time.
+     * 
+     * @throws pwd::AssertFailException if <code>Time</code> is before the current time.
+     */
+    void Advance(double Time);
+
+    /**
+     * @brief       Save the state of the integration.
+     * 
+     * @details     This method writes the tolerances, the history and the step control
+     *              of the integration, so that Load() can resume it exactly.
+     * 
+     * @param Writer    The binary writer.
+     */
+    void Save(pwd::BinaryWriter& Writer) const;
+
+    /**
+     * @brief       Load the state of the integration.
+     * 
+     * @details     This method reads the state written by Save(). The system matrix
+     *              must have been set, and it is factorized again at the next step.\n 
+     *              If the state does not match the size of the system, the method
+     *              throws a pwd::AssertFailException.
+     * 
+     * @param Reader    The binary reader.
+     * 
+     * @throws pwd::AssertFailException if the state is not valid.
+     */
+    void Load(pwd::BinaryReader& Reader);
+
+
+    /**
+     * @brief       Returns the current time.
+     * 
+     * @return double the time of the last accepted solution.
+     */
+    double Time() const;
+
+    /**
+     * @brief       Returns the current state.
+     * 
+     * @return Eigen::VectorXd the last accepted solution.
+     */
+    Eigen::VectorXd State() const;
+
+    /**
+     * @brief       Returns the current order.
+     * 
+     * @return int the order of the next step.
+     */
+    int Order() const;
+
+    /**
+     * @brief       Returns the current step size.
+     * 
+     * @return double the size of the next step.
+     */
+    double StepSize() const;
+
+    /**
+     * @brief       Returns the number of accepted steps.
+     * 
+     * @return int the number of steps accepted since the last reset.
+     */
+    int NumSteps() const;
+
+    /**
+     * @brief       Returns the number of rejected steps.
+     * 
+     * @return int the number of steps rejected since the last reset.
+     */
+    int NumRejectedSteps() const;
+
+    /**
+     * @brief       Returns the number of factorizations.
+     * 
+     * @return int the number of numerical factorizations since the last reset.
+     */
+    int NumFactorizations() const;
+};
+
+} // namespace pwd
@@ -0,0 +1,198 @@
+/**
+ * @file        batchedtreesolver.hpp
+ * 
+ * @brief       Declaration of a batched direct solver for tree-structured systems.
+ * 
+ * @details     This file contains the declaration of a class that factorizes and solves
+ *              many linear systems sharing the same tree sparsity pattern and the same
+ *              off-diagonal entries, but with different diagonals.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/solvers/treesolver.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       Row-major dense matrix.
+ * 
+ * @details     A dense matrix of doubles stored by rows. When each column holds one
+ *              member of a batch, the values of all the members at the same node are
+ *              contiguous in memory.
+ */
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
+
+/**
+ * @brief       A batched direct solver for linear systems with a tree sparsity pattern.
+ * 
+ * @details     The class pwd::BatchedTreeSolver factorizes and solves at once the K
+ *              linear systems <code>(A + diag(D_k)) * x_k = b_k</code>, where the matrix
+ *              <code>A</code> has a tree sparsity pattern and is shared by all the
+ *              systems, while each system has its own diagonal shift <code>D_k</code>.\n
+ *              The elimination follows the same order of pwd::TreeSolver. The systems
+ *              are stored as the columns of row-major matrices, so that each step of
+ *              the elimination is a single operation on K contiguous values.
+ */
+class BatchedTreeSolver
+{
+private:
+    /**
+     * @brief       The solver holding the pattern analysis.
+     * 
+     * @details     The tree solver used to compute the elimination order.
+     */
+    pwd::TreeSolver m_Tree;
+
+    /**
+     * @brief       Number of systems.
+     * 
+     * @details     The number of systems factorized by the last factorization.
+     */
+    int m_K;
+
+    /**
+     * @brief       Upper factor.
+     * 
+     * @details     The entry <code>A(i, parent(i))</code> of each node, in elimination
+     *              order. It is shared by all the systems.
+     */
+    Eigen::VectorXd m_Upper;
+
+    /**
+     * @brief       Elimination multipliers.
+     * 
+     * @details     The multiplier <code>A(parent(i), i) / pivot(i)</code> of each node in
+     *              elimination order (rows) and for each system (columns).
+     */
+    pwd::RowMatrixXd m_Lower;
+
+    /**
+     * @brief       Inverse of the pivots.
+     * 
+     * @details     The inverse of the pivot of each node in elimination order (rows)
+     *              and for each system (columns).
+     */
+    pwd::RowMatrixXd m_InvPivots;
+
+    /**
+     * @brief       Support matrix.
+     * 
+     * @details     Node-indexed support matrix used to accumulate the pivots during
+     *              the factorization.
+     */
+    pwd::RowMatrixXd m_Pivots;
+
+    /**
+     * @brief       Matrices factorized.
+     * 
+     * @details     This value tells if the numerical factorization has been computed.
+     */
+    bool m_Factorized;
+
+public:
+    /**
+     * @brief       Create an empty solver.
+     * 
+     * @details     This constructor creates a solver with no analyzed pattern.
+     */
+    BatchedTreeSolver();
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~BatchedTreeSolver();
+
+
+    /**
+     * @brief       Analyze the sparsity pattern of a matrix.
+     * 
+     * @details     This method computes the elimination order of the given matrix from
+     *              its sparsity pattern, with the same requirements of
+     *              pwd::TreeSolver::AnalyzePattern().
+     * 
+     * @param A     A square sparse matrix with a tree sparsity pattern.
+     * 
+     * @throws pwd::AssertFailException if the pattern of <code>A</code> is not a forest.
+     */
+    void AnalyzePattern(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Compute the numerical factorization of the shifted matrices.
+     * 
+     * @details     This method factorizes the matrices <code>A + diag(D_k)</code>, where
+     *              <code>D_k</code> is the k-th column of <code>Shifts</code>.\n
+     *              The matrix must have the same sparsity pattern of the last analyzed
+     *              one. If no pattern has been analyzed, the pattern or the number of rows
+     *              of the shifts differ, or a zero pivot is found, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param A         A square sparse matrix with the analyzed sparsity pattern.
+     * @param Shifts    The diagonal shifts, one system per column.
+     * 
+     * @throws pwd::AssertFailException if the pattern is not the analyzed one or any
+     *                                  of the matrices is singular.
+     */
+    void Factorize(const Eigen::SparseMatrix<double>& A, const pwd::RowMatrixXd& Shifts);
+
+
+    /**
+     * @brief       Returns the size of the systems.
+     * 
+     * @return int the number of unknowns of each system.
+     */
+    int Size() const;
+
+    /**
+     * @brief       Returns the number of systems.
+     * 
+     * @return int the number of systems of the last factorization.
+     */
+    int NumSystems() const;
+
+    /**
+     * @brief       Tells if the pattern has been analyzed.
+     * 
+     * @return true if a sparsity pattern has been analyzed.
+     * @return false otherwise.
+     */
+    bool IsAnalyzed() const;
+
+    /**
+     * @brief       Tells if the matrices have been factorized.
+     * 
+     * @return true if a numerical factorization is available.
+     * @return false otherwise.
+     */
+    bool IsFactorized() const;
+
+
+    /**
+     * @brief       Solve the linear systems in place.
+     * 
+     * @details     This method overwrites each column of <code>X</code> with the solution
+     *              of the corresponding factorized system, having that column as
+     *              right-hand side.\n
+     *              If no factorization is available or the size of <code>X</code> is
+     *              wrong, the method throws a pwd::AssertFailException.
+     * 
+     * @param X     The right-hand sides on input, the solutions on output.
+     * 
+     * @throws pwd::AssertFailException if the systems are not factorized or the size
+     *                                  of <code>X</code> is wrong.
+     */
+    void SolveInPlace(pwd::RowMatrixXd& X) const;
+};
+
+} // namespace pwd
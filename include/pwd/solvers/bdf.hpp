@@ -0,0 +1,343 @@
+/**
+ * @file        bdf.hpp
+ * 
+ * @brief       Declaration of the kernels of the fixed-step BDF schemes.
+ * 
+ * @details     This file contains the coefficients of the backward differentiation
+ *              formulas from order 1 to 6, and the kernels building the right-hand side
+ *              of a fixed-step scheme from its history.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <utility>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       The coefficients of a BDF scheme.
+ * 
+ * @details     The backward differentiation formula of order k advances the solution of
+ *              <code>dy/dt = f(y)</code> with a step dt as
+ *              <code>y[n+1] - Alpha * dt * f(y[n+1]) = sum_j Beta[j] * y[n+1-k+j]</code>,
+ *              that is with the coefficients of the history ordered from the oldest
+ *              state to the newest one.
+ * 
+ * @tparam Order    The order of the scheme, from 1 to 6.
+ */
+template<int Order>
+struct BDFCoefficients;
+
+template<>
+struct BDFCoefficients<1>
+{
+    static constexpr double Alpha = 1.0;
+    static constexpr double Beta[1] = { 1.0 };
+};
+
+template<>
+struct BDFCoefficients<2>
+{
+    static constexpr double Alpha = 2.0 / 3.0;
+    static constexpr double Beta[2] = { -1.0 / 3.0, 4.0 / 3.0 };
+};
+
+template<>
+struct BDFCoefficients<3>
+{
+    static constexpr double Alpha = 6.0 / 11.0;
+    static constexpr double Beta[3] = { 2.0 / 11.0, -9.0 / 11.0, 18.0 / 11.0 };
+};
+
+template<>
+struct BDFCoefficients<4>
+{
+    static constexpr double Alpha = 12.0 / 25.0;
+    static constexpr double Beta[4] = { -3.0 / 25.0, 16.0 / 25.0, -36.0 / 25.0, 48.0 / 25.0 };
+};
+
+template<>
+struct BDFCoefficients<5>
+{
+    static constexpr double Alpha = 60.0 / 137.0;
+    static constexpr double Beta[5] = {
+        12.0 / 137.0,
+        -75.0 / 137.0,
+        200.0 / 137.0,
+        -300.0 / 137.0,
+        300.0 / 137.0
+    };
+};
+
+template<>
+struct BDFCoefficients<6>
+{
+    static constexpr double Alpha = 60.0 / 147.0;
+    static constexpr double Beta[6] = {
+        -10.0 / 147.0,
+        72.0 / 147.0,
+        -225.0 / 147.0,
+        400.0 / 147.0,
+        -450.0 / 147.0,
+        360.0 / 147.0
+    };
+};
+
+
+/**
+ * @brief       Returns the implicit coefficient of a BDF scheme.
+ * 
+ * @details     This function returns <code>BDFCoefficients<Order>::Alpha</code> for an
+ *              order known only at runtime.\n
+ *              If the order is not between 1 and 6, the function throws a
+ *              pwd::AssertFailException.
+ * 
+ * @param Order     The order of the scheme.
+ * @return double the coefficient of the implicit term.
+ * 
+ * @throws pwd::AssertFailException if <code>Order</code> is out of range.
+ */
+inline double BDFAlpha(int Order)
+{
+    static constexpr double Alphas[6] = {
+        BDFCoefficients<1>::Alpha,
+        BDFCoefficients<2>::Alpha,
+        BDFCoefficients<3>::Alpha,
+        BDFCoefficients<4>::Alpha,
+        BDFCoefficients<5>::Alpha,
+        BDFCoefficients<6>::Alpha
+    };
+    Assert(Order >= 1 && Order <= 6);
+    return Alphas[Order - 1];
+}
+
+
+/**
+ * @brief       Combine the older states of a BDF history.
+ * 
+ * @details     This function returns the sum of the J-th coefficient times the i-th
+ *              element of the state <code>History[J + 1]</code>, for each J in the
+ *              sequence. The sum is expanded at compile time.
+ * 
+ * @tparam Order        The order of the scheme.
+ * @tparam AccumScalar  The type of the sum.
+ * @tparam Scalar       The type of the history.
+ * @tparam J            The indices of the coefficients.
+ * 
+ * @param History   The states of the history.
+ * @param i         The index of the element.
+ * @return AccumScalar the combination of the older states.
+ */
+template<int Order, typename AccumScalar, typename Scalar, int... J>
+inline AccumScalar BDFHistorySum([[maybe_unused]] const Scalar* const* History,
+                                 [[maybe_unused]] int i,
+                                 std::integer_sequence<int, J...>)
+{
+    // The sequence is empty for the first order, which does not read the history
+    return (AccumScalar(0) + ... +
+            (AccumScalar(BDFCoefficients<Order>::Beta[J]) * AccumScalar(History[J + 1][i])));
+}
+
+/**
+ * @brief       Build the right-hand side of a BDF step.
+ * 
+ * @details     This function advances the history of a fixed-step BDF scheme of the
+ *              given order and computes the right-hand side of its next step, in a single
+ *              pass over the memory.\n
+ *              <code>History</code> holds the <code>Order</code> slots of a circular
+ *              buffer, from the oldest to the newest, and <code>Current</code> is the
+ *              last computed state. The oldest slot is overwritten with the current
+ *              state, and <code>Rhs</code> receives the combination of the new history.
+ *              The caller then moves the head of the buffer to the next slot.\n
+ *              <code>Rhs</code> can be the same array of <code>Current</code>, but not
+ *              of any slot of the history.
+ * 
+ * @tparam Order        The order of the scheme.
+ * @tparam AccumScalar  The type of the sums.
+ * @tparam Scalar       The type of the history.
+ * @tparam OutScalar    The type of the right-hand side.
+ * 
+ * @param History   The slots of the history, from the oldest to the newest.
+ * @param Current   The last computed state.
+ * @param Rhs       The right-hand side of the next step.
+ * @param n         The size of the states.
+ */
+template<int Order, typename AccumScalar, typename Scalar, typename OutScalar>
+inline void BDFKernel(Scalar* const* History, const Scalar* Current, OutScalar* Rhs, int n)
+{
+    const Scalar* const* Older = History;
+    Scalar* Oldest = History[0];
+    for (int i = 0; i < n; ++i)
+    {
+        Scalar y = Current[i];
+        AccumScalar Sum = BDFHistorySum<Order, AccumScalar>(Older, i,
+                                                            std::make_integer_sequence<int, Order - 1>());
+        Oldest[i] = y;
+        Rhs[i] = OutScalar(Sum + AccumScalar(BDFCoefficients<Order>::Beta[Order - 1]) * AccumScalar(y));
+    }
+}
+
+/**
+ * @brief       Build the right-hand side of a BDF step of any order.
+ * 
+ * @details     This function calls the instance of BDFKernel() of the given order, as
+ *              known at runtime.\n
+ *              If the order is not between 1 and 6, the function throws a
+ *              pwd::AssertFailException.
+ * 
+ * @tparam AccumScalar  The type of the sums.
+ * @tparam Scalar       The type of the history.
+ * @tparam OutScalar    The type of the right-hand side.
+ * 
+ * @param Order     The order of the scheme.
+ * @param History   The slots of the history, from the oldest to the newest.
+ * @param Current   The last computed state.
+ * @param Rhs       The right-hand side of the next step.
+ * @param n         The size of the states.
+ * 
+ * @throws pwd::AssertFailException if <code>Order</code> is out of range.
+ */
+template<typename AccumScalar, typename Scalar, typename OutScalar>
+inline void BDFRhs(int Order, Scalar* const* History, const Scalar* Current, OutScalar* Rhs, int n)
+{
+    switch (Order)
+    {
+    case 1:
+        BDFKernel<1, AccumScalar>(History, Current, Rhs, n);
+        break;
+    case 2:
+        BDFKernel<2, AccumScalar>(History, Current, Rhs, n);
+        break;
+    case 3:
+        BDFKernel<3, AccumScalar>(History, Current, Rhs, n);
+        break;
+    case 4:
+        BDFKernel<4, AccumScalar>(History, Current, Rhs, n);
+        break;
+    case 5:
+        BDFKernel<5, AccumScalar>(History, Current, Rhs, n);
+        break;
+    case 6:
+        BDFKernel<6, AccumScalar>(History, Current, Rhs, n);
+        break;
+    default:
+        Assert(Order >= 1 && Order <= 6);
+    }
+}
+
+
+/**
+ * @brief       Interpolate the states of a BDF history.
+ * 
+ * @details     This function evaluates the polynomial of the given degree through the
+ *              last <code>Order + 1</code> states of a fixed-step scheme, that is the
+ *              dense output of the scheme between its steps.\n
+ *              The states are at the times <code>-Order, ..., -1, 0</code> in units of
+ *              the time step, with <code>History</code> holding the older ones from the
+ *              oldest and <code>Current</code> the last one. The polynomial is
+ *              evaluated at <code>s</code>, which should be between -1 and 0.
+ * 
+ * @tparam Order        The degree of the polynomial.
+ * @tparam Scalar       The type of the history.
+ * @tparam OutScalar    The type of the interpolated state.
+ * 
+ * @param History   The older states, from the oldest to the newest.
+ * @param Current   The last computed state.
+ * @param s         The time point, relative to the last state and in time steps.
+ * @param Out       The interpolated state.
+ * @param n         The size of the states.
+ */
+template<int Order, typename Scalar, typename OutScalar>
+inline void BDFInterpolate(const Scalar* const* History,
+                           const Scalar* Current,
+                           double s,
+                           OutScalar* Out,
+                           int n)
+{
+    // Lagrange weights of the nodes -Order, ..., 0
+    double W[Order + 1];
+    for (int j = 0; j <= Order; ++j)
+    {
+        W[j] = 1.0;
+        for (int m = 0; m <= Order; ++m)
+        {
+            if (m != j)
+                W[j] *= (s + Order - m) / (j - m);
+        }
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        double y = W[Order] * Current[i];
+        for (int j = 0; j < Order; ++j)
+            y += W[j] * History[j][i];
+        Out[i] = OutScalar(y);
+    }
+}
+
+/**
+ * @brief       Interpolate the states of a BDF history with any degree.
+ * 
+ * @details     This function calls the instance of BDFInterpolate() of the given degree,
+ *              as known at runtime. <code>History</code> holds the
+ *              <code>Order</code> states before the last one, from the oldest.\n
+ *              If the degree is not between 0 and 6, the function throws a
+ *              pwd::AssertFailException.
+ * 
+ * @tparam Scalar       The type of the history.
+ * @tparam OutScalar    The type of the interpolated state.
+ * 
+ * @param Order     The degree of the polynomial.
+ * @param History   The older states, from the oldest to the newest.
+ * @param Current   The last computed state.
+ * @param s         The time point, relative to the last state and in time steps.
+ * @param Out       The interpolated state.
+ * @param n         The size of the states.
+ * 
+ * @throws pwd::AssertFailException if <code>Order</code> is out of range.
+ */
+template<typename Scalar, typename OutScalar>
+inline void BDFDenseOutput(int Order,
+                           const Scalar* const* History,
+                           const Scalar* Current,
+                           double s,
+                           OutScalar* Out,
+                           int n)
+{
+    switch (Order)
+    {
+    case 0:
+        BDFInterpolate<0>(History, Current, s, Out, n);
+        break;
+    case 1:
+        BDFInterpolate<1>(History, Current, s, Out, n);
+        break;
+    case 2:
+        BDFInterpolate<2>(History, Current, s, Out, n);
+        break;
+    case 3:
+        BDFInterpolate<3>(History, Current, s, Out, n);
+        break;
+    case 4:
+        BDFInterpolate<4>(History, Current, s, Out, n);
+        break;
+    case 5:
+        BDFInterpolate<5>(History, Current, s, Out, n);
+        break;
+    case 6:
+        BDFInterpolate<6>(History, Current, s, Out, n);
+        break;
+    default:
+        Assert(Order >= 0 && Order <= 6);
+    }
+}
+
+} // namespace pwd
@@ -0,0 +1,55 @@
+/**
+ * @file        eigenupdate.hpp
+ * 
+ * @brief       Declaration of the rank-one update of a symmetric eigendecomposition.
+ * 
+ * @details     This file contains the declaration of a function that updates the
+ *              eigendecomposition of a symmetric matrix after a symmetric rank-one
+ *              change, without computing it again from scratch.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       Update a symmetric eigendecomposition after a rank-one change.
+ * 
+ * @details     Given the eigendecomposition <code>H = Q * diag(Evals) * Q^T</code> of a
+ *              symmetric matrix and a vector <code>u</code>, this function computes the
+ *              eigendecomposition of <code>H + Rho * u * u^T</code> from the vector
+ *              <code>z = Q^T * u</code>.\n
+ *              The new eigenvalues are the roots of the secular equation, and the new
+ *              eigenvectors are computed with the method of Gu and Eisenstat, so that
+ *              they stay orthogonal. Eigenpairs that are not affected by the change are
+ *              deflated and left untouched.\n
+ *              The eigenvectors are never used explicitly: the columns of
+ *              <code>Basis</code> undergo the same orthogonal transformation of the
+ *              columns of <code>Q</code>. Hence, <code>Basis</code> can be any matrix
+ *              of the form <code>M * Q</code>.\n
+ *              The update costs a matrix product with the non-deflated columns of the
+ *              basis, instead of a full eigendecomposition.
+ * 
+ * @param Evals     The eigenvalues, overwritten with the updated ones.
+ * @param Basis     The eigenvectors (or a matrix of the form M * Q), updated in place.
+ * @param z         The vector Q^T * u.
+ * @param Rho       The coefficient of the rank-one change.
+ * 
+ * @throws pwd::AssertFailException if the sizes are not consistent.
+ */
+void RankOneEigenUpdate(Eigen::VectorXd& Evals,
+                        Eigen::MatrixXd& Basis,
+                        const Eigen::VectorXd& z,
+                        double Rho);
+
+} // namespace pwd
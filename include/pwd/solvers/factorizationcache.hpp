@@ -0,0 +1,259 @@
+/**
+ * @file        factorizationcache.hpp
+ * 
+ * @brief       Declaration of a cache of factorizations of the time stepping.
+ * 
+ * @details     This file contains the declaration of a class that keeps the
+ *              factorizations of the implicit systems of a few time steps, so that
+ *              switching between them does not factorize the system again.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/solvers/linearsolver.hpp>
+#include <memory>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A least recently used cache of factorizations.
+ * 
+ * @details     The class pwd::FactorizationCache holds up to a fixed number of
+ *              pwd::LinearSolver, each with the factorization of a matrix sharing the
+ *              same sparsity pattern, identified by a key such as the time step.\n
+ *              When the cache is full, the solver of the least recently used key is
+ *              reused for the new one. Since the pattern does not change, a reused
+ *              solver keeps its symbolic analysis and only needs the numerical
+ *              factorization, and a new solver copies the analysis of the pattern,
+ *              which the cache computes only once.
+ */
+class FactorizationCache
+{
+private:
+    /**
+     * @brief       The backend.
+     * 
+     * @details     The backend of all the solvers.
+     */
+    pwd::SolverBackend m_Backend;
+
+    /**
+     * @brief       The thread pool.
+     * 
+     * @details     The pool of the solvers, nullptr if they run sequentially.
+     */
+    pwd::ThreadPool* m_Pool;
+
+    /**
+     * @brief       Maximum number of solvers.
+     * 
+     * @details     The maximum number of factorizations held by the cache.
+     */
+    int m_Capacity;
+
+    /**
+     * @brief       The keys.
+     * 
+     * @details     The key of each solver, from the most recently used to the least
+     *              recently used. The key of a solver with no factorization is NaN.
+     */
+    std::vector<double> m_Keys;
+
+    /**
+     * @brief       The solvers.
+     * 
+     * @details     The solvers, in the same order of the keys.
+     */
+    std::vector<std::unique_ptr<pwd::LinearSolver>> m_Solvers;
+
+    /**
+     * @brief       The analysis of the pattern.
+     * 
+     * @details     A solver that only holds the symbolic analysis of the common
+     *              pattern, copied by the solvers instead of analyzing it again.
+     */
+    std::unique_ptr<pwd::LinearSolver> m_Analysis;
+
+
+    /**
+     * @brief       Mark a solver as the most recently used.
+     * 
+     * @param i     The position of the solver.
+     * @return pwd::LinearSolver* the solver, now in the first position.
+     */
+    pwd::LinearSolver* MoveToFront(int i);
+
+public:
+    /**
+     * @brief       Create an empty cache.
+     * 
+     * @details     This constructor creates a cache holding up to the given number of
+     *              factorizations computed with the given backend.\n
+     *              If the capacity is not positive, the constructor throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Capacity  The maximum number of factorizations.
+     * @param Backend   The backend of the solvers.
+     * 
+     * @throws pwd::AssertFailException if <code>Capacity < 1</code>.
+     */
+    FactorizationCache(int Capacity = 4,
+                       pwd::SolverBackend Backend = pwd::SolverBackend::SparseLU);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~FactorizationCache();
+
+
+    /**
+     * @brief       Returns the backend.
+     * 
+     * @return pwd::SolverBackend the backend of the solvers.
+     */
+    pwd::SolverBackend GetBackend() const;
+
+    /**
+     * @brief       Change the backend.
+     * 
+     * @details     This method changes the backend of the solvers.\n
+     *              If the backend actually changes, all the solvers are discarded,
+     *              together with their analysis.
+     * 
+     * @param Backend   The new backend.
+     */
+    void SetBackend(pwd::SolverBackend Backend);
+
+    /**
+     * @brief       Set the thread pool.
+     * 
+     * @details     This method sets the pool of all the solvers, see
+     *              pwd::LinearSolver::SetThreadPool().
+     * 
+     * @param Pool  The thread pool, or nullptr to run sequentially.
+     */
+    void SetThreadPool(pwd::ThreadPool* Pool);
+
+    /**
+     * @brief       Returns the capacity.
+     * 
+     * @return int the maximum number of factorizations.
+     */
+    int GetCapacity() const;
+
+    /**
+     * @brief       Change the capacity.
+     * 
+     * @details     This method changes the maximum number of factorizations. If the
+     *              cache holds more solvers, the least recently used are discarded.\n
+     *              If the capacity is not positive, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Capacity  The maximum number of factorizations.
+     * 
+     * @throws pwd::AssertFailException if <code>Capacity < 1</code>.
+     */
+    void SetCapacity(int Capacity);
+
+    /**
+     * @brief       Returns the number of factorizations.
+     * 
+     * @return int the number of solvers holding a factorization.
+     */
+    int NumFactorizations() const;
+
+
+    /**
+     * @brief       Look for the factorization of a key.
+     * 
+     * @details     This method returns the solver whose key differs from the given one
+     *              by at most <code>Tol</code>, marking it as the most recently used.
+     *              If the solver is found, <code>Key</code> is replaced with the key of
+     *              its factorization.
+     * 
+     * @param Key   The key of the factorization.
+     * @param Tol   The tolerance on the key.
+     * @return pwd::LinearSolver* the solver with the factorization, or nullptr if the
+     *                            key is not in the cache.
+     */
+    pwd::LinearSolver* Find(double& Key, double Tol);
+
+    /**
+     * @brief       Returns the factorization of a key.
+     * 
+     * @details     This method returns the solver factorized for exactly the given key,
+     *              without marking it as used.
+     * 
+     * @param Key   The key of the factorization.
+     * @return const pwd::LinearSolver* the solver with the factorization, or nullptr
+     *                                  if the key is not in the cache.
+     */
+    const pwd::LinearSolver* Lookup(double Key) const;
+
+    /**
+     * @brief       Add a key.
+     * 
+     * @details     This method returns the solver for the factorization of a new key,
+     *              marking it as the most recently used. The solver is a new one, or
+     *              one with no factorization, or the one of the least recently used
+     *              key if the cache is full.\n
+     *              The caller must factorize the matrix of the key with the returned
+     *              solver, calling Analyze() only if pwd::LinearSolver::IsAnalyzed() is
+     *              false.
+     * 
+     * @param Key   The key of the factorization.
+     * @return pwd::LinearSolver* the solver of the key, with no factorization.
+     */
+    pwd::LinearSolver* Insert(double Key);
+
+    /**
+     * @brief       Analyze the pattern of a solver.
+     * 
+     * @details     This method gives the solver the symbolic analysis of the given
+     *              matrix. The pattern is analyzed the first time, and the following
+     *              solvers copy its analysis, see pwd::LinearSolver::CopyAnalysis().
+     *              Hence, the matrix must have the pattern of the keys, and the solver
+     *              may also be one outside the cache.\n
+     *              If the backend of the solver is not the one of the cache, the method
+     *              throws a pwd::AssertFailException.
+     * 
+     * @param Solver    The solver to analyze.
+     * @param A         A matrix with the common pattern.
+     * 
+     * @throws pwd::AssertFailException if the backend of the solver is wrong.
+     */
+    void Analyze(pwd::LinearSolver& Solver, const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Discard the factorizations.
+     * 
+     * @details     This method discards the factorizations of all the keys but the one
+     *              of the given solver, keeping the analysis of the pattern. This is
+     *              needed when the values of the matrices change.
+     * 
+     * @param Keep  The solver whose factorization is still valid, or nullptr.
+     */
+    void Clear(const pwd::LinearSolver* Keep = nullptr);
+
+    /**
+     * @brief       Discard the solvers.
+     * 
+     * @details     This method discards all the solvers and the analysis of the
+     *              pattern.
+     *              This is needed when the pattern of the matrices changes.
+     */
+    void Reset();
+};
+
+} // namespace pwd
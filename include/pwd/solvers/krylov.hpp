@@ -0,0 +1,267 @@
+/**
+ * @file        krylov.hpp
+ * 
+ * @brief       Declaration of a Krylov solver for the action of the matrix exponential.
+ * 
+ * @details     This file contains the declaration of a class that computes the product
+ *              between the exponential of a sparse symmetric matrix and a vector, without
+ *              computing any dense decomposition.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/solvers/linearsolver.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       Krylov solver for the action of the matrix exponential.
+ * 
+ * @details     The class pwd::KrylovExponential computes <code>exp(t * H) * v</code>
+ *              for a sparse symmetric negative semi-definite matrix <code>H</code>.\n
+ *              The systems of the water model are extremely stiff, and a polynomial
+ *              Krylov space would need thousands of iterations to resolve the slow
+ *              modes. Hence, the Lanczos process is run on the shifted inverse
+ *              <code>(I - gamma * H)^(-1)</code>, which converges in a handful of
+ *              iterations independently of the norm of <code>H</code>. The shifted
+ *              matrix is factorized with a pwd::LinearSolver, and the factorization is
+ *              reused as long as the shift does not change.\n
+ *              The iteration stops when two consecutive approximations differ less than
+ *              the relative tolerance. If the basis grows too large, the time interval
+ *              is split in smaller steps.
+ */
+class KrylovExponential
+{
+private:
+    /**
+     * @brief       The matrix.
+     * 
+     * @details     The symmetric matrix of which computing the exponential.
+     */
+    Eigen::SparseMatrix<double> m_H;
+
+    /**
+     * @brief       The relative tolerance.
+     * 
+     * @details     The relative tolerance on the computed product.
+     */
+    double m_Tolerance;
+
+    /**
+     * @brief       Maximum size of the Krylov basis.
+     * 
+     * @details     The maximum number of Lanczos iterations for a single step.
+     */
+    int m_MaxBasis;
+
+    /**
+     * @brief       The shift of the factorized matrix.
+     * 
+     * @details     The value <code>gamma</code> such that the factorized matrix is
+     *              <code>I - gamma * H</code>. A non-positive value means that no
+     *              factorization is available.
+     */
+    double m_Gamma;
+
+    /**
+     * @brief       The solver for the shifted matrix.
+     * 
+     * @details     The direct solver holding the factorization of the shifted matrix.
+     */
+    pwd::LinearSolver m_Solver;
+
+    /**
+     * @brief       The shifted matrix.
+     * 
+     * @details     The factorized matrix <code>I - gamma * H</code>.
+     */
+    Eigen::SparseMatrix<double> m_Shifted;
+
+    /**
+     * @brief       The Krylov basis.
+     * 
+     * @details     The orthonormal basis of the Krylov space, one vector per column.
+     */
+    Eigen::MatrixXd m_Basis;
+
+    /**
+     * @brief       Diagonal of the Lanczos matrix.
+     * 
+     * @details     The diagonal of the tridiagonal matrix produced by the Lanczos process.
+     */
+    Eigen::VectorXd m_Alpha;
+
+    /**
+     * @brief       Subdiagonal of the Lanczos matrix.
+     * 
+     * @details     The subdiagonal of the tridiagonal matrix produced by the Lanczos
+     *              process.
+     */
+    Eigen::VectorXd m_Beta;
+
+    /**
+     * @brief       Number of iterations.
+     * 
+     * @details     The total number of Lanczos iterations of the last call to Apply().
+     */
+    int m_NumIterations;
+
+
+    /**
+     * @brief       Factorize the shifted matrix.
+     * 
+     * @details     This method factorizes <code>I - Gamma * H</code>, unless the
+     *              current factorization already uses the given shift.
+     * 
+     * @param Gamma     The shift.
+     */
+    void Factorize(double Gamma);
+
+    /**
+     * @brief       Advance a vector by a single step.
+     * 
+     * @details     This method overwrites <code>w</code> with <code>exp(Tau * H) * w</code>,
+     *              if the Lanczos process converges within the maximum basis size.
+     *              The process runs on the inverse of <code>I - Gamma * H</code>.
+     * 
+     * @param Tau   The length of the step.
+     * @param Gamma The shift.
+     * @param w     The vector to advance.
+     * @return true if the process converged and <code>w</code> has been updated.
+     * @return false if the process did not converge.
+     */
+    bool Step(double Tau, double Gamma, Eigen::VectorXd& w);
+
+public:
+    /**
+     * @brief       Create a Krylov solver.
+     * 
+     * @details     This constructor creates a Krylov solver with the given tolerance and
+     *              maximum basis size.\n
+     *              The tolerance and the basis size must be positive, otherwise the
+     *              constructor throws a pwd::AssertFailException.
+     * 
+     * @param Tolerance     The relative tolerance.
+     * @param MaxBasis      The maximum size of the Krylov basis.
+     * 
+     * @throws pwd::AssertFailException if <code>Tolerance <= 0</code> or
+     *                                  <code>MaxBasis < 2</code>.
+     */
+    KrylovExponential(double Tolerance = 1e-8, int MaxBasis = 40);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~KrylovExponential();
+
+
+    /**
+     * @brief       Set the matrix.
+     * 
+     * @details     This method sets the sparse symmetric negative semi-definite matrix
+     *              of which computing the exponential, and discards any factorization.
+     * 
+     * @param H     A sparse symmetric negative semi-definite matrix.
+     * 
+     * @throws pwd::AssertFailException if <code>H</code> is not square.
+     */
+    void SetMatrix(const Eigen::SparseMatrix<double>& H);
+
+    /**
+     * @brief       Update the matrix after a local change.
+     * 
+     * @details     This method copies the entries <code>H(i, j)</code> where both
+     *              <code>i</code> and <code>j</code> are in <code>Nodes</code>, and updates
+     *              the factorization accordingly, instead of discarding it.\n
+     *              The given matrix must have the same sparsity pattern of the current
+     *              one, otherwise the method throws a pwd::AssertFailException.
+     * 
+     * @param H     The changed matrix.
+     * @param Nodes The nodes whose entries changed.
+     * 
+     * @throws pwd::AssertFailException if the pattern of <code>H</code> differs.
+     */
+    void UpdateMatrix(const Eigen::SparseMatrix<double>& H, const std::vector<int>& Nodes);
+
+    /**
+     * @brief       Returns the relative tolerance.
+     * 
+     * @return double the relative tolerance.
+     */
+    double GetTolerance() const;
+
+    /**
+     * @brief       Set the relative tolerance.
+     * 
+     * @param Tolerance     The relative tolerance.
+     * 
+     * @throws pwd::AssertFailException if <code>Tolerance <= 0</code>.
+     */
+    void SetTolerance(double Tolerance);
+
+    /**
+     * @brief       Returns the maximum size of the Krylov basis.
+     * 
+     * @return int the maximum size of the Krylov basis.
+     */
+    int GetMaxBasis() const;
+
+    /**
+     * @brief       Set the maximum size of the Krylov basis.
+     * 
+     * @param MaxBasis  The maximum size of the Krylov basis.
+     * 
+     * @throws pwd::AssertFailException if <code>MaxBasis < 2</code>.
+     */
+    void SetMaxBasis(int MaxBasis);
+
+    /**
+     * @brief       Set the backend of the shifted solver.
+     * 
+     * @details     This method sets the direct solver used to factorize the shifted
+     *              matrix.
+     * 
+     * @param Backend   The backend of the shifted solver.
+     */
+    void SetBackend(pwd::SolverBackend Backend);
+
+    /**
+     * @brief       Returns the number of iterations.
+     * 
+     * @details     This method returns the total number of Lanczos iterations performed
+     *              by the last call to Apply().
+     * 
+     * @return int the number of iterations.
+     */
+    int NumIterations() const;
+
+
+    /**
+     * @brief       Compute the action of the matrix exponential.
+     * 
+     * @details     This method computes <code>exp(Time * H) * v</code>.\n
+     *              If the time is negative or the size of the vector is wrong, the
+     *              method throws a pwd::AssertFailException.
+     * 
+     * @param Time      The time.
+     * @param v         The vector.
+     * @param Out       The vector <code>exp(Time * H) * v</code>.
+     * 
+     * @throws pwd::AssertFailException if <code>Time < 0</code> or the size of
+     *                                  <code>v</code> is wrong.
+     */
+    void Apply(double Time, const Eigen::VectorXd& v, Eigen::VectorXd& Out);
+};
+
+} // namespace pwd
@@ -0,0 +1,345 @@
+/**
+ * @file        linearsolver.hpp
+ * 
+ * @brief       Declaration of a sparse linear solver with selectable backend.
+ * 
+ * @details     This file contains the declaration of a class that wraps the direct
+ *              sparse solvers available to the water diffusion model behind a single
+ *              interface.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/solvers/treesolver.hpp>
+#include <pwd/solvers/paralleltreesolver.hpp>
+#include <Eigen/SparseLU>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       The available direct solvers.
+ * 
+ * @details     This enumeration lists the backends that a pwd::LinearSolver can use.
+ */
+enum class SolverBackend
+{
+    /**
+     * @brief   General sparse LU factorization with COLAMD ordering.
+     */
+    SparseLU,
+
+    /**
+     * @brief   Fill-free tree elimination, see pwd::TreeSolver.
+     */
+    Tree,
+
+    /**
+     * @brief   Tree elimination of subtrees on a thread pool, see
+     *          pwd::ParallelTreeSolver.
+     */
+    ParallelTree
+};
+
+
+/**
+ * @brief       A sparse LU solver with a reusable analysis.
+ * 
+ * @details     The class pwd::SharedSparseLU is the sparse LU solver of Eigen with
+ *              COLAMD ordering, whose symbolic analysis can be copied from another
+ *              solver analyzed for the same sparsity pattern. The analysis of Eigen is
+ *              the column ordering with the elimination tree, and the copy gives
+ *              bitwise the same factorization.
+ */
+class SharedSparseLU : public Eigen::SparseLU<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>>
+{
+public:
+    /**
+     * @brief       Copy the symbolic analysis of another solver.
+     * 
+     * @details     This method replaces the analysis of this solver with the one of the
+     *              given solver, discarding the factorization.\n
+     *              If the given solver has not analyzed a pattern, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Analyzed  A solver that analyzed the pattern.
+     * 
+     * @throws pwd::AssertFailException if the solver has no analysis.
+     */
+    void CopyAnalysis(const pwd::SharedSparseLU& Analyzed);
+};
+
+
+/**
+ * @brief       A direct sparse linear solver with selectable backend.
+ * 
+ * @details     The class pwd::LinearSolver solves sparse linear systems using one of
+ *              the backends listed in pwd::SolverBackend.\n
+ *              Changing the backend invalidates any analysis and factorization.
+ */
+class LinearSolver
+{
+private:
+    /**
+     * @brief       The active backend.
+     * 
+     * @details     The backend used for analysis, factorization and solution.
+     */
+    pwd::SolverBackend m_Backend;
+
+    /**
+     * @brief       General sparse LU solver.
+     * 
+     * @details     The solver used by the pwd::SolverBackend::SparseLU backend.
+     */
+    pwd::SharedSparseLU m_LU;
+
+    /**
+     * @brief       Work vector of the sparse LU solver.
+     * 
+     * @details     The permuted right-hand side of the pwd::SolverBackend::SparseLU
+     *              backend. Eigen applies the permutations in place with temporary
+     *              buffers, hence they are applied from and to this vector.
+     */
+    mutable Eigen::VectorXd m_Work;
+
+    /**
+     * @brief       Tree solver.
+     * 
+     * @details     The solver used by the pwd::SolverBackend::Tree backend.
+     */
+    pwd::TreeSolver m_Tree;
+
+    /**
+     * @brief       Parallel tree solver.
+     * 
+     * @details     The solver used by the pwd::SolverBackend::ParallelTree backend.
+     */
+    pwd::ParallelTreeSolver m_ParallelTree;
+
+    /**
+     * @brief       Pattern analyzed.
+     * 
+     * @details     This value tells if the active backend holds a symbolic analysis.
+     */
+    bool m_Analyzed;
+
+    /**
+     * @brief       Matrix factorized.
+     * 
+     * @details     This value tells if the active backend holds a factorization.
+     */
+    bool m_Factorized;
+
+public:
+    /**
+     * @brief       Create a solver with the given backend.
+     * 
+     * @details     This constructor creates a solver using the given backend.
+     * 
+     * @param Backend   The backend of the solver.
+     */
+    LinearSolver(pwd::SolverBackend Backend = pwd::SolverBackend::SparseLU);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~LinearSolver();
+
+
+    /**
+     * @brief       Returns the active backend.
+     * 
+     * @return pwd::SolverBackend the active backend.
+     */
+    pwd::SolverBackend GetBackend() const;
+
+    /**
+     * @brief       Change the backend.
+     * 
+     * @details     This method changes the backend of the solver.\n
+     *              If the backend actually changes, the current factorization is
+     *              discarded.
+     * 
+     * @param Backend   The new backend.
+     */
+    void SetBackend(pwd::SolverBackend Backend);
+
+    /**
+     * @brief       Set the thread pool.
+     * 
+     * @details     This method sets the pool used by the pwd::SolverBackend::ParallelTree
+     *              backend, see pwd::ParallelTreeSolver::SetThreadPool().
+     * 
+     * @param Pool  The thread pool, or nullptr to run sequentially.
+     */
+    void SetThreadPool(pwd::ThreadPool* Pool);
+
+
+    /**
+     * @brief       Analyze the sparsity pattern of a matrix.
+     * 
+     * @details     This method performs the symbolic analysis of the given matrix with
+     *              the active backend.
+     * 
+     * @param A     A square sparse matrix.
+     */
+    void AnalyzePattern(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Copy the symbolic analysis of another solver.
+     * 
+     * @details     This method gives this solver the analysis of the given one, so
+     *              that many solvers of the same pattern analyze it only once. The
+     *              copy is not timed as a pwd::Phase::SymbolicFactorization.\n
+     *              If the given solver has not analyzed a pattern or has another
+     *              backend, the method throws a pwd::AssertFailException.
+     * 
+     * @param Analyzed  A solver with the same backend that analyzed the pattern.
+     * 
+     * @throws pwd::AssertFailException if the analysis cannot be copied.
+     */
+    void CopyAnalysis(const pwd::LinearSolver& Analyzed);
+
+    /**
+     * @brief       Factorize a matrix.
+     * 
+     * @details     This method computes the numerical factorization of the given matrix,
+     *              that must have the last analyzed sparsity pattern.\n
+     *              If the factorization fails, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param A     A square sparse matrix.
+     * 
+     * @throws pwd::AssertFailException if the factorization fails.
+     */
+    void Factorize(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Analyze and factorize a matrix.
+     * 
+     * @details     This method is equivalent to calling AnalyzePattern() and Factorize().
+     * 
+     * @param A     A square sparse matrix.
+     */
+    void Compute(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Update the factorization after a local change.
+     * 
+     * @details     This method updates the numerical factorization after a change of the
+     *              entries <code>A(i, j)</code> where both <code>i</code> and
+     *              <code>j</code> are in <code>Nodes</code>, keeping the analyzed
+     *              pattern. The tree backend only eliminates again the paths from the
+     *              given nodes to their roots, while the other backends compute the
+     *              numerical factorization again.\n
+     *              If no factorization is available, the method does nothing.
+     * 
+     * @param A     The changed matrix, with the analyzed sparsity pattern.
+     * @param Nodes The nodes whose entries changed.
+     * 
+     * @throws pwd::AssertFailException if the factorization fails.
+     */
+    void Refactorize(const Eigen::SparseMatrix<double>& A, const std::vector<int>& Nodes);
+
+    /**
+     * @brief       Save the numerical factorization.
+     * 
+     * @details     This method writes the factorization of the tree backend, see
+     *              pwd::TreeSolver::SaveFactorization(). The factors of the other
+     *              backends cannot be stored.\n
+     *              If the matrix is not factorized or the backend is not the tree one,
+     *              the method throws a pwd::AssertFailException.
+     * 
+     * @param Writer    The binary writer.
+     * 
+     * @throws pwd::AssertFailException if the factorization cannot be saved.
+     */
+    void SaveFactorization(pwd::BinaryWriter& Writer) const;
+
+    /**
+     * @brief       Load the numerical factorization.
+     * 
+     * @details     This method reads the factorization written by SaveFactorization()
+     *              for the analyzed pattern.\n
+     *              If no pattern has been analyzed, the backend is not the tree one or
+     *              the factorization is not valid, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Reader    The binary reader.
+     * 
+     * @throws pwd::AssertFailException if the factorization cannot be loaded.
+     */
+    void LoadFactorization(pwd::BinaryReader& Reader);
+
+    /**
+     * @brief       Tells if the matrix has been factorized.
+     * 
+     * @return true if a numerical factorization is available.
+     * @return false otherwise.
+     */
+    bool IsFactorized() const;
+
+    /**
+     * @brief       Tells if a pattern has been analyzed.
+     * 
+     * @details     An analyzed solver can factorize any matrix with the same sparsity
+     *              pattern, without analyzing it again.
+     * 
+     * @return true if a symbolic analysis is available.
+     * @return false otherwise.
+     */
+    bool IsAnalyzed() const;
+
+    /**
+     * @brief       Discard the factorization.
+     * 
+     * @details     This method marks the factorization as not available, so that the
+     *              matrix must be factorized again before solving any system. The
+     *              analysis of the pattern is kept.
+     */
+    void Clear();
+
+
+    /**
+     * @brief       Solve the linear system.
+     * 
+     * @details     This method solves the factorized linear system with the given
+     *              right-hand side.\n
+     *              If no factorization is available, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param b     The right-hand side.
+     * @return Eigen::VectorXd the solution of the system.
+     * 
+     * @throws pwd::AssertFailException if the system is not factorized.
+     */
+    Eigen::VectorXd Solve(const Eigen::VectorXd& b) const;
+
+    /**
+     * @brief       Solve the linear system in place.
+     * 
+     * @details     This method overwrites the given right-hand side with the solution
+     *              of the factorized system, so that repeated solves do not allocate
+     *              the result.\n
+     *              If no factorization is available, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param x     The right-hand side, overwritten with the solution.
+     * 
+     * @throws pwd::AssertFailException if the system is not factorized.
+     */
+    void SolveInPlace(Eigen::Ref<Eigen::VectorXd> x) const;
+};
+
+} // namespace pwd
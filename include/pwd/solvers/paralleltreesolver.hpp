@@ -0,0 +1,397 @@
+/**
+ * @file        paralleltreesolver.hpp
+ * 
+ * @brief       Declaration of a parallel direct solver for tree-structured linear systems.
+ * 
+ * @details     This file contains the declaration of a class that solves sparse linear
+ *              systems whose sparsity pattern is a tree, splitting the tree into
+ *              subtrees that are eliminated concurrently.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/solvers/treesolver.hpp>
+#include <pwd/utils/threadpool.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A parallel direct solver for linear systems with a tree sparsity pattern.
+ * 
+ * @details     The class pwd::ParallelTreeSolver solves the same systems of
+ *              pwd::TreeSolver, distributing the work over the workers of a
+ *              pwd::ThreadPool.\n
+ *              The analysis splits the tree at a few junction nodes into domains, which
+ *              are the connected components left by removing the junctions. Junctions
+ *              are chosen so that each domain has about the same size and is adjacent to
+ *              at most two junctions: the one above its top node and at most one below.
+ *              Hence, eliminating the nodes of a domain only couples its two junctions,
+ *              and the Schur complement on the junctions, that is the interface system,
+ *              is again a tree.\n
+ *              The factorization and the forward substitution of the domains run in
+ *              parallel, the small interface system is solved sequentially by a
+ *              pwd::TreeSolver, and the back substitution of the domains runs in
+ *              parallel again. The result is the same of a direct solution, up to the
+ *              rounding of the different elimination order.\n
+ *              Without a thread pool, the domains are processed sequentially.
+ */
+class ParallelTreeSolver
+{
+private:
+    /**
+     * @brief       Size of the system.
+     * 
+     * @details     The number of rows (and columns) of the analyzed matrix.
+     */
+    int m_N;
+
+    /**
+     * @brief       Number of non-zero entries of the analyzed matrix.
+     * 
+     * @details     This value is used to detect changes in the sparsity pattern between
+     *              the analysis and the factorization.
+     */
+    int m_NNZ;
+
+    /**
+     * @brief       Number of parts.
+     * 
+     * @details     The number of domains of about the same size in which the tree is
+     *              split, and the number of parallel tasks.
+     */
+    int m_NumParts;
+
+    /**
+     * @brief       The thread pool.
+     * 
+     * @details     The pool running the domains, or nullptr to run them sequentially.
+     */
+    pwd::ThreadPool* m_Pool;
+
+    /**
+     * @brief       The domains of each task.
+     * 
+     * @details     The task t processes the domains from <code>m_TaskBeg[t]</code> to
+     *              <code>m_TaskBeg[t + 1] - 1</code>.
+     */
+    std::vector<int> m_TaskBeg;
+
+    /**
+     * @brief       The nodes of each domain.
+     * 
+     * @details     The nodes of the domain d are at the positions from
+     *              <code>m_DomainBeg[d]</code> to <code>m_DomainBeg[d + 1] - 1</code>, in
+     *              elimination order. The last one is the top node of the domain.
+     */
+    std::vector<int> m_DomainBeg;
+
+    /**
+     * @brief       The junctions of each domain.
+     * 
+     * @details     The junction above the top node and the junction below the domain,
+     *              as indices in the interface system, or -1 if there is none.
+     */
+    std::vector<int> m_DomainTop;
+    std::vector<int> m_DomainLow;
+
+    /**
+     * @brief       The nodes of the domains.
+     * 
+     * @details     The nodes of all the domains, by position. Every node appears before
+     *              its parent.
+     */
+    std::vector<int> m_Order;
+
+    /**
+     * @brief       The parents of the domain nodes.
+     * 
+     * @details     The k-th element is the position of the parent of the node
+     *              <code>m_Order[k]</code>, or -1 if the node is the top of its domain.
+     */
+    std::vector<int> m_ParentPos;
+
+    /**
+     * @brief       The nodes coupled with each domain node.
+     * 
+     * @details     The k-th elements are the parent of the node <code>m_Order[k]</code>
+     *              and the junction below its domain. A node without a parent, or that
+     *              is not on the path from the junction below to the top, refers to
+     *              itself, with a zero coefficient.
+     */
+    std::vector<int> m_ParentNode;
+    std::vector<int> m_LowNode;
+
+    /**
+     * @brief       Positions of the entries of the domain nodes.
+     * 
+     * @details     For each position k, with <code>i = m_Order[k]</code>, the indices
+     *              inside the value array of the analyzed matrix of <code>A(i, i)</code>,
+     *              <code>A(i, parent(i))</code>, <code>A(parent(i), i)</code>,
+     *              <code>A(i, j)</code> and <code>A(j, i)</code>, where j is the junction
+     *              below the domain. The indices are -1 for missing entries.
+     */
+    std::vector<int> m_DiagIdx;
+    std::vector<int> m_UpperIdx;
+    std::vector<int> m_LowerIdx;
+    std::vector<int> m_JUpperIdx;
+    std::vector<int> m_JLowerIdx;
+
+    /**
+     * @brief       The factors of the domain nodes.
+     * 
+     * @details     For each position, the inverse pivot, the multipliers of the parent
+     *              and of the junction below, and the entries of the row towards the
+     *              parent and the junction below, fill-in included.
+     */
+    Eigen::VectorXd m_InvPivots;
+    Eigen::VectorXd m_Lower;
+    Eigen::VectorXd m_Upper;
+    Eigen::VectorXd m_JLower;
+    Eigen::VectorXd m_JUpper;
+
+    /**
+     * @brief       Support vector.
+     * 
+     * @details     Support vector used to accumulate the pivots of the domain nodes
+     *              during the factorization.
+     */
+    Eigen::VectorXd m_Pivots;
+
+    /**
+     * @brief       The Schur complement of each domain.
+     * 
+     * @details     The updates of the pivots of the junctions above and below each
+     *              domain, and the fill-in coupling them.
+     */
+    Eigen::VectorXd m_TopPivot;
+    Eigen::VectorXd m_LowPivot;
+    Eigen::VectorXd m_TopLow;
+    Eigen::VectorXd m_LowTop;
+
+    /**
+     * @brief       The junctions.
+     * 
+     * @details     The nodes of the interface system.
+     */
+    std::vector<int> m_Junctions;
+
+    /**
+     * @brief       The interface system.
+     * 
+     * @details     The Schur complement of the domains on the junctions, and its solver.
+     */
+    Eigen::SparseMatrix<double> m_Interface;
+    pwd::TreeSolver m_InterfaceSolver;
+
+    /**
+     * @brief       Positions of the entries of the interface system.
+     * 
+     * @details     The indices inside the value arrays of the analyzed matrix and of
+     *              the interface system of the entries coupling junctions, the diagonal
+     *              included, and of the entries updated by each domain.
+     */
+    std::vector<int> m_JSrcIdx;
+    std::vector<int> m_JDstIdx;
+    std::vector<int> m_TopDiagIdx;
+    std::vector<int> m_LowDiagIdx;
+    std::vector<int> m_TopLowIdx;
+    std::vector<int> m_LowTopIdx;
+
+    /**
+     * @brief       Work vectors of the solution.
+     * 
+     * @details     The updates of the junctions from each domain, and the right-hand
+     *              side of the interface system. They are allocated with the pattern,
+     *              so that a solution does not allocate memory.
+     */
+    mutable Eigen::VectorXd m_TopRhs;
+    mutable Eigen::VectorXd m_LowRhs;
+    mutable Eigen::VectorXd m_JunctionRhs;
+
+    /**
+     * @brief       Pattern analyzed.
+     * 
+     * @details     This value tells if the sparsity pattern has been analyzed.
+     */
+    bool m_Analyzed;
+
+    /**
+     * @brief       Matrix factorized.
+     * 
+     * @details     This value tells if the numerical factorization has been computed.
+     */
+    bool m_Factorized;
+
+
+    /**
+     * @brief       Run the tasks.
+     * 
+     * @details     This method calls <code>Body(t)</code> for each task, on the thread
+     *              pool if available.
+     * 
+     * @param Body  The body of the tasks.
+     */
+    void RunTasks(const std::function<void(int)>& Body) const;
+
+public:
+    /**
+     * @brief       Create an empty solver.
+     * 
+     * @details     This constructor creates a solver with no analyzed pattern, which
+     *              splits the tree in the given number of parts.\n
+     *              If the number of parts is not positive, the constructor throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param NumParts  The number of parts.
+     * 
+     * @throws pwd::AssertFailException if <code>NumParts <= 0</code>.
+     */
+    ParallelTreeSolver(int NumParts = 64);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~ParallelTreeSolver();
+
+
+    /**
+     * @brief       Set the thread pool.
+     * 
+     * @details     This method sets the pool running the domains. The pool is not owned
+     *              by the solver and must outlive it. Many solvers can share the same
+     *              pool, and a solver used by a task of the pool runs its domains on the
+     *              worker of the task.
+     * 
+     * @param Pool  The thread pool, or nullptr to run sequentially.
+     */
+    void SetThreadPool(pwd::ThreadPool* Pool);
+
+    /**
+     * @brief       Returns the thread pool.
+     * 
+     * @return pwd::ThreadPool* the thread pool, or nullptr.
+     */
+    pwd::ThreadPool* GetThreadPool() const;
+
+
+    /**
+     * @brief       Analyze the sparsity pattern of a matrix.
+     * 
+     * @details     This method splits the tree of the given matrix into domains and
+     *              junctions, and analyzes the interface system.\n
+     *              Every node must have an explicit diagonal entry and the off-diagonal
+     *              pattern must be symmetric and form a forest. Otherwise, the method
+     *              throws a pwd::AssertFailException.
+     * 
+     * @param A     A square sparse matrix with a tree sparsity pattern.
+     * 
+     * @throws pwd::AssertFailException if the pattern of <code>A</code> is not a forest.
+     */
+    void AnalyzePattern(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Compute the numerical factorization of a matrix.
+     * 
+     * @details     This method eliminates the domains in parallel and factorizes the
+     *              interface system. The matrix must have the same sparsity pattern of
+     *              the last analyzed one.\n
+     *              If no pattern has been analyzed, the pattern differs, or a zero pivot
+     *              is found, the method throws a pwd::AssertFailException.
+     * 
+     * @param A     A square sparse matrix with the analyzed sparsity pattern.
+     * 
+     * @throws pwd::AssertFailException if the pattern is not the analyzed one or the
+     *                                  matrix is singular.
+     */
+    void Factorize(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Analyze and factorize a matrix.
+     * 
+     * @details     This method is equivalent to calling AnalyzePattern() and Factorize().
+     * 
+     * @param A     A square sparse matrix with a tree sparsity pattern.
+     */
+    void Compute(const Eigen::SparseMatrix<double>& A);
+
+
+    /**
+     * @brief       Returns the size of the system.
+     * 
+     * @return int the size of the system.
+     */
+    int Size() const;
+
+    /**
+     * @brief       Returns the number of domains.
+     * 
+     * @return int the number of domains of the analyzed pattern.
+     */
+    int NumDomains() const;
+
+    /**
+     * @brief       Returns the number of junctions.
+     * 
+     * @return int the size of the interface system of the analyzed pattern.
+     */
+    int NumJunctions() const;
+
+    /**
+     * @brief       Tells if the pattern has been analyzed.
+     * 
+     * @return true if a sparsity pattern has been analyzed.
+     * @return false otherwise.
+     */
+    bool IsAnalyzed() const;
+
+    /**
+     * @brief       Tells if the matrix has been factorized.
+     * 
+     * @return true if a numerical factorization is available.
+     * @return false otherwise.
+     */
+    bool IsFactorized() const;
+
+
+    /**
+     * @brief       Solve the linear system.
+     * 
+     * @details     This method solves the factorized linear system with the given
+     *              right-hand side.\n
+     *              If the system is not factorized or the size of the right-hand side is
+     *              wrong, the method throws a pwd::AssertFailException.
+     * 
+     * @param b     The right-hand side.
+     * @return Eigen::VectorXd the solution of the system.
+     * 
+     * @throws pwd::AssertFailException if the system is not factorized.
+     */
+    Eigen::VectorXd Solve(const Eigen::VectorXd& b) const;
+
+    /**
+     * @brief       Solve the linear system in place.
+     * 
+     * @details     This method overwrites the given right-hand side with the solution
+     *              of the factorized system.\n
+     *              If the system is not factorized or the size of the right-hand side is
+     *              wrong, the method throws a pwd::AssertFailException.
+     * 
+     * @param x     The right-hand side, overwritten with the solution.
+     * 
+     * @throws pwd::AssertFailException if the system is not factorized.
+     */
+    void SolveInPlace(Eigen::Ref<Eigen::VectorXd> x) const;
+};
+
+} // namespace pwd
@@ -0,0 +1,199 @@
+/**
+ * @file        shiftinverteig.hpp
+ * 
+ * @brief       Declaration of a shift-invert eigensolver for sparse symmetric matrices.
+ * 
+ * @details     This file contains the declaration of a class that computes a few
+ *              eigenpairs of a sparse symmetric matrix, namely the ones with eigenvalues
+ *              closest to a given shift, without computing any dense decomposition.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/solvers/linearsolver.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       Shift-invert eigensolver for sparse symmetric matrices.
+ * 
+ * @details     The class pwd::ShiftInvertEigensolver computes the eigenpairs of a sparse
+ *              symmetric matrix <code>H</code> whose eigenvalues are the closest to a
+ *              shift <code>sigma</code>.\n
+ *              These are the eigenpairs of <code>(H - sigma * I)^(-1)</code> with the
+ *              largest eigenvalues in magnitude, which are computed with a thick-restart
+ *              Lanczos process (Krylov-Schur) with full reorthogonalization. The shifted
+ *              matrix is factorized once with a pwd::LinearSolver, and each iteration
+ *              costs a solve and the orthogonalization against the basis, so memory and
+ *              time scale with the size of the matrix times the size of the basis.\n
+ *              An eigenpair is converged when the norm of its residual is below the
+ *              relative tolerance.
+ */
+class ShiftInvertEigensolver
+{
+private:
+    /**
+     * @brief       The relative tolerance.
+     * 
+     * @details     The relative tolerance on the residuals of the eigenpairs.
+     */
+    double m_Tolerance;
+
+    /**
+     * @brief       Maximum number of restarts.
+     * 
+     * @details     The maximum number of restarts of the Lanczos process.
+     */
+    int m_MaxRestarts;
+
+    /**
+     * @brief       The solver for the shifted matrix.
+     * 
+     * @details     The direct solver holding the factorization of
+     *              <code>H - sigma * I</code>.
+     */
+    pwd::LinearSolver m_Solver;
+
+    /**
+     * @brief       The eigenvalues.
+     * 
+     * @details     The computed eigenvalues, sorted by increasing distance from the shift.
+     */
+    Eigen::VectorXd m_Evals;
+
+    /**
+     * @brief       The eigenvectors.
+     * 
+     * @details     The computed orthonormal eigenvectors, one per column.
+     */
+    Eigen::MatrixXd m_Evecs;
+
+    /**
+     * @brief       Number of iterations.
+     * 
+     * @details     The total number of Lanczos iterations of the last call to Compute().
+     */
+    int m_NumIterations;
+
+    /**
+     * @brief       Convergence flag.
+     * 
+     * @details     This value tells if all the requested eigenpairs converged in the
+     *              last call to Compute().
+     */
+    bool m_Converged;
+
+public:
+    /**
+     * @brief       Create a shift-invert eigensolver.
+     * 
+     * @details     This constructor creates an eigensolver with the given tolerance and
+     *              maximum number of restarts.\n
+     *              The tolerance and the number of restarts must be positive, otherwise
+     *              the constructor throws a pwd::AssertFailException.
+     * 
+     * @param Tolerance     The relative tolerance.
+     * @param MaxRestarts   The maximum number of restarts.
+     * 
+     * @throws pwd::AssertFailException if <code>Tolerance <= 0</code> or
+     *                                  <code>MaxRestarts <= 0</code>.
+     */
+    ShiftInvertEigensolver(double Tolerance = 1e-8, int MaxRestarts = 100);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~ShiftInvertEigensolver();
+
+
+    /**
+     * @brief       Returns the relative tolerance.
+     * 
+     * @return double the relative tolerance.
+     */
+    double GetTolerance() const;
+
+    /**
+     * @brief       Set the relative tolerance.
+     * 
+     * @param Tolerance     The relative tolerance.
+     * 
+     * @throws pwd::AssertFailException if <code>Tolerance <= 0</code>.
+     */
+    void SetTolerance(double Tolerance);
+
+    /**
+     * @brief       Set the backend of the shifted solver.
+     * 
+     * @details     This method sets the direct solver used to factorize the shifted
+     *              matrix.
+     * 
+     * @param Backend   The backend of the shifted solver.
+     */
+    void SetBackend(pwd::SolverBackend Backend);
+
+
+    /**
+     * @brief       Compute the eigenpairs closest to a shift.
+     * 
+     * @details     This method computes the <code>NumModes</code> eigenpairs of the
+     *              symmetric matrix <code>H</code> with the eigenvalues closest to the
+     *              given shift, which must not be an eigenvalue.\n
+     *              If the matrix is not square or the number of eigenpairs is not
+     *              between 1 and the size of the matrix, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param H         A sparse symmetric matrix.
+     * @param NumModes  The number of eigenpairs.
+     * @param Shift     The shift.
+     * 
+     * @throws pwd::AssertFailException if the sizes are not consistent.
+     */
+    void Compute(const Eigen::SparseMatrix<double>& H, int NumModes, double Shift);
+
+    /**
+     * @brief       Returns the eigenvalues.
+     * 
+     * @return const Eigen::VectorXd& the eigenvalues, by increasing distance from the
+     *                                shift.
+     */
+    const Eigen::VectorXd& Eigenvalues() const;
+
+    /**
+     * @brief       Returns the eigenvectors.
+     * 
+     * @return const Eigen::MatrixXd& the orthonormal eigenvectors, one per column.
+     */
+    const Eigen::MatrixXd& Eigenvectors() const;
+
+    /**
+     * @brief       Returns the number of iterations.
+     * 
+     * @details     This method returns the total number of Lanczos iterations performed
+     *              by the last call to Compute().
+     * 
+     * @return int the number of iterations.
+     */
+    int NumIterations() const;
+
+    /**
+     * @brief       Tells if the eigenpairs converged.
+     * 
+     * @return true if all the eigenpairs converged within the tolerance.
+     * @return false if the maximum number of restarts has been reached.
+     */
+    bool Converged() const;
+};
+
+} // namespace pwd
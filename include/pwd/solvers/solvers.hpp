@@ -0,0 +1,27 @@
+/**
+ * @file        solvers.hpp
+ * 
+ * @brief       Solvers header.
+ * 
+ * @details     This file includes all the solvers headers.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+
+#include <pwd/solvers/treesolver.hpp>
+#include <pwd/solvers/paralleltreesolver.hpp>
+#include <pwd/solvers/batchedtreesolver.hpp>
+#include <pwd/solvers/linearsolver.hpp>
+#include <pwd/solvers/factorizationcache.hpp>
+#include <pwd/solvers/krylov.hpp>
+#include <pwd/solvers/adaptivebdf.hpp>
+#include <pwd/solvers/eigenupdate.hpp>
+#include <pwd/solvers/shiftinverteig.hpp>
+#include <pwd/solvers/treeoperator.hpp>
+#include <pwd/solvers/bdf.hpp>
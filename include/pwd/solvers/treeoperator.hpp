@@ -0,0 +1,214 @@
+/**
+ * @file        treeoperator.hpp
+ * 
+ * @brief       Declaration of a matrix-free operator for the water system of a tree.
+ * 
+ * @details     This file contains the declaration of a class that applies the system
+ *              matrix of the water diffusion model to a vector, walking a flattened
+ *              representation of the tree instead of a sparse matrix.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/graph/graph.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A matrix-free operator for the water system of a tree.
+ * 
+ * @details     The class pwd::TreeOperator computes the product <code>S * w</code>
+ *              between the system matrix of the water diffusion model and a vector,
+ *              without storing the matrix.\n
+ *              Each node stores its parent, the conductance of the edge to its parent,
+ *              its inverse volume and its loss. The flow of an edge is its conductance
+ *              times the difference of the pressures of its endpoints, and the pressure
+ *              of a node is its water over its volume. Hence the product is the sum of
+ *              the flows entering each node, minus its loss times its water.\n
+ *              All the data are contiguous arrays indexed by node, which are streamed
+ *              once per product: the flows from the parents are computed in a loop
+ *              without dependencies, and only the flows to the parents are scattered.
+ */
+class TreeOperator
+{
+private:
+    /**
+     * @brief       The parent of each node.
+     * 
+     * @details     The i-th element is the parent of node i, or i itself if the node is
+     *              a root.
+     */
+    std::vector<int> m_Parent;
+
+    /**
+     * @brief       The non-root nodes.
+     * 
+     * @details     The nodes that have a parent, in breadth-first order. Every node
+     *              appears before its children.
+     */
+    std::vector<int> m_Order;
+
+    /**
+     * @brief       The conductances.
+     * 
+     * @details     The i-th element is the conductance of the edge between node i and
+     *              its parent, or zero if the node is a root or the edge is dead.
+     */
+    Eigen::VectorXd m_Conductances;
+
+    /**
+     * @brief       The inverse volumes.
+     * 
+     * @details     The inverse of the volume of each node.
+     */
+    Eigen::VectorXd m_InvVolumes;
+
+    /**
+     * @brief       The losses.
+     * 
+     * @details     The loss rate of each node, multiplied by the node area.
+     */
+    Eigen::VectorXd m_Losses;
+
+    /**
+     * @brief       The coefficients of the flows.
+     * 
+     * @details     The flow from the parent of node i is
+     *              <code>m_ParentCoeffs[i] * w[parent(i)] - m_NodeCoeffs[i] * w[i]</code>,
+     *              that is the conductance divided by the volume of each endpoint.
+     */
+    Eigen::VectorXd m_ParentCoeffs;
+    Eigen::VectorXd m_NodeCoeffs;
+
+    /**
+     * @brief       Get the node below an edge.
+     * 
+     * @details     This method returns the endpoint of the given edge whose parent is
+     *              the other endpoint.\n
+     *              If the nodes are not adjacent, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param i     The first endpoint.
+     * @param j     The second endpoint.
+     * @return int the child endpoint.
+     * 
+     * @throws pwd::AssertFailException if the nodes are not adjacent.
+     */
+    int ChildOf(int i, int j) const;
+
+public:
+    /**
+     * @brief       Create an empty operator.
+     * 
+     * @details     This constructor creates an operator of size zero.
+     */
+    TreeOperator();
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~TreeOperator();
+
+
+    /**
+     * @brief       Compute the operator of a graph.
+     * 
+     * @details     This method flattens the given graph, visiting each connected
+     *              component breadth-first from its first node, and the root of the
+     *              graph before any other node. All the conductances are set to zero.\n
+     *              If the graph is null, the method throws a pwd::NullPointerException.
+     *              If the graph is not a forest or the sizes of the vectors are wrong, the
+     *              method throws a pwd::AssertFailException.
+     * 
+     * @param Graph     The graph.
+     * @param Volumes   The volume of each node.
+     * @param Losses    The loss of each node.
+     * 
+     * @throws pwd::NullPointerException if <code>Graph</code> is nullptr.
+     * @throws pwd::AssertFailException if the graph is not a forest or the sizes are
+     *                                  wrong.
+     */
+    void Compute(const pwd::Graph* Graph,
+                 const Eigen::VectorXd& Volumes,
+                 const Eigen::VectorXd& Losses);
+
+    /**
+     * @brief       Set the conductance of an edge.
+     * 
+     * @details     This method sets the conductance of the edge between nodes i and j. A
+     *              zero conductance makes the edge dead.\n
+     *              If the nodes are not adjacent, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param i             The first endpoint.
+     * @param j             The second endpoint.
+     * @param Conductance   The conductance of the edge.
+     * 
+     * @throws pwd::AssertFailException if the nodes are not adjacent.
+     */
+    void SetConductance(int i, int j, double Conductance);
+
+    /**
+     * @brief       Get the conductance of an edge.
+     * 
+     * @param i     The first endpoint.
+     * @param j     The second endpoint.
+     * @return double the conductance of the edge between nodes i and j.
+     * 
+     * @throws pwd::AssertFailException if the nodes are not adjacent.
+     */
+    double GetConductance(int i, int j) const;
+
+    /**
+     * @brief       Set the losses.
+     * 
+     * @param Losses    The loss of each node.
+     * 
+     * @throws pwd::AssertFailException if the size of <code>Losses</code> is wrong.
+     */
+    void SetLosses(const Eigen::VectorXd& Losses);
+
+    /**
+     * @brief       Returns the size of the operator.
+     * 
+     * @return int the number of nodes.
+     */
+    int Size() const;
+
+    /**
+     * @brief       Returns the parents.
+     * 
+     * @return const std::vector<int>& the parent of each node, or the node itself if
+     *                                 it is a root.
+     */
+    const std::vector<int>& Parents() const;
+
+
+    /**
+     * @brief       Apply the operator.
+     * 
+     * @details     This method computes <code>Out = S * In</code>. The input and the
+     *              output must not overlap.\n
+     *              If the sizes are wrong, the method throws a pwd::AssertFailException.
+     * 
+     * @param In    The input vector.
+     * @param Out   The output vector.
+     * 
+     * @throws pwd::AssertFailException if the sizes are wrong or the vectors overlap.
+     */
+    void Apply(const Eigen::Ref<const Eigen::VectorXd>& In,
+               Eigen::Ref<Eigen::VectorXd> Out) const;
+};
+
+} // namespace pwd
@@ -0,0 +1,398 @@
+/**
+ * @file        treesolver.hpp
+ * 
+ * @brief       Declaration of a direct solver for tree-structured linear systems.
+ * 
+ * @details     This file contains the declaration of a class that solves sparse linear
+ *              systems whose sparsity pattern is the adjacency pattern of a tree (or a
+ *              forest), like the systems arising from a pwd::Graph.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A direct solver for linear systems with a tree sparsity pattern.
+ * 
+ * @details     The class pwd::TreeSolver factorizes and solves a square sparse linear
+ *              system whose off-diagonal sparsity pattern is symmetric and forms a tree
+ *              or a forest.\n
+ *              The elimination proceeds from the leaves to the roots, so eliminating a
+ *              node only modifies the pivot of its parent and no fill-in is ever
+ *              produced. Both the factorization and the solution take O(n) time and
+ *              memory.\n
+ *              No pivoting is performed, hence the solver is meant for matrices that
+ *              can be safely eliminated in any order, like diagonally dominant matrices.
+ */
+class TreeSolver
+{
+private:
+    /**
+     * @brief       Size of the system.
+     * 
+     * @details     The number of rows (and columns) of the analyzed matrix.
+     */
+    int m_N;
+
+    /**
+     * @brief       Number of non-zero entries of the analyzed matrix.
+     * 
+     * @details     This value is used to detect changes in the sparsity pattern between
+     *              the analysis and the factorization.
+     */
+    int m_NNZ;
+
+    /**
+     * @brief       The elimination order.
+     * 
+     * @details     This vector contains the nodes of the tree in elimination order.
+     *              Every node appears before its parent.
+     */
+    std::vector<int> m_Order;
+
+    /**
+     * @brief       The parent of each node in elimination order.
+     * 
+     * @details     The k-th element is the parent of the node <code>m_Order[k]</code>,
+     *              or -1 if the node is a root.
+     */
+    std::vector<int> m_Parent;
+
+    /**
+     * @brief       Positions of the diagonal entries.
+     * 
+     * @details     The k-th element is the index, inside the value array of the
+     *              analyzed matrix, of the diagonal entry of node <code>m_Order[k]</code>.
+     */
+    std::vector<int> m_DiagIdx;
+
+    /**
+     * @brief       Positions of the entries coupling a node to its parent.
+     * 
+     * @details     The k-th element is the index, inside the value array of the
+     *              analyzed matrix, of the entry <code>A(i, parent(i))</code>, where
+     *              <code>i = m_Order[k]</code>.
+     */
+    std::vector<int> m_UpperIdx;
+
+    /**
+     * @brief       Positions of the entries coupling a parent to its node.
+     * 
+     * @details     The k-th element is the index, inside the value array of the
+     *              analyzed matrix, of the entry <code>A(parent(i), i)</code>, where
+     *              <code>i = m_Order[k]</code>.
+     */
+    std::vector<int> m_LowerIdx;
+
+    /**
+     * @brief       Position of each node.
+     * 
+     * @details     The i-th element is the position of node i in the elimination order.
+     */
+    std::vector<int> m_Position;
+
+    /**
+     * @brief       Offsets of the children lists.
+     * 
+     * @details     The children of the node at position k are stored in
+     *              <code>m_Children[m_ChildBeg[k]]</code> to
+     *              <code>m_Children[m_ChildBeg[k + 1] - 1]</code>.
+     */
+    std::vector<int> m_ChildBeg;
+
+    /**
+     * @brief       The children of each node.
+     * 
+     * @details     The positions of the children of each node, in elimination order.
+     */
+    std::vector<int> m_Children;
+
+    /**
+     * @brief       Inverse of the pivots.
+     * 
+     * @details     The inverse of the pivot of each node, in elimination order.
+     */
+    Eigen::VectorXd m_InvPivots;
+
+    /**
+     * @brief       Elimination multipliers.
+     * 
+     * @details     The multiplier <code>A(parent(i), i) / pivot(i)</code> of each node,
+     *              in elimination order.
+     */
+    Eigen::VectorXd m_Lower;
+
+    /**
+     * @brief       Upper factor.
+     * 
+     * @details     The entry <code>A(i, parent(i))</code> of each node, in elimination
+     *              order.
+     */
+    Eigen::VectorXd m_Upper;
+
+    /**
+     * @brief       Support vector.
+     * 
+     * @details     Node-indexed support vector used to accumulate the pivots during
+     *              the factorization.
+     */
+    Eigen::VectorXd m_Pivots;
+
+    /**
+     * @brief       Pattern analyzed.
+     * 
+     * @details     This value tells if the sparsity pattern has been analyzed.
+     */
+    bool m_Analyzed;
+
+    /**
+     * @brief       Matrix factorized.
+     * 
+     * @details     This value tells if the numerical factorization has been computed.
+     */
+    bool m_Factorized;
+
+public:
+    /**
+     * @brief       Create an empty solver.
+     * 
+     * @details     This constructor creates a solver with no analyzed pattern.
+     */
+    TreeSolver();
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~TreeSolver();
+
+
+    /**
+     * @brief       Analyze the sparsity pattern of a matrix.
+     * 
+     * @details     This method computes the elimination order of the given matrix from
+     *              its sparsity pattern.\n
+     *              Every node must have an explicit diagonal entry and the off-diagonal
+     *              pattern must be symmetric and form a forest. Otherwise, the method
+     *              throws a pwd::AssertFailException.
+     * 
+     * @param A     A square sparse matrix with a tree sparsity pattern.
+     * 
+     * @throws pwd::AssertFailException if the pattern of <code>A</code> is not a forest.
+     */
+    void AnalyzePattern(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Compute the numerical factorization of a matrix.
+     * 
+     * @details     This method computes the numerical factorization of the given matrix,
+     *              which must have the same sparsity pattern of the last analyzed one.\n
+     *              If no pattern has been analyzed, the pattern differs, or a zero pivot
+     *              is found, the method throws a pwd::AssertFailException.
+     * 
+     * @param A     A square sparse matrix with the analyzed sparsity pattern.
+     * 
+     * @throws pwd::AssertFailException if the pattern is not the analyzed one or the
+     *                                  matrix is singular.
+     */
+    void Factorize(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Analyze and factorize a matrix.
+     * 
+     * @details     This method is equivalent to calling AnalyzePattern() and Factorize().
+     * 
+     * @param A     A square sparse matrix with a tree sparsity pattern.
+     */
+    void Compute(const Eigen::SparseMatrix<double>& A);
+
+    /**
+     * @brief       Update the factorization after a local change.
+     * 
+     * @details     This method updates the numerical factorization after a change of the
+     *              entries <code>A(i, j)</code> where both <code>i</code> and
+     *              <code>j</code> are in <code>Nodes</code>. Only the pivots on the paths
+     *              from the given nodes to their roots are computed again, and the result
+     *              is the same of a full factorization.\n
+     *              If the matrix is not factorized or a zero pivot is found, the method
+     *              throws a pwd::AssertFailException.
+     * 
+     * @param A     The changed matrix, with the analyzed sparsity pattern.
+     * @param Nodes The nodes whose entries changed.
+     * 
+     * @throws pwd::AssertFailException if the matrix is not factorized or singular.
+     */
+    void Refactorize(const Eigen::SparseMatrix<double>& A, const std::vector<int>& Nodes);
+
+    /**
+     * @brief       Save the numerical factorization.
+     * 
+     * @details     This method writes the inverse pivots and the off-diagonal factors,
+     *              so that LoadFactorization() can restore them without eliminating the
+     *              matrix again. The analysis of the pattern is not stored.\n
+     *              If the matrix is not factorized, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Writer    The binary writer.
+     * 
+     * @throws pwd::AssertFailException if the matrix is not factorized.
+     */
+    void SaveFactorization(pwd::BinaryWriter& Writer) const;
+
+    /**
+     * @brief       Load the numerical factorization.
+     * 
+     * @details     This method reads the factorization written by SaveFactorization()
+     *              for the analyzed pattern.\n
+     *              If no pattern has been analyzed or the factorization does not match
+     *              its size, the method throws a pwd::AssertFailException.
+     * 
+     * @param Reader    The binary reader.
+     * 
+     * @throws pwd::AssertFailException if the factorization is not valid.
+     */
+    void LoadFactorization(pwd::BinaryReader& Reader);
+
+
+    /**
+     * @brief       Returns the size of the system.
+     * 
+     * @details     This method returns the number of unknowns of the analyzed system.
+     * 
+     * @return int the size of the system.
+     */
+    int Size() const;
+
+    /**
+     * @brief       Tells if the pattern has been analyzed.
+     * 
+     * @return true if a sparsity pattern has been analyzed.
+     * @return false otherwise.
+     */
+    bool IsAnalyzed() const;
+
+    /**
+     * @brief       Tells if the matrix has been factorized.
+     * 
+     * @return true if a numerical factorization is available.
+     * @return false otherwise.
+     */
+    bool IsFactorized() const;
+
+    /**
+     * @brief       Returns the elimination order.
+     * 
+     * @details     This method returns the nodes of the analyzed pattern in elimination
+     *              order, where every node appears before its parent.
+     * 
+     * @return const std::vector<int>& the elimination order.
+     */
+    const std::vector<int>& EliminationOrder() const;
+
+    /**
+     * @brief       Returns the parents in elimination order.
+     * 
+     * @details     This method returns, for each position of the elimination order, the
+     *              parent of the node at that position, or -1 if the node is a root.
+     * 
+     * @return const std::vector<int>& the parents in elimination order.
+     */
+    const std::vector<int>& Parents() const;
+
+    /**
+     * @brief       Returns the positions of the diagonal entries.
+     * 
+     * @details     This method returns, for each position of the elimination order, the
+     *              index of the diagonal entry of the node inside the value array of
+     *              the analyzed matrix.
+     * 
+     * @return const std::vector<int>& the positions of the diagonal entries.
+     */
+    const std::vector<int>& DiagonalIndices() const;
+
+    /**
+     * @brief       Returns the positions of the upper entries.
+     * 
+     * @details     This method returns, for each position of the elimination order, the
+     *              index of the entry <code>A(i, parent(i))</code> inside the value
+     *              array of the analyzed matrix, or -1 if the node is a root.
+     * 
+     * @return const std::vector<int>& the positions of the upper entries.
+     */
+    const std::vector<int>& UpperIndices() const;
+
+    /**
+     * @brief       Returns the positions of the lower entries.
+     * 
+     * @details     This method returns, for each position of the elimination order, the
+     *              index of the entry <code>A(parent(i), i)</code> inside the value
+     *              array of the analyzed matrix, or -1 if the node is a root.
+     * 
+     * @return const std::vector<int>& the positions of the lower entries.
+     */
+    const std::vector<int>& LowerIndices() const;
+
+
+    /**
+     * @brief       Solve the linear system.
+     * 
+     * @details     This method solves the factorized linear system with the given
+     *              right-hand side.\n
+     *              If no factorization is available or the size of the right-hand side
+     *              is wrong, the method throws a pwd::AssertFailException.
+     * 
+     * @param b     The right-hand side.
+     * @return Eigen::VectorXd the solution of the system.
+     * 
+     * @throws pwd::AssertFailException if the system is not factorized or the size of
+     *                                  <code>b</code> is wrong.
+     */
+    Eigen::VectorXd Solve(const Eigen::VectorXd& b) const;
+
+    /**
+     * @brief       Solve the linear system in place.
+     * 
+     * @details     This method overwrites the given right-hand side with the solution
+     *              of the factorized system, without allocating any memory.\n
+     *              If no factorization is available or the size of the right-hand side
+     *              is wrong, the method throws a pwd::AssertFailException.
+     * 
+     * @param x     The right-hand side, overwritten with the solution.
+     * 
+     * @throws pwd::AssertFailException if the system is not factorized or the size of
+     *                                  <code>x</code> is wrong.
+     */
+    void SolveInPlace(Eigen::Ref<Eigen::VectorXd> x) const;
+};
+
+
+/**
+ * @brief       Returns the position of an entry inside the value array of a matrix.
+ * 
+ * @details     This function searches the entry <code>A(i, j)</code> in the compressed
+ *              column <code>j</code> of the given matrix, in logarithmic time.\n
+ *              If the entry is not in the sparsity pattern, the function throws a
+ *              pwd::AssertFailException.
+ * 
+ * @param A     A compressed sparse matrix.
+ * @param i     The row of the entry.
+ * @param j     The column of the entry.
+ * @return int the index of the entry inside <code>A.valuePtr()</code>.
+ * 
+ * @throws pwd::AssertFailException if <code>A(i, j)</code> is not in the pattern.
+ */
+int EntryIndex(const Eigen::SparseMatrix<double>& A, int i, int j);
+
+} // namespace pwd
@@ -0,0 +1,205 @@
+/**
+ * @file        sourceprofile.hpp
+ * 
+ * @brief       Declaration of a time profile of water inflows.
+ * 
+ * @details     This file contains the declaration of a class that describes the water
+ *              entering each node over time, such as root uptake or irrigation, as a
+ *              piecewise-constant or piecewise-linear function.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       The interpolation of a source profile.
+ * 
+ * @details     The shape of the inflow between two consecutive knots of a
+ *              pwd::SourceProfile.
+ */
+enum class Interpolation
+{
+    /**
+     * @brief       The inflow of each knot holds until the next knot.
+     */
+    Constant,
+
+    /**
+     * @brief       The inflow changes linearly between consecutive knots.
+     */
+    Linear
+};
+
+
+/**
+ * @brief       A time profile of water inflows.
+ * 
+ * @details     The class pwd::SourceProfile defines the inflow of each node at any time
+ *              point from its values at a sorted list of knots. The piece k of the
+ *              profile goes from the k-th knot to the next one, and the inflow on it is
+ *              either the one of the k-th knot, or the linear interpolation of the two
+ *              knots.\n
+ *              Before the first knot the inflow is zero, and after the last knot it is
+ *              the one of the last knot.
+ */
+class SourceProfile
+{
+private:
+    /**
+     * @brief       The interpolation.
+     * 
+     * @details     The shape of the inflow between consecutive knots.
+     */
+    pwd::Interpolation m_Interp;
+
+    /**
+     * @brief       The times of the knots.
+     * 
+     * @details     The time points of the knots, in ascending order.
+     */
+    std::vector<double> m_Times;
+
+    /**
+     * @brief       The inflows of the knots.
+     * 
+     * @details     The k-th column is the inflow of each node at the k-th knot.
+     */
+    Eigen::MatrixXd m_Values;
+
+public:
+    /**
+     * @brief       Create an empty profile.
+     * 
+     * @details     This constructor creates a profile with no knots, that is with zero
+     *              inflow, and the given interpolation.
+     * 
+     * @param Interp    The interpolation between the knots.
+     */
+    SourceProfile(pwd::Interpolation Interp = pwd::Interpolation::Constant);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~SourceProfile();
+
+
+    /**
+     * @brief       Add a knot.
+     * 
+     * @details     This method appends a knot to the profile.\n
+     *              If the time does not follow the one of the last knot, or the size of
+     *              the inflow differs from the one of the other knots, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Time      The time point of the knot.
+     * @param Inflow    The inflow of each node at the knot.
+     * 
+     * @throws pwd::AssertFailException if the time is not sorted or the size of
+     *                                  <code>Inflow</code> is wrong.
+     */
+    void AddKnot(double Time, const Eigen::VectorXd& Inflow);
+
+    /**
+     * @brief       Returns the interpolation.
+     * 
+     * @return pwd::Interpolation the interpolation between the knots.
+     */
+    pwd::Interpolation GetInterpolation() const;
+
+    /**
+     * @brief       Returns the number of knots.
+     * 
+     * @return int the number of knots.
+     */
+    int NumKnots() const;
+
+    /**
+     * @brief       Returns the number of nodes.
+     * 
+     * @return int the size of the inflows, or zero if the profile has no knots.
+     */
+    int Size() const;
+
+    /**
+     * @brief       Returns the time of a knot.
+     * 
+     * @param k     The index of the knot.
+     * @return double the time point of the k-th knot.
+     * 
+     * @throws pwd::AssertFailException if <code>k</code> is out of range.
+     */
+    double Time(int k) const;
+
+    /**
+     * @brief       Returns the inflows of the knots.
+     * 
+     * @return const Eigen::MatrixXd& the matrix with the inflow at the k-th knot in the
+     *                                k-th column.
+     */
+    const Eigen::MatrixXd& Values() const;
+
+
+    /**
+     * @brief       Evaluate the inflow.
+     * 
+     * @details     This method writes the inflow of each node at the given time point.\n
+     *              If the size of <code>Out</code> is wrong, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Time  The time point.
+     * @param Out   The inflow of each node.
+     * 
+     * @throws pwd::AssertFailException if the size of <code>Out</code> is wrong.
+     */
+    void Inflow(double Time, Eigen::Ref<Eigen::VectorXd> Out) const;
+
+    /**
+     * @brief       Evaluate the inflow of a node.
+     * 
+     * @param Time  The time point.
+     * @param i     The ID of the node.
+     * @return double the inflow of node i at the given time point.
+     * 
+     * @throws pwd::AssertFailException if <code>i</code> is out of range.
+     */
+    double Inflow(double Time, int i) const;
+
+
+    /**
+     * @brief       Save the profile.
+     * 
+     * @details     This method writes the interpolation and the knots of the profile.
+     * 
+     * @param Writer    The binary writer.
+     */
+    void Save(pwd::BinaryWriter& Writer) const;
+
+    /**
+     * @brief       Load the profile.
+     * 
+     * @details     This method replaces the knots with the ones written by Save().
+
+     *              If the knots are not valid, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Reader    The binary reader.
+     * 
+     * @throws pwd::AssertFailException if the knots are not valid.
+     */
+    void Load(pwd::BinaryReader& Reader);
+};
+
+} // namespace pwd
@@ -0,0 +1,288 @@
+/**
+ * @file        sweep.hpp
+ * 
+ * @brief       Declaration of a parallel parameter sweep.
+ * 
+ * @details     This file contains the declaration of a class that simulates many
+ *              scenarios of the water diffusion model on the same plant, distributing
+ *              them over a pwd::ThreadPool.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <pwd/utils/utils.hpp>
+#include <pwd/graph/graph.hpp>
+#include <pwd/watermodel.hpp>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A scenario of a parameter sweep.
+ * 
+ * @details     The parameters of a single water diffusion model.
+ */
+struct Scenario
+{
+    /**
+     * @brief       The loss rate of each node.
+     */
+    Eigen::VectorXd LossRates;
+
+    /**
+     * @brief       The total amount of initial water.
+     */
+    double InitialWater;
+
+    /**
+     * @brief       The list of dead edges.
+     */
+    std::vector<std::pair<int, int>> DeadEdges;
+};
+
+/**
+ * @brief       This class implements a parallel parameter sweep.
+ * 
+ * @details     The class pwd::Sweep evaluates a list of scenarios of the water diffusion
+ *              model on the same graph, at the same time points.\n
+ *              Each scenario is simulated by its own pwd::WaterModel, and the scenarios
+ *              are distributed over the workers of a pwd::ThreadPool. The results are
+ *              written in a buffer provided by the caller, so that no memory is
+ *              allocated for the results during the sweep.\n
+ *              The buffer holds NumScenarios() x NumTimes() water vectors, one after
+ *              the other. The water of scenario <code>s</code> at the t-th time point
+ *              starts at offset <code>(s * NumTimes() + t) * NumNodes</code>.
+ */
+class Sweep
+{
+private:
+    /**
+     * @brief       A constant pointer to the graph.
+     * 
+     * @details     The graph shared by all the scenarios.
+     */
+    const pwd::Graph* m_Graph;
+
+    /**
+     * @brief       The scenarios.
+     * 
+     * @details     The list of scenarios to simulate.
+     */
+    std::vector<pwd::Scenario> m_Scenarios;
+
+    /**
+     * @brief       The time points.
+     * 
+     * @details     The sorted time points at which each scenario is evaluated.
+     */
+    std::vector<double> m_Times;
+
+    /**
+     * @brief       The evaluation mode.
+     * 
+     * @details     The strategy used to evaluate the models of the scenarios.
+     */
+    pwd::EvaluationMode m_Mode;
+
+    /**
+     * @brief       The solver backend.
+     * 
+     * @details     The direct solver used by the models of the scenarios.
+     */
+    pwd::SolverBackend m_Backend;
+
+public:
+    /**
+     * @brief       Create an empty sweep.
+     * 
+     * @details     This constructor creates a sweep with no scenarios and no time
+     *              points on the given graph.\n
+     *              If the input graph is null, the constructor throws a
+     *              pwd::NullPointerException.
+     * 
+     * @param Graph     The graph shared by the scenarios.
+     * 
+     * @throws pwd::NullPointerException if <code>Graph</code> is nullptr.
+     */
+    Sweep(const pwd::Graph* Graph);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~Sweep();
+
+
+    /**
+     * @brief       Add a scenario.
+     * 
+     * @details     This method adds a scenario with custom loss rates.
+     * 
+     * @param LossRates     The vector of loss rates.
+     * @param InitialWater  The total amount of initial water.
+     * @param DeadEdges     The list of dead edges.
+     * 
+     * @throws pwd::AssertFailException if the size of <code>LossRates</code> is wrong.
+     */
+    void AddScenario(const Eigen::VectorXd& LossRates,
+                     double InitialWater,
+                     const std::vector<std::pair<int, int>>& DeadEdges);
+
+    /**
+     * @brief       Add a scenario.
+     * 
+     * @details     This method adds a scenario with the given loss rate on the leaves.
+     * 
+     * @param LossRate      The loss rate at the leaves.
+     * @param InitialWater  The total amount of initial water.
+     * @param DeadEdges     The list of dead edges.
+     */
+    void AddScenario(double LossRate,
+                     double InitialWater,
+                     const std::vector<std::pair<int, int>>& DeadEdges = { });
+
+    /**
+     * @brief       Add a grid of scenarios.
+     * 
+     * @details     This method adds a scenario for each combination of a loss rate on the
+     *              leaves, an amount of initial water and a set of dead edges.
+     * 
+     * @param LossRates     The loss rates at the leaves.
+     * @param InitialWaters The amounts of initial water.
+     * @param DeadEdges     The sets of dead edges.
+     */
+    void AddGrid(const std::vector<double>& LossRates,
+                 const std::vector<double>& InitialWaters,
+                 const std::vector<std::vector<std::pair<int, int>>>& DeadEdges = { { } });
+
+    /**
+     * @brief       Remove all the scenarios.
+     */
+    void ClearScenarios();
+
+    /**
+     * @brief       Returns the number of scenarios.
+     * 
+     * @return int the number of scenarios.
+     */
+    int NumScenarios() const;
+
+    /**
+     * @brief       Returns a scenario.
+     * 
+     * @param s     The index of the scenario.
+     * @return const pwd::Scenario& the s-th scenario.
+     */
+    const pwd::Scenario& GetScenario(int s) const;
+
+
+    /**
+     * @brief       Set the time points.
+     * 
+     * @details     This method sets the time points at which each scenario is evaluated.\n
+     *              The time points must be non-negative and sorted in ascending order,
+     *              otherwise the method throws a pwd::AssertFailException.
+     * 
+     * @param Times     The time points.
+     * 
+     * @throws pwd::AssertFailException if the time points are negative or not sorted.
+     */
+    void SetTimes(const std::vector<double>& Times);
+
+    /**
+     * @brief       Returns the number of time points.
+     * 
+     * @return int the number of time points.
+     */
+    int NumTimes() const;
+
+    /**
+     * @brief       Returns the time points.
+     * 
+     * @return const std::vector<double>& the time points.
+     */
+    const std::vector<double>& Times() const;
+
+
+    /**
+     * @brief       Set the evaluation mode.
+     * 
+     * @details     This method sets the strategy used to evaluate the models of the
+     *              scenarios. The default is pwd::EvaluationMode::Stepping.
+     * 
+     * @param Mode  The evaluation mode.
+     */
+    void SetEvaluationMode(pwd::EvaluationMode Mode);
+
+    /**
+     * @brief       Returns the evaluation mode.
+     * 
+     * @return pwd::EvaluationMode the evaluation mode.
+     */
+    pwd::EvaluationMode GetEvaluationMode() const;
+
+    /**
+     * @brief       Set the solver backend.
+     * 
+     * @details     This method sets the direct solver used by the models of the
+     *              scenarios. The default is pwd::SolverBackend::SparseLU.
+     * 
+     * @param Backend   The solver backend.
+     */
+    void SetSolverBackend(pwd::SolverBackend Backend);
+
+    /**
+     * @brief       Returns the solver backend.
+     * 
+     * @return pwd::SolverBackend the solver backend.
+     */
+    pwd::SolverBackend GetSolverBackend() const;
+
+
+    /**
+     * @brief       Returns the size of the results.
+     * 
+     * @return size_t the number of values written by Run().
+     */
+    size_t ResultSize() const;
+
+    /**
+     * @brief       Run the sweep.
+     * 
+     * @details     This method simulates all the scenarios on the workers of the given
+     *              pool, and writes the results in the given buffer, which must hold at
+     *              least ResultSize() values.
+     * 
+     * @param Pool      The thread pool.
+     * @param Results   The buffer of the results.
+     * 
+     * @throws pwd::NullPointerException if <code>Results</code> is nullptr.
+     */
+    void Run(pwd::ThreadPool& Pool, double* Results) const;
+
+    /**
+     * @brief       Run the sweep.
+     * 
+     * @details     This method simulates all the scenarios on the workers of the given
+     *              pool, and writes the results in the columns of the given matrix.
+     *              The matrix must have one row per node and
+     *              <code>NumScenarios() * NumTimes()</code> columns.
+     * 
+     * @param Pool      The thread pool.
+     * @param Results   The matrix of the results.
+     * 
+     * @throws pwd::AssertFailException if the size of <code>Results</code> is wrong.
+     */
+    void Run(pwd::ThreadPool& Pool, Eigen::Ref<Eigen::MatrixXd> Results) const;
+};
+
+} // namespace pwd
@@ -0,0 +1,317 @@
+/**
+ * @file        binaryio.hpp
+ * 
+ * @brief       Declaration of helpers for compact binary files.
+ * 
+ * @details     This file contains the declaration of a writer and a reader of binary
+ *              buffers made of scalars and raw arrays of doubles. The arrays are
+ *              aligned inside the buffer, so that a buffer mapped in memory can be read
+ *              in place.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <cstdint>
+#include <type_traits>
+
+
+/**
+ * @brief       Alignment of the arrays inside a binary buffer.
+ */
+#define PWD_BINARY_ALIGNMENT    64
+
+/**
+ * @brief       Initial value of the FNV-1a hash.
+ */
+#define PWD_HASH_SEED           0xCBF29CE484222325ULL
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A writer of binary buffers.
+ * 
+ * @details     The class pwd::BinaryWriter appends scalars and arrays of doubles to a
+ *              buffer in memory, which can then be written to a file.\n
+ *              Each array is preceded by its sizes and starts at an offset that is a
+ *              multiple of PWD_BINARY_ALIGNMENT bytes. Values are written in the byte
+ *              order of the machine.
+ */
+class BinaryWriter
+{
+private:
+    /**
+     * @brief       The buffer.
+     * 
+     * @details     The bytes written so far.
+     */
+    std::vector<char> m_Buffer;
+
+    /**
+     * @brief       Write raw bytes.
+     * 
+     * @param Data      The bytes.
+     * @param Size      The number of bytes.
+     */
+    void WriteBytes(const void* Data, size_t Size);
+
+public:
+    /**
+     * @brief       Create an empty writer.
+     * 
+     * @details     This constructor creates a writer with an empty buffer.
+     */
+    BinaryWriter();
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~BinaryWriter();
+
+
+    /**
+     * @brief       Write a scalar.
+     * 
+     * @details     This method appends the bytes of the given value to the buffer.
+     * 
+     * @tparam T        A trivially copyable type.
+     * @param Value     The value.
+     */
+    template<typename T>
+    void Write(const T& Value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only raw values can be written.");
+        WriteBytes(&Value, sizeof(T));
+    }
+
+    /**
+     * @brief       Write an aligned array of doubles.
+     * 
+     * @details     This method appends the number of rows and columns of the array,
+     *              pads the buffer to the alignment, and appends the values in
+     *              column-major order.
+     * 
+     * @param Data      The values.
+     * @param Rows      The number of rows.
+     * @param Cols      The number of columns.
+     */
+    void WriteArray(const double* Data, int64_t Rows, int64_t Cols);
+
+    /**
+     * @brief       Write a vector.
+     * 
+     * @param v     The vector.
+     */
+    void WriteVector(const Eigen::VectorXd& v);
+
+    /**
+     * @brief       Write a matrix.
+     * 
+     * @param M     The matrix.
+     */
+    void WriteMatrix(const Eigen::MatrixXd& M);
+
+
+    /**
+     * @brief       Returns the size of the buffer.
+     * 
+     * @return size_t the number of bytes written so far.
+     */
+    size_t Size() const;
+
+    /**
+     * @brief       Returns the buffer.
+     * 
+     * @return const char* the bytes written so far.
+     */
+    const char* Data() const;
+
+    /**
+     * @brief       Write the buffer to a file.
+     * 
+     * @details     This method writes the buffer to the given file, replacing its
+     *              content.\n
+     *              If the file cannot be written, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Filename  The path of the file.
+     * 
+     * @throws pwd::AssertFailException if the file cannot be written.
+     */
+    void Save(const std::string& Filename) const;
+};
+
+
+/**
+ * @brief       A reader of binary buffers.
+ * 
+ * @details     The class pwd::BinaryReader reads back, in the same order, the values
+ *              written by a pwd::BinaryWriter.\n
+ *              The reader can either own a copy of a file, or read a buffer owned by
+ *              the caller, like a file mapped in memory. Arrays are never copied: they
+ *              are returned as maps into the buffer, which must outlive them.\n
+ *              Reading past the end of the buffer throws a pwd::AssertFailException.
+ */
+class BinaryReader
+{
+private:
+    /**
+     * @brief       The owned buffer.
+     * 
+     * @details     The content of the file, when the reader has been created from a
+     *              file. The buffer is made of doubles, so that it is aligned at least
+     *              as much as a double.
+     */
+    std::vector<double> m_Owned;
+
+    /**
+     * @brief       The buffer.
+     * 
+     * @details     A pointer to the first byte of the buffer.
+     */
+    const char* m_Data;
+
+    /**
+     * @brief       The size of the buffer.
+     * 
+     * @details     The size of the buffer, in bytes.
+     */
+    size_t m_Size;
+
+    /**
+     * @brief       The read offset.
+     * 
+     * @details     The offset of the next byte to read.
+     */
+    size_t m_Offset;
+
+    /**
+     * @brief       Read raw bytes.
+     * 
+     * @param Data      The destination of the bytes.
+     * @param Size      The number of bytes.
+     */
+    void ReadBytes(void* Data, size_t Size);
+
+    /**
+     * @brief       Read the header of an array and skip to its values.
+     * 
+     * @param Rows      The number of rows.
+     * @param Cols      The number of columns.
+     * @return const double* the values of the array.
+     */
+    const double* ReadArray(int64_t& Rows, int64_t& Cols);
+
+public:
+    /**
+     * @brief       Create a reader of a file.
+     * 
+     * @details     This constructor reads the whole content of the given file.\n
+     *              If the file cannot be read, the constructor throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Filename  The path of the file.
+     * 
+     * @throws pwd::AssertFailException if the file cannot be read.
+     */
+    BinaryReader(const std::string& Filename);
+
+    /**
+     * @brief       Create a reader of a buffer.
+     * 
+     * @details     This constructor creates a reader of a buffer owned by the caller,
+     *              which is not copied.\n
+     *              If the buffer is null, the constructor throws a
+     *              pwd::NullPointerException.
+     * 
+     * @param Data      The buffer.
+     * @param Size      The size of the buffer, in bytes.
+     * 
+     * @throws pwd::NullPointerException if <code>Data</code> is nullptr.
+     */
+    BinaryReader(const void* Data, size_t Size);
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~BinaryReader();
+
+
+    /**
+     * @brief       Read a scalar.
+     * 
+     * @tparam T    A trivially copyable type.
+     * @return T the value.
+     * 
+     * @throws pwd::AssertFailException if the buffer is over.
+     */
+    template<typename T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only raw values can be read.");
+        T Value;
+        ReadBytes(&Value, sizeof(T));
+        return Value;
+    }
+
+    /**
+     * @brief       Read a vector.
+     * 
+     * @return Eigen::Map<const Eigen::VectorXd> a map of the vector into the buffer.
+     * 
+     * @throws pwd::AssertFailException if the buffer is over or the array is not a
+     *                                  vector.
+     */
+    Eigen::Map<const Eigen::VectorXd> ReadVector();
+
+    /**
+     * @brief       Read a matrix.
+     * 
+     * @return Eigen::Map<const Eigen::MatrixXd> a map of the matrix into the buffer.
+     * 
+     * @throws pwd::AssertFailException if the buffer is over.
+     */
+    Eigen::Map<const Eigen::MatrixXd> ReadMatrix();
+
+    /**
+     * @brief       Returns the read offset.
+     * 
+     * @return size_t the offset of the next byte to read.
+     */
+    size_t Offset() const;
+
+    /**
+     * @brief       Returns the size of the buffer.
+     * 
+     * @return size_t the size of the buffer, in bytes.
+     */
+    size_t Size() const;
+};
+
+
+/**
+ * @brief       Hash a sequence of bytes.
+ * 
+ * @details     This function computes the 64-bit FNV-1a hash of the given bytes,
+ *              starting from the given hash. Hence, the hash of a sequence of buffers
+ *              is computed by chaining the calls.
+ * 
+ * @param Data      The bytes.
+ * @param Size      The number of bytes.
+ * @param Hash      The hash of the previous bytes.
+ * @return uint64_t the hash of the bytes.
+ */
+uint64_t HashBytes(const void* Data, size_t Size, uint64_t Hash = PWD_HASH_SEED);
+
+} // namespace pwd
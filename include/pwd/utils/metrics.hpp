@@ -0,0 +1,226 @@
+/**
+ * @file        metrics.hpp
+ * 
+ * @brief       Declaration of the performance counters of the library.
+ * 
+ * @details     This file contains the declaration of the counters and the timers of the
+ *              phases of the simulations, such as the factorizations of the linear
+ *              systems and the evaluations of the models.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <chrono>
+#include <ostream>
+
+
+namespace pwd
+{
+
+/**
+ * @brief       The measured phases.
+ * 
+ * @details     This enumeration lists the phases of the library measured by the
+ *              performance counters. The phases can be nested, for instance the
+ *              evaluations include the solves of the time stepping.
+ */
+enum class Phase
+{
+    /**
+     * @brief   Loading a graph from file.
+     */
+    GraphLoad,
+
+    /**
+     * @brief   Assembling the system of a model, in the initialization.
+     */
+    Assembly,
+
+    /**
+     * @brief   Analyzing the pattern of a linear system.
+     */
+    SymbolicFactorization,
+
+    /**
+     * @brief   Factorizing the values of a linear system.
+     */
+    NumericFactorization,
+
+    /**
+     * @brief   Solving a factorized linear system.
+     */
+    Solve,
+
+    /**
+     * @brief   Computing the eigendecomposition of a model.
+     */
+    Eigendecomposition,
+
+    /**
+     * @brief   Evaluating a model at given time points.
+     */
+    Evaluate
+};
+
+/**
+ * @brief       The number of phases.
+ */
+constexpr int NumPhases = 7;
+
+/**
+ * @brief       The counters of a phase.
+ * 
+ * @details     The number of times a phase has been executed and the time spent in it,
+ *              measured with a monotonic clock.
+ */
+struct PhaseMetrics
+{
+    /**
+     * @brief       The number of executions of the phase.
+     */
+    size_t Count;
+
+    /**
+     * @brief       The total time spent in the phase, in milliseconds.
+     */
+    double TotalTime;
+
+    /**
+     * @brief       The longest execution of the phase, in milliseconds.
+     */
+    double MaxTime;
+};
+
+
+/**
+ * @brief       Enable or disable the counters.
+ * 
+ * @details     This function turns the measures of all the phases on or off. The
+ *              counters are disabled by default, and while disabled each phase only
+ *              costs the check of this flag.
+ * 
+ * @param Enabled   true to measure the phases, false otherwise.
+ */
+void EnableMetrics(bool Enabled);
+
+/**
+ * @brief       Tells if the counters are enabled.
+ * 
+ * @return true if the phases are measured.
+ * @return false otherwise.
+ */
+bool MetricsEnabled();
+
+/**
+ * @brief       Record an execution of a phase.
+ * 
+ * @details     This function adds an execution of the given duration to the counters of
+ *              the phase. It can be called concurrently by many threads.
+ * 
+ * @param Phase     The phase.
+ * @param Time      The duration of the execution.
+ */
+void RecordPhase(pwd::Phase Phase, std::chrono::nanoseconds Time);
+
+/**
+ * @brief       Returns the counters of a phase.
+ * 
+ * @param Phase     The phase.
+ * @return pwd::PhaseMetrics the counters of the phase since the last reset.
+ */
+pwd::PhaseMetrics GetMetrics(pwd::Phase Phase);
+
+/**
+ * @brief       Reset the counters.
+ * 
+ * @details     This function sets the counters of all the phases to zero. The executions
+ *              running on other threads are recorded after the reset.
+ */
+void ResetMetrics();
+
+/**
+ * @brief       Returns the name of a phase.
+ * 
+ * @param Phase     The phase.
+ * @return const char* the name of the phase.
+ */
+const char* PhaseName(pwd::Phase Phase);
+
+/**
+ * @brief       Print the counters.
+ * 
+ * @details     This function prints a table with the counters of the phases executed at
+ *              least once since the last reset.
+ * 
+ * @param Stream    The output stream.
+ */
+void PrintMetrics(std::ostream& Stream);
+
+
+/**
+ * @brief       A timer of a phase.
+ * 
+ * @details     The class pwd::PhaseTimer measures the execution of a phase from its
+ *              construction to its destruction, and records it with RecordPhase(). If
+ *              the counters are disabled when the timer is created, the clock is not
+ *              read at all.
+ */
+class PhaseTimer
+{
+private:
+    /**
+     * @brief       The phase.
+     * 
+     * @details     The phase measured by the timer.
+     */
+    pwd::Phase m_Phase;
+
+    /**
+     * @brief       Enabled status.
+     * 
+     * @details     Tells if the counters were enabled when the timer was created.
+     */
+    bool m_Enabled;
+
+    /**
+     * @brief       The start time.
+     * 
+     * @details     The time the timer was created at, if enabled.
+     */
+    std::chrono::steady_clock::time_point m_Start;
+
+public:
+    /**
+     * @brief       Start measuring a phase.
+     * 
+     * @param Phase     The phase.
+     */
+    PhaseTimer(pwd::Phase Phase)
+        : m_Phase(Phase), m_Enabled(pwd::MetricsEnabled())
+    {
+        if (m_Enabled)
+            m_Start = std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief       Stop measuring the phase.
+     * 
+     * @details     This destructor records the execution of the phase.
+     */
+    ~PhaseTimer()
+    {
+        if (m_Enabled)
+            pwd::RecordPhase(m_Phase, std::chrono::steady_clock::now() - m_Start);
+    }
+
+    PhaseTimer(const pwd::PhaseTimer&) = delete;
+    pwd::PhaseTimer& operator=(const pwd::PhaseTimer&) = delete;
+};
+
+} // namespace pwd
@@ -0,0 +1,294 @@
+/**
+ * @file        threadpool.hpp
+ * 
+ * @brief       Declaration of a work-stealing thread pool.
+ * 
+ * @details     This file contains the declaration of a pool of worker threads that
+ *              execute tasks, balancing the load by stealing tasks from each other.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+
+namespace pwd
+{
+
+/**
+ * @brief       A work-stealing thread pool.
+ * 
+ * @details     The class pwd::ThreadPool owns a fixed set of worker threads, each one
+ *              with its own queue of tasks. Submitted tasks are distributed among the
+ *              queues in a round-robin fashion, or pushed on the queue of the submitting
+ *              worker. A worker executes the tasks of its own queue in last-in first-out
+ *              order and, when its queue is empty, steals the oldest task from the queue
+ *              of another worker. Hence, tasks of uneven duration keep all the workers
+ *              busy.\n
+ *              The loops of ParallelFor() are not queued as tasks: idle workers join
+ *              the most recent loop and claim its iterations, without allocating.\n
+ *              If a task throws an exception, the first one is rethrown by Wait().
+ */
+class ThreadPool
+{
+private:
+    /**
+     * @brief       A queue of tasks.
+     * 
+     * @details     The tasks of a worker, protected by their own mutex.
+     */
+    struct WorkQueue
+    {
+        std::mutex Mutex;
+        std::deque<std::function<void()>> Tasks;
+    };
+
+    /**
+     * @brief       A parallel loop.
+     * 
+     * @details     The state of a loop run by ParallelFor(), which lives on the stack of
+     *              its caller. The iterations are claimed from a shared counter by the
+     *              caller and by the workers that join the loop, so no task is queued.
+     *              The fields other than the counter are protected by the mutex of the
+     *              pool.
+     */
+    struct ParallelLoop
+    {
+        const std::function<void(int)>* Body;
+        std::atomic<int> Next;
+        int End;
+        int NumHelpers;
+        bool Listed;
+        std::exception_ptr Error;
+        ParallelLoop* NextLoop;
+    };
+
+    /**
+     * @brief       The worker threads.
+     * 
+     * @details     The threads executing the tasks.
+     */
+    std::vector<std::thread> m_Workers;
+
+    /**
+     * @brief       The queues of the workers.
+     * 
+     * @details     One queue of tasks for each worker thread.
+     */
+    std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+
+    /**
+     * @brief       The mutex of the pool.
+     * 
+     * @details     The mutex protecting the state of the pool shared by all the workers.
+     */
+    std::mutex m_Mutex;
+
+    /**
+     * @brief       Work available.
+     * 
+     * @details     The condition variable signaled when new tasks are submitted or the
+     *              pool is stopped.
+     */
+    std::condition_variable m_WorkCV;
+
+    /**
+     * @brief       Work completed.
+     * 
+     * @details     The condition variable signaled when all the tasks are completed, or
+     *              when the last worker leaves a parallel loop.
+     */
+    std::condition_variable m_DoneCV;
+
+    /**
+     * @brief       Number of queued tasks.
+     * 
+     * @details     The number of tasks waiting in the queues.
+     */
+    std::atomic<int> m_NumQueued;
+
+    /**
+     * @brief       Number of pending tasks.
+     * 
+     * @details     The number of submitted tasks that are not completed yet.
+     */
+    int m_NumPending;
+
+    /**
+     * @brief       The next queue.
+     * 
+     * @details     The queue receiving the next task submitted from outside the pool.
+     */
+    std::atomic<unsigned int> m_NextQueue;
+
+    /**
+     * @brief       Stop flag.
+     * 
+     * @details     This value tells the workers to terminate once the queues are empty.
+     */
+    bool m_Stop;
+
+    /**
+     * @brief       The first error.
+     * 
+     * @details     The first exception thrown by a task since the last call to Wait().
+     */
+    std::exception_ptr m_Error;
+
+    /**
+     * @brief       The parallel loops.
+     * 
+     * @details     The list of the loops with iterations left to claim, from the most
+     *              recent one.
+     */
+    ParallelLoop* m_Loops;
+
+
+    /**
+     * @brief       The main loop of a worker.
+     * 
+     * @param Worker    The index of the worker.
+     */
+    void WorkerLoop(int Worker);
+
+    /**
+     * @brief       Take a task for a worker.
+     * 
+     * @details     This method takes the newest task of the given worker queue or, if it
+     *              is empty, steals the oldest task from another queue.
+     * 
+     * @param Worker    The index of the worker.
+     * @param Task      The task taken.
+     * @return true if a task has been taken.
+     * @return false if all the queues are empty.
+     */
+    bool TakeTask(int Worker, std::function<void()>& Task);
+
+    /**
+     * @brief       Execute a task.
+     * 
+     * @details     This method executes the task, records its exception, if any, and
+     *              marks the task as completed.
+     * 
+     * @param Task  The task to execute.
+     */
+    void RunTask(std::function<void()>& Task);
+
+    /**
+     * @brief       Execute the iterations of a loop.
+     * 
+     * @details     This method claims and executes the iterations of the loop until
+     *              none is left, recording the first exception, and then removes the
+     *              loop from the list of the pool.
+     * 
+     * @param Loop  The loop.
+     */
+    void RunLoop(ParallelLoop& Loop);
+
+    /**
+     * @brief       Remove a loop from the list.
+     * 
+     * @details     This method removes the loop from the list of the pool, if it is still
+     *              there. The caller must hold the mutex of the pool.
+     * 
+     * @param Loop  The loop.
+     */
+    void UnlistLoop(ParallelLoop& Loop);
+
+    /**
+     * @brief       Index of the calling worker.
+     * 
+     * @return int the index of the calling thread among the workers of this pool, or -1
+     *             if the caller is not a worker of this pool.
+     */
+    int CurrentWorker() const;
+
+public:
+    /**
+     * @brief       Create a thread pool.
+     * 
+     * @details     This constructor starts the given number of worker threads. If the
+     *              number is not positive, one worker for each hardware thread is
+     *              started.
+     * 
+     * @param NumThreads    The number of worker threads.
+     */
+    ThreadPool(int NumThreads = 0);
+
+    /**
+     * @brief       Destroy the thread pool.
+     * 
+     * @details     The destructor waits for all the submitted tasks and joins the
+     *              worker threads.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const pwd::ThreadPool&) = delete;
+    pwd::ThreadPool& operator=(const pwd::ThreadPool&) = delete;
+
+
+    /**
+     * @brief       Returns the number of worker threads.
+     * 
+     * @return int the number of worker threads.
+     */
+    int NumThreads() const;
+
+    /**
+     * @brief       Submit a task.
+     * 
+     * @details     This method queues a task for the execution on a worker thread.
+     * 
+     * @param Task  The task to execute.
+     */
+    void Submit(std::function<void()> Task);
+
+    /**
+     * @brief       Wait for the submitted tasks.
+     * 
+     * @details     This method blocks until all the submitted tasks are completed.\n
+     *              If any task threw an exception, the first one is rethrown. The method
+     *              cannot be called from a worker of this pool, otherwise it throws a
+     *              pwd::AssertFailException.
+     * 
+     * @throws pwd::AssertFailException if called from a worker of this pool.
+     */
+    void Wait();
+
+    /**
+     * @brief       Execute a loop in parallel.
+     * 
+     * @details     This method calls <code>Body(i)</code> for each <code>i</code> in
+     *              <code>[Begin, End)</code>, distributing the iterations over the
+     *              workers and the calling thread, and waits for their completion. The
+     *              iterations are claimed from a counter on the stack of the caller,
+     *              hence the loop does not allocate.\n
+     *              The method only waits for the iterations of this loop, so many threads
+     *              can run their own loops on the same pool at the same time. If any
+     *              iteration threw an exception, the first one is rethrown to the caller
+     *              of the loop.\n
+     *              When called from a worker of this pool, for instance by a task running
+     *              a model with a parallel backend, the iterations are executed in order
+     *              on the calling worker.
+     * 
+     * @param Begin     The first index of the loop.
+     * @param End       The index after the last one.
+     * @param Body      The body of the loop.
+     */
+    void ParallelFor(int Begin, int End, const std::function<void(int)>& Body);
+};
+
+} // namespace pwd
@@ -0,0 +1,159 @@
+/**
+ * @file        triplebuffer.hpp
+ * 
+ * @brief       Definition of a lock-free triple buffer.
+ * 
+ * @details     This file contains the definition of a data structure passing the
+ *              latest value produced by a thread to another thread, without locks and
+ *              without blocking any of the two.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/common/common.hpp>
+#include <atomic>
+
+
+namespace pwd
+{
+
+
+/**
+ * @brief       A lock-free triple buffer.
+ * 
+ * @details     This class holds three copies of a value: one owned by the writer, one
+ *              owned by the reader and one shared between the two. The writer fills its
+ *              copy and publishes it by swapping it with the shared one, and the reader
+ *              takes the last published copy by swapping its own with the shared one.\n
+ *              The swaps are single atomic operations, so neither thread ever waits for
+ *              the other. The reader always sees a complete value, skipping the ones
+ *              published while it was busy.\n
+ *              The class supports exactly one writer thread and one reader thread.
+ * 
+ * @tparam T    Any copyable type.
+ */
+template<typename T>
+class TripleBuffer
+{
+private:
+    /**
+     * @brief       Flag of the shared index.
+     * 
+     * @details     The bit set in the shared index when its copy has been published and
+     *              not read yet.
+     */
+    static constexpr int FRESH = 4;
+
+    /**
+     * @brief       The copies of the value.
+     * 
+     * @details     The three copies of the value.
+     */
+    T m_Slots[3];
+
+    /**
+     * @brief       The shared copy.
+     * 
+     * @details     The index of the shared copy, together with the FRESH flag.
+     */
+    std::atomic<int> m_Shared;
+
+    /**
+     * @brief       The copy of the writer.
+     * 
+     * @details     The index of the copy owned by the writer.
+     */
+    int m_Write;
+
+    /**
+     * @brief       The copy of the reader.
+     * 
+     * @details     The index of the copy owned by the reader.
+     */
+    int m_Read;
+
+public:
+    /**
+     * @brief       Create a triple buffer.
+     * 
+     * @details     This constructor creates a triple buffer with the three copies
+     *              initialized with the given value, which the reader sees until the
+     *              first publication.
+     * 
+     * @param Value     The initial value.
+     */
+    TripleBuffer(const T& Value = T())
+        : m_Shared(1), m_Write(0), m_Read(2)
+    {
+        for (int i = 0; i < 3; ++i)
+            m_Slots[i] = Value;
+    }
+
+    /**
+     * @brief       Default destructor.
+     * 
+     * @details     Default destructor.
+     */
+    ~TripleBuffer() {}
+
+
+    /**
+     * @brief       Returns the copy of the writer.
+     * 
+     * @details     This method returns the copy owned by the writer, which the writer
+     *              can modify freely until it calls Publish().\n
+     *              The copy holds the value published two publications before, so its
+     *              memory can be reused.
+     * 
+     * @return T& the copy of the writer.
+     */
+    T& WriteBuffer() { return m_Slots[m_Write]; }
+
+    /**
+     * @brief       Publish the copy of the writer.
+     * 
+     * @details     This method makes the copy of the writer the latest value, and gives
+     *              the writer the shared copy to fill next.\n
+     *              This method must be called by the writer thread only.
+     */
+    void Publish()
+    {
+        m_Write = m_Shared.exchange(m_Write | FRESH, std::memory_order_acq_rel) & ~FRESH;
+    }
+
+
+    /**
+     * @brief       Take the latest value.
+     * 
+     * @details     This method gives the reader the latest published value, if it has not
+     *              been taken yet.\n
+     *              This method must be called by the reader thread only.
+     * 
+     * @return true if a new value has been taken.
+     * @return false if the reader already has the latest value.
+     */
+    bool Update()
+    {
+        if ((m_Shared.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+        m_Read = m_Shared.exchange(m_Read, std::memory_order_acq_rel) & ~FRESH;
+        return true;
+    }
+
+    /**
+     * @brief       Returns the copy of the reader.
+     * 
+     * @details     This method returns the value taken by the last call to Update().
+     * 
+     * @return const T& the copy of the reader.
+     */
+    const T& ReadBuffer() const { return m_Slots[m_Read]; }
+};
+
+
+} // namespace pwd
@@ -15,4 +15,8 @@
 
 
 #include <pwd/utils/stack.hpp>
-#include <pwd/utils/queue.hpp>
\ No newline at end of file
+#include <pwd/utils/queue.hpp>
+#include <pwd/utils/threadpool.hpp>
+#include <pwd/utils/triplebuffer.hpp>
+#include <pwd/utils/binaryio.hpp>
+#include <pwd/utils/metrics.hpp>
\ No newline at end of file
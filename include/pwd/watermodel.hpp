@@ -12,15 +12,50 @@
  * 
  * @date        2023-01-28
  */
+#pragma once
+
 #include <pwd/common/common.hpp>
 #include <pwd/utils/utils.hpp>
 #include <pwd/graph/graph.hpp>
+#include <pwd/solvers/solvers.hpp>
+#include <pwd/solvers/bdf.hpp>
+#include <pwd/lossschedule.hpp>
+#include <pwd/sourceprofile.hpp>
 
 
 
 
 namespace pwd
 {
+
+/**
+ * @brief       Evaluation modes of the water model.
+ * 
+ * @details     This enumeration lists the strategies used by pwd::WaterModel to
+ *              evaluate the model at a given time point.
+ */
+enum class EvaluationMode
+{
+    /**
+     * @brief       Implicit time stepping with the BDF6 scheme.
+     */
+    Stepping,
+
+    /**
+     * @brief       Closed form solution from the dense spectral decomposition.
+     */
+    Spectral,
+
+    /**
+     * @brief       Action of the matrix exponential computed in a Krylov space.
+     */
+    Krylov,
+
+    /**
+     * @brief       Adaptive variable-step, variable-order BDF integration.
+     */
+    Adaptive
+};
     
 /**
  * @brief       This class implements the water diffusion model.
@@ -28,7 +63,18 @@ namespace pwd
  * @details     The class pwd::WaterModel implements the water diffusion model inside a
  *              plant.\n 
  *              The class also offers an interface for regulating the input parameters
- *              to the model.
+ *              to the model.\n 
+ *              Each model owns all the state of its solvers, and the graph is only read.
+ *              Hence, distinct models can be initialized, built and evaluated
+ *              concurrently from different threads, even when they share the same
+ *              graph. A single model is not synchronized: calling a non-const method
+ *              while another thread is using the same model is a data race.\n 
+ *              The IDs of the nodes taken and returned by the model, as the indices of
+ *              its vectors of water, loss rates and inflows, are the IDs of the input
+ *              file. If the graph has been reordered with pwd::Graph::Reorder(), the
+ *              model stores its state in the order of the graph and translates the IDs
+ *              with pwd::Graph::InputID() and pwd::Graph::NodeID(). Only the system
+ *              matrix, its products and its eigenvectors follow the order of the graph.
  */
 class WaterModel
 {
@@ -58,6 +104,33 @@ private:
      */
     Eigen::VectorXd m_Water;
 
+    /**
+     * @brief       The input IDs of the nodes.
+     * 
+     * @details     The i-th element is the ID in the input file of the node with ID i in
+     *              the graph, as when the model was initialized. The vector is empty if
+     *              the graph is in input order.
+     */
+    std::vector<int> m_InputIDs;
+
+    /**
+     * @brief       The IDs of the input nodes.
+     * 
+     * @details     The i-th element is the ID in the graph of the node with ID i in the
+     *              input file. The vector is empty if the graph is in input order.
+     */
+    std::vector<int> m_NodeIDs;
+
+    /**
+     * @brief       The water in input order.
+     * 
+     * @details     The initial water and the last evaluated water with the IDs of the
+     *              input file, returned by Water0() and Water(). They are only used if
+     *              the graph has been reordered.
+     */
+    Eigen::VectorXd m_InputWater0;
+    Eigen::VectorXd m_InputWater;
+
     /**
      * @brief       Inverse of eigenvectors times the water.
      * 
@@ -65,14 +138,44 @@ private:
      *              multiplied by the initial water amount.\n 
      *              Used to speed up the computation.
      */
-    Eigen::VectorXcd m_Xi;
+    Eigen::VectorXd m_Xi;
 
     /**
      * @brief       Support vector.
      * 
      * @details     This is a support vector for intermediate operations.
      */
-    Eigen::VectorXcd m_Xi2;
+    Eigen::VectorXd m_Xi2;
+
+    /**
+     * @brief       Square root of the node volumes.
+     * 
+     * @details     The system matrix is similar to a symmetric matrix through the
+     *              diagonal scaling given by the square root of the node volumes.
+     */
+    Eigen::VectorXd m_SqrtVolumes;
+
+    /**
+     * @brief       The node volumes.
+     * 
+     * @details     The volume of each node of the graph.
+     */
+    Eigen::VectorXd m_Volumes;
+
+    /**
+     * @brief       The node water flow resistances.
+     * 
+     * @details     The water flow resistance of each node. The flow through an edge is
+     *              regulated by the average resistance of its endpoints.
+     */
+    Eigen::VectorXd m_FlowRes;
+
+    /**
+     * @brief       The node losses.
+     * 
+     * @details     The loss rate of each node, multiplied by the node area.
+     */
+    Eigen::VectorXd m_Losses;
 
     /**
      * @brief       System matrix.
@@ -81,30 +184,49 @@ private:
      */
     Eigen::SparseMatrix<double> m_S;
 
-    Eigen::SparseMatrix<double> m_Eye;
+    /**
+     * @brief       Matrix-free system operator.
+     * 
+     * @details     The operator computing the products with the system matrix from the
+     *              flattened tree, kept consistent with <code>m_S</code>.
+     */
+    pwd::TreeOperator m_Operator;
+
+    /**
+     * @brief       Diagonal of the system matrix.
+     * 
+     * @details     The position of each diagonal entry of <code>m_S</code> inside its
+     *              value array. <code>m_StepMatrix</code> has the same pattern.
+     */
+    std::vector<int> m_DiagIdx;
     Eigen::VectorXd m_RK[4];
     Eigen::Matrix<double, Eigen::Dynamic, 6> m_Spt;
 
     /**
-     * @brief       The eigenvectors of the system matrix.
+     * @brief       Oldest entry of the history.
      * 
-     * @details     The eigenvectors of the system matrix.
+     * @details     The column of the oldest step inside the history of the time
+     *              stepping, which is a circular buffer.
      */
-    Eigen::MatrixXcd m_Evecs;
+    int m_SptHead;
 
     /**
-     * @brief       The inverse of the eigenvectors of the system matrix.
+     * @brief       The eigenvectors of the system matrix.
      * 
-     * @details     The inverse of the eigenvectors of the system matrix.
+     * @details     The eigenvectors of the system matrix.\n 
+     *              Since the system matrix is similar to a symmetric matrix, the
+     *              eigenvectors are real.
      */
-    Eigen::MatrixXcd m_InvEvecs;
+    Eigen::MatrixXd m_Evecs;
 
     /**
      * @brief       The eigenvalues of the system matrix.
      * 
-     * @details     The eigenvalues of the system matrix.
+     * @details     The eigenvalues of the system matrix.\n 
+     *              Since the system matrix is similar to a symmetric matrix, the
+     *              eigenvalues are real.
      */
-    Eigen::VectorXcd m_Evals;
+    Eigen::VectorXd m_Evals;
 
     /**
      * @brief       Last evaluated time point.
@@ -114,14 +236,535 @@ private:
     double m_LastTime;
 
     /**
-     * @brief       Spectral decomposition computed during the building process.
+     * @brief       The evaluation mode.
      * 
-     * @details     This boolean value determines if the spectral decomposition of the
-     *              system matrix has been computed during the building process.
+     * @details     The strategy used to evaluate the model, determined by the last
+     *              building process.
      */
-    bool m_Spectral;
+    pwd::EvaluationMode m_Mode;
 
-    
+    /**
+     * @brief       Symmetrized system matrix.
+     * 
+     * @details     The sparse matrix <code>V^(-1/2) * S * V^(1/2)</code>, used by the
+     *              Krylov evaluation mode.
+     */
+    Eigen::SparseMatrix<double> m_SymS;
+
+    /**
+     * @brief       The Krylov solver.
+     * 
+     * @details     The solver computing the action of the exponential of the symmetrized
+     *              system matrix in the Krylov evaluation mode.
+     */
+    pwd::KrylovExponential m_Krylov;
+
+    /**
+     * @brief       Work vectors of the Krylov solver.
+     * 
+     * @details     The symmetrized water before and after the propagation in the
+     *              Krylov evaluation mode.
+     */
+    Eigen::VectorXd m_KrylovIn;
+    Eigen::VectorXd m_KrylovOut;
+
+    /**
+     * @brief       The adaptive integrator.
+     * 
+     * @details     The variable-step, variable-order BDF integrator used in the adaptive
+     *              evaluation mode.
+     */
+    pwd::AdaptiveBDF m_Adaptive;
+
+    /**
+     * @brief       Backend of the time stepping solver.
+     * 
+     * @details     The direct solver used to factorize the implicit system of the
+     *              time stepping scheme.
+     */
+    pwd::SolverBackend m_Backend;
+
+    /**
+     * @brief       The solvers of the time stepping scheme.
+     * 
+     * @details     The direct solvers holding the factorizations of the implicit system
+     *              of the time stepping scheme for the last used time steps. The cache
+     *              also holds the analysis of the pattern, shared with the solvers of
+     *              the segments.
+     */
+    pwd::FactorizationCache m_Solvers;
+
+    /**
+     * @brief       The thread pool of the time stepping solver.
+     * 
+     * @details     The pool used by the pwd::SolverBackend::ParallelTree backend, not
+     *              owned by the model.
+     */
+    pwd::ThreadPool* m_Pool;
+
+    /**
+     * @brief       The factorized time step.
+     * 
+     * @details     The time step for which the implicit system has been factorized.
+     *              A change of time step restarts the history of the scheme.
+     */
+    double m_DT;
+
+    /**
+     * @brief       The stepping clock.
+     * 
+     * @details     The step of the internal clock of the time stepping, zero if each
+     *              evaluation takes a single step. The clock steps on the time points
+     *              <code>m_ClockStart + k * m_ClockStep</code>, and
+     *              <code>m_ClockWater</code> is the water after the last of them, the
+     *              <code>m_ClockSteps</code>-th one.
+     */
+    double m_ClockStep;
+    double m_ClockStart;
+    int64_t m_ClockSteps;
+    Eigen::VectorXd m_ClockWater;
+
+    /**
+     * @brief       The right-hand side of the time step.
+     * 
+     * @details     The work vector in which each BDF step is solved.
+     */
+    Eigen::VectorXd m_StepRhs;
+
+    /**
+     * @brief       The coefficients of a trajectory.
+     * 
+     * @details     The work matrix holding the coefficients of the water in the
+     *              eigenbasis at each time point of EvaluateMany().
+     */
+    Eigen::MatrixXd m_ModeCoeffs;
+
+    /**
+     * @brief       The permuted trajectory.
+     * 
+     * @details     The work matrix receiving the rows of EvaluateMany() in the input
+     *              order, reused across the calls.
+     */
+    Eigen::MatrixXd m_Permuted;
+
+    /**
+     * @brief       The implicit system of the time stepping scheme.
+     * 
+     * @details     The matrix factorized by the time stepping solver, with the same
+     *              pattern of <code>m_S</code>.
+     */
+    Eigen::SparseMatrix<double> m_StepMatrix;
+
+    /**
+     * @brief       The loss rate schedule.
+     * 
+     * @details     The schedule followed by the time stepping, the time point at which
+     *              it started, and the losses of its segments, that is the loss rates
+     *              multiplied by the node areas.
+     */
+    pwd::LossSchedule m_Schedule;
+    double m_ScheduleStart;
+    std::vector<Eigen::VectorXd> m_SegmentLosses;
+
+    /**
+     * @brief       The active segment.
+     * 
+     * @details     The segment of the schedule whose losses are in the system matrix, or
+     *              -1 if the model follows no schedule.
+     */
+    int m_Segment;
+
+    /**
+     * @brief       The losses without a schedule.
+     * 
+     * @details     The losses of the model before the schedule started, restored when
+     *              the schedule is cleared.
+     */
+    Eigen::VectorXd m_BaseLosses;
+
+    /**
+     * @brief       The solvers of the segments.
+     * 
+     * @details     The factorization of the implicit system of the time stepping for
+     *              each segment of the schedule. Each one is computed the first time its
+     *              segment is active, and reused on all the following periods until the
+     *              time step changes.
+     */
+    std::vector<std::unique_ptr<pwd::LinearSolver>> m_SegmentSolvers;
+
+    /**
+     * @brief       The inflows.
+     * 
+     * @details     The profile of the water entering each node over time.
+     */
+    pwd::SourceProfile m_Sources;
+
+    /**
+     * @brief       The inflows in input order.
+     * 
+     * @details     The profile given to SetSources(), returned by GetSources(). It is
+     *              only used if the graph has been reordered.
+     */
+    pwd::SourceProfile m_InputSources;
+
+    /**
+     * @brief       The spectral coefficients of the inflows.
+     * 
+     * @details     The k-th column holds the coefficients in the eigenbasis of the
+     *              inflow at the k-th knot of the profile.
+     */
+    Eigen::MatrixXd m_SourceCoeffs;
+
+    /**
+     * @brief       The inflow of a time step.
+     * 
+     * @details     The work vector holding the inflow at the end of each BDF step.
+     */
+    Eigen::VectorXd m_Inflow;
+
+    /**
+     * @brief       The starting water.
+     * 
+     * @details     The water from which the evaluation restarts when going back in time.
+     *              This is the initial water, or the water at the last change of the
+     *              dead edges.
+     */
+    Eigen::VectorXd m_StartWater;
+
+    /**
+     * @brief       The starting time.
+     * 
+     * @details     The time point of the starting water. The model cannot be evaluated
+     *              before this time point.
+     */
+    double m_StartTime;
+
+    /**
+     * @brief       The time of the switch to the spectral formula.
+     * 
+     * @details     When only the slowest modes are computed, the water is stepped before
+     *              this time point, where the other modes have not decayed yet.
+     */
+    double m_SpectralTime;
+
+    /**
+     * @brief       The tolerance of the truncated spectral mode.
+     * 
+     * @details     The relative tolerance on the eigenpairs and on the neglected part
+     *              of the water.
+     */
+    double m_SpectralTol;
+
+    /**
+     * @brief       The directory of the spectral cache.
+     * 
+     * @details     The directory where Build() stores and looks for the
+     *              eigendecompositions. An empty path disables the cache.
+     */
+    std::string m_CacheDir;
+
+
+    /**
+     * @brief       Advance the water by time stepping.
+     * 
+     * @details     This method advances the water from the last evaluated time to the
+     *              given one with BDF steps.
+     * 
+     * @param Time      The evaluation time.
+     */
+    void Step(double Time);
+
+    /**
+     * @brief       Advance the time stepping.
+     * 
+     * @details     This method evaluates the model at the given time point by time
+     *              stepping. Without a clock, it calls Step(). Otherwise, the clock
+     *              steps until it reaches the time point, and the water is interpolated
+     *              from the last steps.
+     * 
+     * @param Time      The evaluation time.
+     */
+    void Advance(double Time);
+
+    /**
+     * @brief       Evaluates the model at given time.
+     * 
+     * @details     This method implements Evaluate() on the water in the order of the
+     *              graph, without updating the water in input order.
+     * 
+     * @param Time      The evaluation time.
+     */
+    void Propagate(double Time);
+
+    /**
+     * @brief       Computes the wilting time of each node.
+     * 
+     * @details     This method implements WiltingTimes() in the order of the graph.
+     * 
+     * @param Fraction  The fraction of the initial water at which a node wilts.
+     * @param MaxTime   The end of the time interval.
+     * @param TimeStep  The maximum step of the search.
+     * @param Times     The wilting time of each node, in the order of the graph.
+     */
+    void FindWiltingTimes(double Fraction,
+                          double MaxTime,
+                          double TimeStep,
+                          Eigen::Ref<Eigen::VectorXd> Times);
+
+    /**
+     * @brief       Returns the ID of an input node.
+     * 
+     * @details     This method returns the ID in the graph of the node with the given
+     *              ID in the input file.\n 
+     *              If no node has the given ID, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param InputID   The ID of a node in the input file.
+     * @return int the ID of the node in the graph.
+     * 
+     * @throws pwd::AssertFailException if no node has the given ID.
+     */
+    int NodeID(int InputID) const;
+
+    /**
+     * @brief       Update the water in input order.
+     * 
+     * @details     This method copies the last evaluated water in input order, if the
+     *              graph has been reordered.
+     */
+    void UpdateInputWater();
+
+    /**
+     * @brief       Restart the stepping clock.
+     * 
+     * @details     This method moves the clock to the last evaluated time point and
+     *              water. The history of the steps starts again.
+     */
+    void ResetClock();
+
+    /**
+     * @brief       Replace the losses.
+     * 
+     * @details     This method patches the diagonal of the system matrix and the
+     *              matrix-free operator with the given losses, without touching the
+     *              factorizations.
+     * 
+     * @param Losses    The loss of each node.
+     */
+    void SetLosses(const Eigen::VectorXd& Losses);
+
+    /**
+     * @brief       Update the implicit system of the time step.
+     * 
+     * @details     This method writes <code>I - Alpha * dt * S</code> into the values of
+     *              <code>m_StepMatrix</code>, without changing its pattern.
+     * 
+     * @param DT        The time step.
+     */
+    void UpdateStepMatrix(double DT);
+
+    /**
+     * @brief       Factorize the implicit system of the time step.
+     * 
+     * @details     This method factorizes <code>m_StepMatrix</code> with the given
+     *              solver, giving it the analysis of the pattern held by
+     *              <code>m_Solvers</code> only if the solver never had one. The pattern
+     *              does not depend on the time step or on the losses.
+     * 
+     * @param Solver    The solver of the time step.
+     * @param DT        The time step.
+     */
+    void FactorizeStep(pwd::LinearSolver& Solver, double DT);
+
+    /**
+     * @brief       Compute the slowest modes.
+     * 
+     * @details     This method computes the given number of eigenpairs of the system
+     *              with the eigenvalues closest to zero.
+     * 
+     * @param NumModes  The number of modes.
+     */
+    void ComputeSlowModes(int NumModes);
+
+    /**
+     * @brief       Refine the slowest modes.
+     * 
+     * @details     This method recomputes the modes whose eigenvalues are below the
+     *              rounding errors of the fastest one, with the Rayleigh-Ritz method on
+     *              their subspace. The energy of the modes is written as sums of squares
+     *              over the edges, which are not affected by the fast modes.
+     */
+    void RefineSlowModes();
+
+    /**
+     * @brief       Project the starting water on the modes.
+     * 
+     * @details     This method computes the coefficients of the starting water in the
+     *              eigenbasis and, if the basis is truncated, the time from which the
+     *              neglected modes are below the tolerance.
+     */
+    void ProjectSpectral();
+
+    /**
+     * @brief       Project the inflows on the eigenbasis.
+     * 
+     * @details     This method computes the spectral coefficients of the inflow at each
+     *              knot of the profile.
+     */
+    void ProjectSources();
+
+    /**
+     * @brief       Add the response to the inflows.
+     * 
+     * @details     This method adds to the given spectral coefficients the convolution
+     *              of each mode with the inflows, from the starting time to the given
+     *              time point. On each piece of the profile, the integral of
+     *              <code>exp((t - s) * L) * b(s)</code> has a closed form.
+     * 
+     * @param Time      The evaluation time.
+     * @param Coeffs    The spectral coefficients.
+     */
+    void AddSourceModes(double Time, Eigen::Ref<Eigen::VectorXd> Coeffs) const;
+
+    /**
+     * @brief       Update the matrix-free system operator.
+     * 
+     * @details     This method copies the losses and the conductances of the alive edges
+     *              into the system operator.
+     */
+    void UpdateOperator();
+
+    /**
+     * @brief       Returns the key of the cached decomposition.
+     * 
+     * @details     This method returns a hash of the system matrix and of the node
+     *              volumes, which define the eigendecomposition of the current system.
+     * 
+     * @return uint64_t the key of the cached decomposition.
+     */
+    uint64_t SpectralCacheKey() const;
+
+    /**
+     * @brief       Returns the path of the cached decomposition.
+     * 
+     * @details     This method returns the path of the file of the spectral cache
+     *              holding the eigendecomposition of the current system. The name of
+     *              the file is the key of the decomposition.
+     * 
+     * @return std::string the path of the cached decomposition.
+     */
+    std::string SpectralCachePath() const;
+
+    /**
+     * @brief       Load the decomposition from the cache.
+     * 
+     * @details     This method loads the eigendecomposition of the current system from
+     *              the cache. An entry is accepted only if it stores the same key, the
+     *              same values of the system matrix and the same node volumes, so that
+     *              a hash collision or a renamed file is a miss. An entry that cannot be
+     *              read, like a truncated file, or whose decomposition does not match
+     *              its checksum is a miss as well.
+     * 
+     * @return true if the decomposition has been found in the cache.
+     * @return false if the cache is disabled, or the decomposition is not in the cache.
+     */
+    bool LoadSpectralCache();
+
+    /**
+     * @brief       Store the decomposition in the cache.
+     * 
+     * @details     This method writes the eigendecomposition in the cache, if the cache
+     *              is enabled. A failure to write the entry is ignored.
+     */
+    void SaveSpectralCache() const;
+
+
+    /**
+     * @brief       Set the state of an edge.
+     * 
+     * @details     This method patches the entries of the system matrix coupling the
+     *              endpoints of the edge, and updates the data of the current evaluation
+     *              mode locally.
+     * 
+     * @param i         The first endpoint of the edge, with its ID in the graph.
+     * @param j         The second endpoint of the edge, with its ID in the graph.
+     * @param Alive     The new state of the edge.
+     */
+    void SetEdgeAlive(int i, int j, bool Alive);
+
+    /**
+     * @brief       Tells if an edge is dead.
+     * 
+     * @param i     The first endpoint of the edge, with its ID in the graph.
+     * @param j     The second endpoint of the edge, with its ID in the graph.
+     * @return true if the edge is dead.
+     * @return false if the edge lets water flow.
+     * 
+     * @throws pwd::AssertFailException if the nodes are not adjacent.
+     */
+    bool IsDead(int i, int j) const;
+
+    /**
+     * @brief       Load a checkpoint.
+     * 
+     * @details     This method restores the state written by SaveCheckpoint() from the
+     *              given reader.
+     * 
+     * @param Reader    The binary reader.
+     */
+    void LoadCheckpoint(pwd::BinaryReader& Reader);
+
+
+    /**
+     * @brief       Returns the initial water in graph order.
+     * 
+     * @return const Eigen::VectorXd& the initial water, in the order of the graph.
+     */
+    const Eigen::VectorXd& GraphWater0() const;
+
+    /**
+     * @brief       Returns the last evaluated water in graph order.
+     * 
+     * @return const Eigen::VectorXd& the water, in the order of the graph.
+     */
+    const Eigen::VectorXd& GraphWater() const;
+
+    /**
+     * @brief       Returns the IDs of the input nodes.
+     * 
+     * @return const std::vector<int>& the ID in the graph of each input node, empty if
+     *              the graph is in input order.
+     */
+    const std::vector<int>& NodeIDs() const;
+
+    /**
+     * @brief       Returns the solver of a time step.
+     * 
+     * @details     This method returns the cached factorization of the implicit system
+     *              for the given time step, up to the tolerance of the time points,
+     *              and factorizes it if it is not in the cache.
+     * 
+     * @param DT        The time step.
+     * @return pwd::LinearSolver& the factorized solver.
+     */
+    pwd::LinearSolver& StepSolver(double DT);
+
+    /**
+     * @brief       Release the eigenvectors.
+     * 
+     * @details     This method moves the eigenvectors out of the model, for a
+     *              pwd::BasicWaterModel that keeps them in another type. The model
+     *              stays in the spectral mode, but it can only be evaluated before
+     *              SpectralTime() from then on.
+     * 
+     * @param Evecs     The matrix receiving the eigenvectors.
+     */
+    void ReleaseEigenvectors(Eigen::MatrixXd& Evecs);
+
+
+    // The precision models only use Propagate(), NodeID() and the methods above
+    template<typename Scalar, typename AccumScalar>
+    friend class pwd::BasicWaterModel;
 
 public:
     /**
@@ -187,7 +830,10 @@ public:
      * @brief       Copy constructor.
      * 
      * @details     This constructor initializes a new pwd::WaterModel as an exact copy
-     *              of the given one.
+     *              of the given one.\n 
+     *              The factorizations of the solvers are not copied, and they are
+     *              computed again at the next evaluation. In the adaptive evaluation
+     *              mode, the integration restarts from the current state.
      * 
      * @param Model The pwd::WaterModel to copy.
      */
@@ -197,7 +843,10 @@ public:
      * @brief       Overload of the assignment operator.
      * 
      * @details     This constructor sets this pwd::WaterModel to be an exact copy of
-     *              the given one.
+     *              the given one.\n 
+     *              The factorizations of the solvers are not copied, and they are
+     *              computed again at the next evaluation. In the adaptive evaluation
+     *              mode, the integration restarts from the current state.
      * 
      * @param Model The pwd::WaterModel to copy.
      * @return pwd::WaterModel& this model after the assignment.
@@ -236,7 +885,7 @@ public:
      * 
      * @details     This method returns the initial amount of water at the i-th node.
      * 
-     * @param i     The ID of a node.
+     * @param i     The ID of a node in the input file.
      * @return double the initial amount of water at node <code>i</code>.
      */
     double Water0(int i) const;
@@ -257,11 +906,91 @@ public:
      * @details     This method returns the amount of water at the last evaluated
      *              time point at the i-th node.
      * 
-     * @param i     The ID of a node.
+     * @param i     The ID of a node in the input file.
      * @return double the last evaluated water at node <code>i</code>.
      */
     double Water(int i) const;
 
+    /**
+     * @brief       Get the system matrix.
+     * 
+     * @details     This method returns the matrix <code>S</code> of the linear system
+     *              <code>w' = S * w</code> that governs the water of the nodes, in the
+     *              order of the graph.
+     * 
+     * @return const Eigen::SparseMatrix<double>& the system matrix.
+     */
+    const Eigen::SparseMatrix<double>& SystemMatrix() const;
+
+    /**
+     * @brief       Apply the system matrix.
+     * 
+     * @details     This method computes <code>Out = S * In</code> without the sparse
+     *              matrix, streaming the flattened tree once, as pwd::TreeOperator::Apply().
+     *              The vectors are in the order of the graph, and the input and the
+     *              output must not overlap.
+     * 
+     * @param In    The input vector.
+     * @param Out   The output vector.
+     * 
+     * @throws pwd::AssertFailException if the sizes are wrong or the vectors overlap.
+     */
+    void ApplySystem(const Eigen::Ref<const Eigen::VectorXd>& In,
+                     Eigen::Ref<Eigen::VectorXd> Out) const;
+
+    /**
+     * @brief       Get the eigenvalues of the system.
+     * 
+     * @details     This method returns the eigenvalues computed by the last call to
+     *              Build().
+     * 
+     * @return const Eigen::VectorXd& the eigenvalues of the system matrix.
+     */
+    const Eigen::VectorXd& Eigenvalues() const;
+
+    /**
+     * @brief       Get the eigenvectors of the system.
+     * 
+     * @details     This method returns the eigenvectors computed by the last call to
+     *              Build(), one per column, in the order of the graph.
+     * 
+     * @return const Eigen::MatrixXd& the eigenvectors of the system matrix.
+     */
+    const Eigen::MatrixXd& Eigenvectors() const;
+
+    /**
+     * @brief       Get the spectral coefficients of the starting water.
+     * 
+     * @details     This method returns the coefficients of the starting water in the
+     *              eigenbasis, so that the water at time <code>t</code> is the sum of
+     *              the eigenvectors scaled by the coefficients times
+     *              <code>exp(lambda * (t - t0))</code>.
+     * 
+     * @return const Eigen::VectorXd& the spectral coefficients.
+     */
+    const Eigen::VectorXd& SpectralCoefficients() const;
+
+    /**
+     * @brief       Get the time of the switch to the spectral formula.
+     * 
+     * @details     This method returns the time point from which the spectral formula
+     *              is accurate. It is the starting time, unless only the slowest modes
+     *              have been computed.
+     * 
+     * @return double the time of the switch to the spectral formula.
+     */
+    double SpectralTime() const;
+
+    /**
+     * @brief       Get the starting time.
+     * 
+     * @details     This method returns the time point of the starting water, before
+     *              which the model cannot be evaluated.
+     * 
+     * @return double the starting time.
+     */
+    double StartTime() const;
+
     /**
      * @brief       Evaluates the model at given time.
      * 
@@ -276,6 +1005,67 @@ public:
      */
     void Evaluate(double Time);
 
+    /**
+     * @brief       Evaluates the model at many time points.
+     * 
+     * @details     This method evaluates the water diffusion model at each of the given
+     *              time points, and writes the water at the j-th time point in the j-th
+     *              column of <code>Out</code>. At the end, the last evaluation time is
+     *              the last time point.\n 
+     *              In the spectral evaluation mode, the exponentials of all the modes at
+     *              all the time points are computed as a single block, and the whole
+     *              trajectory is recovered with a single matrix product. In the other
+     *              modes, the model is advanced through the time points, and only the
+     *              requested states are written.\n 
+     *              The time points must be sorted in ascending order and cannot precede
+     *              the starting time, and <code>Out</code> must have one row per node
+     *              and one column per time point. Otherwise, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Times     The sorted evaluation times.
+     * @param Out       The matrix of the results.
+     * 
+     * @throws pwd::AssertFailException if the time points are not valid or the size of
+     *                                  <code>Out</code> is wrong.
+     */
+    void EvaluateMany(const std::vector<double>& Times, Eigen::Ref<Eigen::MatrixXd> Out);
+
+    /**
+     * @brief       Computes the wilting time of each node.
+     * 
+     * @details     This method computes, for each node, the first time point between
+     *              the last evaluation time and <code>MaxTime</code> at which its water
+     *              falls below <code>Fraction</code> times its initial water. The time of
+     *              a node already below the threshold is the last evaluation time, and
+     *              the time of a node that never falls below it is infinity. At the end,
+     *              the last evaluation time is <code>MaxTime</code>.\n 
+     *              The interval is split in uniform steps no longer than
+     *              <code>TimeStep</code>, which bracket the crossings. In the spectral
+     *              evaluation mode, the water at the steps is computed in blocks from the
+     *              closed form, and each crossing is found by Newton iterations on the
+     *              sum of exponentials of its node. In the other modes, the model is
+     *              advanced through the steps, and each crossing is found on the cubic
+     *              Hermite interpolant of the water and its derivative at the ends of
+     *              its step. Hence, a node crossing the threshold twice within a step
+     *              may be missed.\n 
+     *              If the fraction is negative, the step is not positive,
+     *              <code>MaxTime</code> precedes the last evaluation time or the size of
+     *              <code>Times</code> is wrong, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Fraction  The fraction of the initial water at which a node wilts.
+     * @param MaxTime   The end of the time interval.
+     * @param TimeStep  The maximum step of the search.
+     * @param Times     The wilting time of each node.
+     * 
+     * @throws pwd::AssertFailException if the parameters are not valid or the size of
+     *                                  <code>Times</code> is wrong.
+     */
+    void WiltingTimes(double Fraction,
+                      double MaxTime,
+                      double TimeStep,
+                      Eigen::Ref<Eigen::VectorXd> Times);
+
     /**
      * @brief       Returns the last evaluation time.
      * 
@@ -286,6 +1076,119 @@ public:
      */
     double LastEvaluationTime() const;
 
+    /**
+     * @brief       Returns the evaluation mode.
+     * 
+     * @details     This method returns the strategy used to evaluate the model, which
+     *              depends on the last building process.
+     * 
+     * @return pwd::EvaluationMode the evaluation mode.
+     */
+    pwd::EvaluationMode GetEvaluationMode() const;
+
+    /**
+     * @brief       Returns the adaptive integrator.
+     * 
+     * @details     This method returns the integrator used in the adaptive evaluation
+     *              mode, which reports the step and rejection statistics of the
+     *              integration since the last reset.
+     * 
+     * @return const pwd::AdaptiveBDF& the adaptive integrator.
+     */
+    const pwd::AdaptiveBDF& GetAdaptiveIntegrator() const;
+
+
+    /**
+     * @brief       Returns the backend of the time stepping solver.
+     * 
+     * @details     This method returns the direct solver used to factorize the implicit
+     *              system when the model is evaluated by time stepping.
+     * 
+     * @return pwd::SolverBackend the backend of the time stepping solver.
+     */
+    pwd::SolverBackend GetSolverBackend() const;
+
+    /**
+     * @brief       Sets the backend of the time stepping solver.
+     * 
+     * @details     This method sets the direct solver used to factorize the implicit
+     *              system when the model is evaluated by time stepping.\n
+     *              Since the graph is a tree, pwd::SolverBackend::Tree factorizes and
+     *              solves the system in linear time, without any fill-in.\n
+     *              The system is factorized again at the next evaluation.
+     * 
+     * @param Backend   The backend of the time stepping solver.
+     */
+    void SetSolverBackend(pwd::SolverBackend Backend);
+
+    /**
+     * @brief       Sets the thread pool of the time stepping solver.
+     * 
+     * @details     This method sets the pool on which the pwd::SolverBackend::ParallelTree
+     *              backend eliminates the subtrees of very large plants. The pool is not
+     *              owned by the model and must outlive it. Many models can share the
+     *              same pool, and a model evaluated by a task of the pool solves on the
+     *              worker of the task.
+     * 
+     * @param Pool  The thread pool, or nullptr to solve sequentially.
+     */
+    void SetThreadPool(pwd::ThreadPool* Pool);
+
+    /**
+     * @brief       Returns the number of cached time steps.
+     * 
+     * @return int the maximum number of factorizations kept by the time stepping.
+     */
+    int GetStepCacheSize() const;
+
+    /**
+     * @brief       Returns the step of the stepping clock.
+     * 
+     * @return double the step of the internal clock, or zero if each evaluation
+     *                takes a single step.
+     */
+    double GetStepSize() const;
+
+    /**
+     * @brief       Sets the step of the stepping clock.
+     * 
+     * @details     By default, each evaluation by time stepping takes a single step from
+     *              the last evaluated time point, hence the accuracy and the cost depend
+     *              on the spacing of the evaluations.\n
+     *              With a positive step, the model integrates on its own grid of time
+     *              points with that step, using a single factorization, and the water
+     *              at any evaluated time point is interpolated by the polynomial through
+     *              the last steps of the BDF scheme. The clock starts from the last
+     *              evaluated time point. The changes of the model, such as killed edges
+     *              or new inflows, apply from the last step of the clock, which is less
+     *              than a step after the last evaluated time point.\n
+     *              Setting the current step does nothing.\n
+     *              If the step is negative, or positive but not larger than the
+     *              tolerance of 1e-7 on the time steps, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Step  The step of the clock, or zero to disable it.
+     * 
+     * @throws pwd::AssertFailException if the step is not valid.
+     */
+    void SetStepSize(double Step);
+
+    /**
+     * @brief       Sets the number of cached time steps.
+     * 
+     * @details     The time stepping keeps the factorizations of the last used time
+     *              steps, so that alternating between a few step sizes only costs the
+     *              triangular solves. When a new time step does not fit, the
+     *              factorization of the least recently used one is replaced.\n
+     *              If the size is not positive, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Size  The maximum number of factorizations, 4 by default.
+     * 
+     * @throws pwd::AssertFailException if <code>Size < 1</code>.
+     */
+    void SetStepCacheSize(int Size);
+
 
     /**
      * @brief       Initialize a model.
@@ -333,9 +1236,296 @@ public:
     /**
      * @brief       Build the water model.
      * 
-     * @details     This method builds the system matrix of the water model.
+     * @details     This method computes the spectral decomposition of the system matrix
+     *              of the water model, so that the model can be evaluated in closed form
+     *              at any time point.\n 
+     *              The system matrix <code>S</code> is similar to the symmetric matrix
+     *              <code>V^(-1/2) * S * V^(1/2)</code>, where <code>V</code> is the
+     *              diagonal matrix of node volumes. Hence, the decomposition is computed
+     *              with a real symmetric eigensolver and the eigenvectors of
+     *              <code>S</code> are recovered by scaling.
      */
     void Build();
+
+    /**
+     * @brief       Set the directory of the spectral cache.
+     * 
+     * @details     This method sets the directory where Build() stores the
+     *              eigendecompositions, creating it if needed. The decompositions are
+     *              identified by a hash of the system, that depends on the geometry and
+     *              the topology of the graph, on the loss rates and on the dead edges.
+     *              When a decomposition is found, Build() loads it from the cache
+     *              instead of computing it.\n 
+     *              An empty path disables the cache, which is the default.
+     * 
+     * @param Directory     The directory of the cache.
+     */
+    void SetCacheDirectory(const std::string& Directory);
+
+    /**
+     * @brief       Returns the directory of the spectral cache.
+     * 
+     * @return const std::string& the directory of the cache, empty if disabled.
+     */
+    const std::string& GetCacheDirectory() const;
+
+    /**
+     * @brief       Build the water model on the slowest modes.
+     * 
+     * @details     This method computes only the <code>NumModes</code> eigenpairs of the
+     *              system with the eigenvalues closest to zero, with a shift-invert
+     *              eigensolver on the sparse symmetrized system. Memory and time scale
+     *              with the size of the graph times the number of modes, instead of
+     *              the cube of the size of the graph.\n 
+     *              The neglected modes decay at least as fast as the fastest computed
+     *              one. After the time at which their contribution falls below the
+     *              tolerance, the model is evaluated in closed form on the computed
+     *              modes. Before that time, the model falls back to time stepping.\n 
+     *              If the number of modes is not between 1 and the number of nodes, the
+     *              method throws a pwd::AssertFailException.
+     * 
+     * @param NumModes      The number of modes.
+     * @param Tolerance     The relative tolerance of the evaluation.
+     * 
+     * @throws pwd::AssertFailException if <code>NumModes</code> is out of range,
+     *                                  <code>Tolerance <= 0</code> or the model has
+     *                                  inflows.
+     */
+    void Build(int NumModes, double Tolerance = 1e-8);
+
+    /**
+     * @brief       Build the water model for the Krylov evaluation.
+     * 
+     * @details     This method prepares the model to be evaluated through the action of
+     *              the matrix exponential on the water vector, computed in a Krylov space
+     *              of the sparse symmetrized system matrix. Unlike Build(), no dense
+     *              matrix is ever formed, and memory and time scale with the size of
+     *              the graph.\n 
+     *              Each evaluation advances the last evaluated water by the elapsed
+     *              time, or restarts from the initial water when going back in time.\n 
+     *              The shifted systems of the Krylov process are factorized with the
+     *              current solver backend.
+     * 
+     * @param Tolerance     The relative tolerance of the evaluation.
+     * 
+     * @throws pwd::AssertFailException if <code>Tolerance <= 0</code> or the model has
+     *                                  inflows.
+     */
+    void BuildKrylov(double Tolerance = 1e-8);
+
+    /**
+     * @brief       Build the water model for the adaptive evaluation.
+     * 
+     * @details     This method prepares the model to be evaluated with an adaptive
+     *              variable-step, variable-order BDF integrator, which takes as many
+     *              internal steps as needed to keep the local error within the given
+     *              tolerances.\n 
+     *              Each evaluation advances the integration from the last evaluated time,
+     *              or restarts from the initial water when going back in time.\n 
+     *              The implicit systems are factorized with the current solver backend.
+     * 
+     * @param RelTol    The relative tolerance on the local error.
+     * @param AbsTol    The absolute tolerance on the local error.
+     * 
+     * @throws pwd::AssertFailException if the tolerances are not positive or the model
+     *                                  has inflows.
+     */
+    void BuildAdaptive(double RelTol = 1e-6, double AbsTol = 1e-9);
+
+
+    /**
+     * @brief       Follow a loss rate schedule.
+     * 
+     * @details     This method makes the time stepping use the loss rates of the given
+     *              schedule, starting from the last evaluated time point. Each step uses
+     *              the loss rates of the segment active at its beginning, hence the
+     *              steps should end on the boundaries of the segments.\n 
+     *              A change of loss rates does not restart the history of the scheme.
+     *              The implicit system of each segment is factorized the first time the
+     *              segment is active, and the factorization is reused on the following
+     *              periods, so that a periodic schedule costs as much per step as
+     *              constant loss rates.\n 
+     *              The schedule is dropped by Initialize() and by any build method, and
+     *              it is stored by SaveCheckpoint().\n 
+     *              If the model is not in the stepping evaluation mode, the schedule is
+     *              empty or the size of its loss rates is wrong, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Schedule  The loss rate schedule.
+     * 
+     * @throws pwd::AssertFailException if the model is not in the stepping mode or the
+     *                                  schedule is not valid.
+     */
+    void SetLossSchedule(const pwd::LossSchedule& Schedule);
+
+    /**
+     * @brief       Stop following the loss rate schedule.
+     * 
+     * @details     This method restores the loss rates of the model before the
+     *              schedule, from the last evaluated time point. If the model follows no
+     *              schedule, the method does nothing.
+     */
+    void ClearLossSchedule();
+
+    /**
+     * @brief       Tells if the model follows a loss rate schedule.
+     * 
+     * @return true if a schedule is active.
+     * @return false otherwise.
+     */
+    bool HasLossSchedule() const;
+
+
+    /**
+     * @brief       Set the inflows.
+     * 
+     * @details     This method adds the given inflows to the model, which then evolves
+     *              as <code>dw/dt = S * w + b(t)</code>, starting from the last evaluated
+     *              time point. The model cannot be evaluated before that time point
+     *              anymore.\n 
+     *              In the stepping evaluation mode, the inflow at the end of each step is
+     *              added to the right-hand side of the BDF scheme. In the spectral
+     *              evaluation mode, the response of each mode to the inflows is the
+     *              convolution of its exponential with the profile, which has a closed
+     *              form on each piece, so that each evaluation costs the same without
+     *              any time stepping.\n 
+     *              Only the stepping mode and the spectral mode with all the modes
+     *              support inflows. The inflows are stored by SaveCheckpoint().\n 
+     *              If the model is in another evaluation mode or the size of the profile
+     *              is wrong, the method throws a pwd::AssertFailException.
+     * 
+     * @param Sources   The profile of the inflows.
+     * 
+     * @throws pwd::AssertFailException if the mode does not support inflows or the size
+     *                                  of the profile is wrong.
+     */
+    void SetSources(const pwd::SourceProfile& Sources);
+
+    /**
+     * @brief       Remove the inflows.
+     * 
+     * @details     This method removes the inflows of the model, starting from the last
+     *              evaluated time point.
+     */
+    void ClearSources();
+
+    /**
+     * @brief       Returns the inflows.
+     * 
+     * @return const pwd::SourceProfile& the profile of the inflows.
+     */
+    const pwd::SourceProfile& GetSources() const;
+
+
+    /**
+     * @brief       Kill an edge.
+     * 
+     * @details     This method makes the edge between the given nodes unable to let water
+     *              flow, without initializing the model again.\n 
+     *              The entries of the system matrix are patched in place, and the data of
+     *              the current evaluation mode are updated locally: the time stepping
+     *              factorization is eliminated again only along the paths to the root,
+     *              the spectral decomposition is updated with a rank-one correction, and
+     *              the Krylov and adaptive solvers update their factorizations. The
+     *              rounding errors of the spectral updates accumulate, and calling Build()
+     *              again computes the decomposition from scratch.\n 
+     *              The change applies from the last evaluated time point, starting from
+     *              the last evaluated water. The model cannot be evaluated before that
+     *              time point anymore.\n 
+     *              If the nodes are not adjacent, the method throws a
+     *              pwd::AssertFailException. Killing a dead edge does nothing.
+     * 
+     * @param i     The first endpoint of the edge.
+     * @param j     The second endpoint of the edge.
+     * 
+     * @throws pwd::AssertFailException if the nodes are not adjacent.
+     */
+    void KillEdge(int i, int j);
+
+    /**
+     * @brief       Revive an edge.
+     * 
+     * @details     This method makes a dead edge able to let water flow again, with the
+     *              same local updates of KillEdge().\n 
+     *              If the nodes are not adjacent, the method throws a
+     *              pwd::AssertFailException. Reviving an alive edge does nothing.
+     * 
+     * @param i     The first endpoint of the edge.
+     * @param j     The second endpoint of the edge.
+     * 
+     * @throws pwd::AssertFailException if the nodes are not adjacent.
+     */
+    void ReviveEdge(int i, int j);
+
+    /**
+     * @brief       Tells if an edge is dead.
+     * 
+     * @param i     The first endpoint of the edge.
+     * @param j     The second endpoint of the edge.
+     * @return true if the edge is dead.
+     * @return false if the edge lets water flow.
+     * 
+     * @throws pwd::AssertFailException if the nodes are not adjacent.
+     */
+    bool IsEdgeDead(int i, int j) const;
+
+
+    /**
+     * @brief       Save a checkpoint.
+     * 
+     * @details     This method writes the full state of the model to a binary file, so
+     *              that an interrupted simulation can be resumed with LoadCheckpoint().\n 
+     *              The file stores the parameters of the model, the dead edges, the
+     *              loss schedule, the inflows, the evaluation mode with the data of its
+     *              solver, the history of the integrators and the factorization of the
+     *              time step of the tree backend. The arrays are stored raw and aligned,
+     *              so that the file can be mapped in memory and restored in place. The
+     *              graph is not stored.\n 
+     *              If the file cannot be written, the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Filename  The path of the checkpoint.
+     * 
+     * @throws pwd::AssertFailException if the file cannot be written.
+     */
+    void SaveCheckpoint(const std::string& Filename) const;
+
+    /**
+     * @brief       Load a checkpoint.
+     * 
+     * @details     This method restores the state written by SaveCheckpoint() in a model
+     *              of the same graph, with the same ordering of the nodes. After the
+     *              restore, the evaluations continue exactly as they would have in the
+     *              saved model. The factorization of the tree backend is read from the
+     *              file, the ones of the other backends are computed again during the
+     *              restore, and the eigendecomposition is read as well. The solvers of
+     *              the other segments of a loss schedule are factorized when reached.\n 
+     *              If the file cannot be read, was written by another version, or does
+     *              not match the graph, the method throws a pwd::AssertFailException.
+     * 
+     * @param Filename  The path of the checkpoint.
+     * 
+     * @throws pwd::AssertFailException if the checkpoint is not valid.
+     */
+    void LoadCheckpoint(const std::string& Filename);
+
+    /**
+     * @brief       Load a checkpoint from memory.
+     * 
+     * @details     This method restores the state written by SaveCheckpoint() from a
+     *              buffer, like a checkpoint mapped in memory, without copying the
+     *              buffer first.\n 
+     *              If the buffer is null the method throws a pwd::NullPointerException,
+     *              and if it is not a valid checkpoint of the graph the method throws a
+     *              pwd::AssertFailException.
+     * 
+     * @param Data      The content of the checkpoint.
+     * @param Size      The size of the checkpoint, in bytes.
+     * 
+     * @throws pwd::NullPointerException if <code>Data</code> is nullptr.
+     * @throws pwd::AssertFailException if the checkpoint is not valid.
+     */
+    void LoadCheckpoint(const void* Data, size_t Size);
 };
 
 } // namespace pwd
@@ -29,9 +29,15 @@ private:
     double m_LossRate;
     double m_Time;
     double m_TimeStep;
+    double m_SolverStep;
+    double m_TargetRate;
     bool m_Exact;
+    bool m_TreeSolver;
+    bool m_Krylov;
     bool m_IsPaused;
     bool m_IsReset;
+    bool m_IsChanged;
+    bool m_IsTimeChanged;
 
 protected:
     virtual void Draw() override;
@@ -48,11 +54,18 @@ public:
     double GetLossRate() const;
     double GetTime() const;
     double GetTimeStep() const;
+    double GetSolverStep() const;
+    double GetTargetRate() const;
     bool IsExact() const;
+    bool IsTreeSolver() const;
+    bool IsKrylov() const;
     bool IsPaused() const;
     bool IsReset() const;
+    bool IsChanged() const;
+    bool IsTimeChanged() const;
 
     void Pause();
+    void SetTime(double Time);
     void Reset();
 };
 
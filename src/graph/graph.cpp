@@ -12,6 +12,7 @@
 #include <pwd/graph/graph.hpp>
 #include <pwd/common/common.hpp>
 #include <pwd/utils/utils.hpp>
+#include <numeric>
 
 
 pwd::Graph::~Graph() { }
@@ -53,6 +54,22 @@ const std::vector<pwd::Node*>& pwd::Graph::GetNodes()
 const pwd::Node* pwd::Graph::Root() const { return m_Root; }
 pwd::Node* pwd::Graph::Root() { return m_Root; }
 
+pwd::NodeOrdering pwd::Graph::GetOrdering() const { return m_Ordering; }
+
+int pwd::Graph::InputID(int ID) const
+{
+    Assert(ID >= 0);
+    Assert(ID < NumNodes());
+    return m_InputIDs[ID];
+}
+
+int pwd::Graph::NodeID(int InputID) const
+{
+    Assert(InputID >= 0);
+    Assert(InputID < NumNodes());
+    return m_FromInput[InputID];
+}
+
 
 
 
@@ -116,12 +133,189 @@ void pwd::Graph::RecomputeHeadsAndTails(bool KeepTail)
 
 
 
+// Append to Order the nodes reached from Start, in depth-first preorder
+static void VisitDepthFirst(const std::vector<int>& AdjBeg,
+                            const std::vector<int>& Adj,
+                            int Start,
+                            std::vector<bool>& Visited,
+                            std::vector<int>& Order)
+{
+    std::vector<int> Stack(1, Start);
+    while (!Stack.empty())
+    {
+        int i = Stack.back();
+        Stack.pop_back();
+        if (Visited[i])
+            continue;
+        Visited[i] = true;
+        Order.push_back(i);
+        // Pushed in reverse, so that the neighbours are visited in their order
+        for (int a = AdjBeg[i + 1] - 1; a >= AdjBeg[i]; --a)
+        {
+            if (!Visited[Adj[a]])
+                Stack.push_back(Adj[a]);
+        }
+    }
+}
+
+// Append to Order the nodes reached from Start, in breadth-first order. If required,
+// the neighbours of each node are visited by increasing degree.
+static void VisitBreadthFirst(const std::vector<int>& AdjBeg,
+                              const std::vector<int>& Adj,
+                              int Start,
+                              bool SortByDegree,
+                              std::vector<bool>& Visited,
+                              std::vector<int>& Order)
+{
+    auto Degree = [&](int i) { return AdjBeg[i + 1] - AdjBeg[i]; };
+    int First = (int)Order.size();
+    Visited[Start] = true;
+    Order.push_back(Start);
+    for (int h = First; h < (int)Order.size(); ++h)
+    {
+        int i = Order[h];
+        int Beg = (int)Order.size();
+        for (int a = AdjBeg[i]; a < AdjBeg[i + 1]; ++a)
+        {
+            int j = Adj[a];
+            if (Visited[j])
+                continue;
+            Visited[j] = true;
+            Order.push_back(j);
+        }
+        if (SortByDegree)
+        {
+            std::stable_sort(Order.begin() + Beg, Order.end(), [&](int a, int b) {
+                return Degree(a) < Degree(b);
+            });
+        }
+    }
+}
+
+// Find a node of maximum eccentricity in the component of Start, as George and Liu:
+// restart from the farthest node with the smallest degree while the eccentricity grows
+static int PeripheralNode(const std::vector<int>& AdjBeg,
+                          const std::vector<int>& Adj,
+                          int Start)
+{
+    auto Degree = [&](int i) { return AdjBeg[i + 1] - AdjBeg[i]; };
+    std::vector<int> Level(AdjBeg.size() - 1, -1);
+    std::vector<int> Queue;
+    int Node = Start;
+    int Eccentricity = -1;
+    while (true)
+    {
+        for (int i : Queue)
+            Level[i] = -1;
+        Queue.assign(1, Node);
+        Level[Node] = 0;
+        for (int h = 0; h < (int)Queue.size(); ++h)
+        {
+            int i = Queue[h];
+            for (int a = AdjBeg[i]; a < AdjBeg[i + 1]; ++a)
+            {
+                int j = Adj[a];
+                if (Level[j] >= 0)
+                    continue;
+                Level[j] = Level[i] + 1;
+                Queue.push_back(j);
+            }
+        }
+        int Last = Level[Queue.back()];
+        if (Last <= Eccentricity)
+            return Node;
+        Eccentricity = Last;
+        int Best = Queue.back();
+        for (int h = (int)Queue.size() - 1; h >= 0 && Level[Queue[h]] == Last; --h)
+        {
+            if (Degree(Queue[h]) < Degree(Best))
+                Best = Queue[h];
+        }
+        Node = Best;
+    }
+}
+
+void pwd::Graph::Reorder(pwd::NodeOrdering Ordering)
+{
+    int n = NumNodes();
+
+    // Adjacency of the current IDs, in compressed form
+    std::vector<int> AdjBeg(n + 1, 0);
+    std::vector<int> Adj;
+    for (int i = 0; i < n; ++i)
+    {
+        AdjBeg[i] = (int)Adj.size();
+        for (const pwd::Node* N : m_Nodes[i]->m_Adj)
+            Adj.push_back(m_IDs.at(N));
+    }
+    AdjBeg[n] = (int)Adj.size();
+
+    // The current IDs, in the new order. Components are visited from the root, then
+    // from their first node in input order.
+    std::vector<int> Order;
+    Order.reserve(n);
+    if (Ordering == pwd::NodeOrdering::Input)
+        Order = m_FromInput;
+    else
+    {
+        std::vector<bool> Visited(n, false);
+        std::vector<int> Starts;
+        Starts.reserve(n + 1);
+        if (m_Root != nullptr)
+            Starts.push_back(m_IDs.at(m_Root));
+        Starts.insert(Starts.end(), m_FromInput.begin(), m_FromInput.end());
+        for (int s : Starts)
+        {
+            if (Visited[s])
+                continue;
+            switch (Ordering)
+            {
+            case pwd::NodeOrdering::DepthFirst:
+                VisitDepthFirst(AdjBeg, Adj, s, Visited, Order);
+                break;
+
+            case pwd::NodeOrdering::BreadthFirst:
+                VisitBreadthFirst(AdjBeg, Adj, s, false, Visited, Order);
+                break;
+
+            case pwd::NodeOrdering::ReverseCuthillMcKee:
+                VisitBreadthFirst(AdjBeg, Adj, PeripheralNode(AdjBeg, Adj, s), true, Visited, Order);
+                break;
+
+            default:
+                break;
+            }
+        }
+        if (Ordering == pwd::NodeOrdering::ReverseCuthillMcKee)
+            std::reverse(Order.begin(), Order.end());
+    }
+    Assert((int)Order.size() == n);
+
+    // Move the nodes to their new IDs
+    std::vector<pwd::Node*> Nodes(n);
+    std::vector<int> InputIDs(n);
+    for (int k = 0; k < n; ++k)
+    {
+        Nodes[k] = m_Nodes[Order[k]];
+        InputIDs[k] = m_InputIDs[Order[k]];
+        m_IDs.at(Nodes[k]) = k;
+        m_FromInput[InputIDs[k]] = k;
+    }
+    m_Nodes = Nodes;
+    m_InputIDs = InputIDs;
+    m_Ordering = Ordering;
+}
+
+
+
+
 
 
 
 
 pwd::Graph::Graph(const std::string& Filename)
 {
+    pwd::PhaseTimer Timer(pwd::Phase::GraphLoad);
     m_Root = nullptr;
 
     std::ifstream Stream;
@@ -176,7 +370,11 @@ pwd::Graph::Graph(const std::string& Filename)
 
     Stream.close();
 
+    m_InputIDs.resize(NumNodes());
+    std::iota(m_InputIDs.begin(), m_InputIDs.end(), 0);
+    m_FromInput = m_InputIDs;
+    m_Ordering = pwd::NodeOrdering::Input;
 
     RecomputeHeadsAndTails();
 
-}
\ No newline at end of file
+}
\ No newline at end of file
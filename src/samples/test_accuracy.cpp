@@ -0,0 +1,309 @@
+/**
+ * @file        test_accuracy.cpp
+ * 
+ * @brief       Sample application for testing the accuracy of the evaluation modes.
+ * 
+ * @details     This application evaluates the water model in the evaluation modes that
+ *              approximate the solution, and checks their results against the closed
+ *              form given by the full spectral decomposition of the system. It also
+ *              checks that evaluating many time points at once gives the results of
+ *              evaluating them one at a time, in every mode, that the wilting times
+ *              fall between the time points of a scan that bracket the crossings, and
+ *              that the spectral response to inflows matches a fine time stepping and
+ *              the steady state.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+#include "test_commons.hpp"
+#include <functional>
+
+
+// The dense eigensolver resolves the slowest eigenvalues up to about 1e-10, hence the
+// spectral reference drifts linearly in time
+#define KRYLOV_TOL      1e-6
+#define SMALL_BASIS     4
+#define SPECTRAL_TOL    1e-8
+#define REL_TOL         1e-6
+#define ABS_TOL         1e-9
+// The tolerances bound the local error, the global one accumulates over the steps
+#define GLOBAL_FACTOR   10.0
+// The closed form of many time points is a matrix product instead of a vector one
+#define MANY_TOL        1e-12
+#define WILTING_TIME    10.0
+#define WILTING_STEP    0.05
+#define SCAN_STEP       0.01
+#define SOURCE_STEP     0.001
+#define SOURCE_TOL      1e-6
+// The slowest mode decays by this exponent before the steady state
+#define STEADY_DECAY    40.0
+
+
+// Relative error of a model against the spectral one at the given time
+double ErrorAt(pwd::WaterModel& Model, pwd::WaterModel& Spectral, double Time)
+{
+    Model.Evaluate(Time);
+    Spectral.Evaluate(Time);
+    return RelativeError(Model.Water(), Spectral.Water());
+}
+
+// Evaluates a model at many time points at once and one at a time, twice
+void CheckEvaluateMany(const pwd::Graph* Graph, const std::function<void(pwd::WaterModel&)>& Setup)
+{
+    pwd::WaterModel Many(Graph, 0.1, 4.0);
+    pwd::WaterModel Single(Graph, 0.1, 4.0);
+    Setup(Many);
+    Setup(Single);
+    std::vector<double> Times = { 0.001, 0.003, 0.01, 0.03, 0.1, 0.3, 1.0, 3.0 };
+    Eigen::MatrixXd Out(Graph->NumNodes(), Times.size());
+    for (int r = 0; r < 2; ++r)
+    {
+        Many.EvaluateMany(Times, Out);
+        for (int t = 0; t < (int)Times.size(); ++t)
+        {
+            Single.Evaluate(Times[t]);
+            Assert(RelativeError(Out.col(t), Single.Water()) <= MANY_TOL);
+        }
+        Assert(Many.LastEvaluationTime() == Times.back());
+        Assert(RelativeError(Many.Water(), Single.Water()) <= MANY_TOL);
+        for (double& Time : Times)
+            Time += 3.0;
+    }
+}
+
+// Checks the wilting times of a model against a scan of its water with the given step,
+// which must be the one of the search in the stepping mode, and returns them
+Eigen::VectorXd CheckWiltingTimes(const pwd::WaterModel& Model, double Fraction, double Step)
+{
+    int n = Model.Water().size();
+    double Infinity = std::numeric_limits<double>::infinity();
+    pwd::WaterModel Wilting(Model);
+    Eigen::VectorXd Times(n);
+    Wilting.WiltingTimes(Fraction, WILTING_TIME, WILTING_STEP, Times);
+    Assert(Wilting.LastEvaluationTime() == WILTING_TIME);
+
+    // The first time point of the scan below the threshold
+    pwd::WaterModel Scan(Model);
+    Eigen::VectorXd Threshold = Fraction * Scan.Water0();
+    Eigen::VectorXd Below = Eigen::VectorXd::Constant(n, Infinity);
+    int NumSteps = (int)std::ceil(WILTING_TIME / Step - 1e-9);
+    double dt = WILTING_TIME / NumSteps;
+    for (int s = 1; s <= NumSteps; ++s)
+    {
+        Scan.Evaluate(s == NumSteps ? WILTING_TIME : s * dt);
+        for (int i = 0; i < n; ++i)
+        {
+            if (Below[i] == Infinity && Scan.Water()[i] < Threshold[i])
+                Below[i] = Scan.LastEvaluationTime();
+        }
+    }
+    for (int i = 0; i < n; ++i)
+    {
+        Assert(std::isinf(Times[i]) == std::isinf(Below[i]));
+        if (!std::isinf(Times[i]))
+            Assert(Times[i] > Below[i] - dt - 1e-9 && Times[i] <= Below[i] + 1e-9);
+    }
+
+    // From the end of the interval, the wilted nodes are already below the threshold
+    Eigen::VectorXd Again(n);
+    Wilting.WiltingTimes(Fraction, 2.0 * WILTING_TIME, WILTING_STEP, Again);
+    for (int i = 0; i < n; ++i)
+        Assert(std::isinf(Times[i]) || Again[i] == WILTING_TIME);
+    return Times;
+}
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+    int n = Graph->NumNodes();
+
+    pwd::WaterModel Spectral(Graph, 0.1, 4.0);
+    Spectral.Build();
+
+
+    // Krylov evaluation, forward and back in time
+    pwd::WaterModel Krylov(Graph, 0.1, 4.0);
+    Krylov.BuildKrylov(1e-10);
+    for (double Time : { 0.01, 0.1, 1.0, 10.0, 100.0, 1000.0, 1.0 })
+        Assert(ErrorAt(Krylov, Spectral, Time) <= KRYLOV_TOL);
+
+    // The slow modes dominate the long times, which converge in a few iterations. A
+    // basis too small for a short time makes the solver split the interval
+    Eigen::VectorXd SqrtVolumes(n);
+    for (int i = 0; i < n; ++i)
+        SqrtVolumes[i] = std::sqrt(Graph->GetNode(i)->Volume());
+    Eigen::SparseMatrix<double> H = SqrtVolumes.cwiseInverse().asDiagonal() *
+                                    Spectral.SystemMatrix() *
+                                    SqrtVolumes.asDiagonal();
+    pwd::KrylovExponential Exponential(1e-8, SMALL_BASIS);
+    Exponential.SetMatrix(H);
+    Eigen::VectorXd Out;
+    Exponential.Apply(0.1, Spectral.Water0().cwiseQuotient(SqrtVolumes), Out);
+    Assert(Exponential.NumIterations() > SMALL_BASIS);
+    Spectral.Evaluate(0.1);
+    Assert(RelativeError(Out.cwiseProduct(SqrtVolumes), Spectral.Water()) <= KRYLOV_TOL);
+
+
+    // Adaptive evaluation, the steps grow as the fast modes decay
+    pwd::WaterModel Adaptive(Graph, 0.1, 4.0);
+    Adaptive.BuildAdaptive(REL_TOL, ABS_TOL);
+    const pwd::AdaptiveBDF& Integrator = Adaptive.GetAdaptiveIntegrator();
+    double LastTime = 0.0;
+    double LastStep = 0.0;
+    double LastMeanStep = 0.0;
+    int LastSteps = 0;
+    for (double Time : { 0.01, 0.1, 1.0, 10.0, 100.0 })
+    {
+        Adaptive.Evaluate(Time);
+        Spectral.Evaluate(Time);
+        Eigen::ArrayXd Tol = REL_TOL * Spectral.Water().array().abs() + ABS_TOL;
+        Assert(((Adaptive.Water() - Spectral.Water()).array().abs() <= GLOBAL_FACTOR * Tol).all());
+
+        double MeanStep = (Time - LastTime) / (Integrator.NumSteps() - LastSteps);
+        Assert(Integrator.StepSize() > LastStep);
+        Assert(MeanStep > LastMeanStep);
+        LastTime = Time;
+        LastStep = Integrator.StepSize();
+        LastMeanStep = MeanStep;
+        LastSteps = Integrator.NumSteps();
+    }
+    // The rejections are limited to the first steps
+    Assert(2 * Integrator.NumRejectedSteps() < Integrator.NumSteps());
+
+
+    // Truncated spectral evaluation, in closed form from its spectral time
+    for (int NumModes : { 5, 20, n / 4 })
+    {
+        pwd::WaterModel Truncated(Graph, 0.1, 4.0);
+        Truncated.Build(NumModes, SPECTRAL_TOL);
+        double Start = Truncated.SpectralTime();
+        for (double Time : { 0.0, 0.01, 0.1, 1.0, 10.0 })
+            Assert(ErrorAt(Truncated, Spectral, Start + Time) <= SPECTRAL_TOL);
+    }
+
+
+    // Wilting times, with isolated nodes that lose no water or lose it faster than the
+    // plant, and a threshold that the plant crosses halfway through the interval
+    Eigen::VectorXd LossRates(n);
+    for (int i = 0; i < n; ++i)
+        LossRates[i] = Graph->GetNode(i)->IsOnLeaf() ? 10.0 : 0.0;
+    std::vector<std::pair<int, int>> DeadEdges;
+    std::vector<int> Isolated = { n / 4, n / 2, 3 * n / 4 };
+    for (int k = 0; k < (int)Isolated.size(); ++k)
+    {
+        int i = Isolated[k];
+        LossRates[i] = 20.0 * k;
+        for (int a = 0; a < Graph->GetNode(i)->Degree(); ++a)
+            DeadEdges.push_back({ i, Graph->GetNodeID(Graph->GetNode(i)->GetAdjacent(a)) });
+    }
+    pwd::WaterModel Stepped(Graph, LossRates, 4.0, DeadEdges);
+    pwd::WaterModel Closed(Stepped);
+    Closed.Build();
+    pwd::WaterModel Half(Closed);
+    Half.Evaluate(0.5 * WILTING_TIME);
+    double Fraction = Half.Water()[0] / Half.Water0()[0];
+    Eigen::VectorXd SteppedTimes = CheckWiltingTimes(Stepped, Fraction, WILTING_STEP);
+    Eigen::VectorXd ClosedTimes = CheckWiltingTimes(Closed, Fraction, SCAN_STEP);
+    // The error of the time stepping shifts the crossings by less than a step
+    for (int i = 0; i < n; ++i)
+    {
+        if (!std::isinf(ClosedTimes[i]))
+            Assert(std::abs(SteppedTimes[i] - ClosedTimes[i]) < WILTING_STEP);
+    }
+    // Every node is below a threshold above its initial water, and a node that loses
+    // no water never wilts
+    Eigen::VectorXd Times(n);
+    for (pwd::WaterModel* Model : { &Stepped, &Closed })
+    {
+        pwd::WaterModel Fresh(*Model);
+        Fresh.WiltingTimes(1.5, WILTING_TIME, WILTING_STEP, Times);
+        Assert((Times.array() == 0.0).all());
+        Model->WiltingTimes(Fraction, WILTING_TIME, WILTING_STEP, Times);
+        Assert(std::isinf(Times[Isolated[0]]) && Times[0] < WILTING_TIME);
+    }
+
+
+    // Inflows in closed form, against the time stepping with a small step. The inflow
+    // grows from zero, since the first steps of BDF6 assume a flat history
+    Eigen::VectorXd Inflow = Eigen::VectorXd::LinSpaced(n, 0.0, 0.02);
+    pwd::SourceProfile Ramp(pwd::Interpolation::Linear);
+    Ramp.AddKnot(0.0, Eigen::VectorXd::Zero(n));
+    Ramp.AddKnot(1.0, Inflow);
+    Ramp.AddKnot(2.0, 0.5 * Inflow.reverse());
+    pwd::WaterModel Response(Graph, 0.1, 4.0);
+    pwd::WaterModel Reference(Graph, 0.1, 4.0);
+    Response.Build();
+    Response.SetSources(Ramp);
+    Reference.SetSources(Ramp);
+    int Steps = 0;
+    for (double Time : { 0.25, 0.5, 1.0, 1.5, 2.0, 3.0 })
+    {
+        while ((Steps + 1) * SOURCE_STEP <= Time + 1e-9)
+            Reference.Evaluate(++Steps * SOURCE_STEP);
+        Response.Evaluate(Time);
+        Assert(RelativeError(Response.Water(), Reference.Water()) <= SOURCE_TOL);
+    }
+    // A constant inflow, or the last knot of the ramp, leads to the steady state. Both
+    // solve the system matrix, up to its condition number
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> LU(Response.SystemMatrix());
+    Eigen::VectorXd Rates = Response.Eigenvalues().cwiseAbs();
+    double SteadyTime = STEADY_DECAY / Rates.minCoeff();
+    double SteadyTol = Rates.maxCoeff() / Rates.minCoeff() * std::numeric_limits<double>::epsilon();
+    pwd::SourceProfile Constant(pwd::Interpolation::Constant);
+    Constant.AddKnot(0.0, Inflow);
+    pwd::WaterModel Steady(Graph, 0.1, 4.0);
+    Steady.Build();
+    Steady.SetSources(Constant);
+    Steady.Evaluate(SteadyTime);
+    Assert(RelativeError(Steady.Water(), LU.solve(-Inflow)) <= SteadyTol);
+    Response.Evaluate(SteadyTime);
+    Assert(RelativeError(Response.Water(), LU.solve(-0.5 * Inflow.reverse())) <= SteadyTol);
+
+
+    // Many time points at once in every mode, also moving the rows to the input order
+    std::vector<std::function<void(pwd::WaterModel&)>> Setups = {
+        [](pwd::WaterModel& Model) { Model.SetSolverBackend(pwd::SolverBackend::SparseLU); },
+        [](pwd::WaterModel& Model) { Model.SetSolverBackend(pwd::SolverBackend::Tree); },
+        [](pwd::WaterModel& Model) { Model.SetStepSize(0.01); },
+        [](pwd::WaterModel& Model) { Model.Build(); },
+        [](pwd::WaterModel& Model) { Model.Build(5); },
+        [](pwd::WaterModel& Model) { Model.BuildKrylov(); },
+        [](pwd::WaterModel& Model) { Model.BuildAdaptive(); }
+    };
+    for (pwd::NodeOrdering Ordering : { pwd::NodeOrdering::Input, pwd::NodeOrdering::DepthFirst })
+    {
+        Graph->Reorder(Ordering);
+        for (const auto& Setup : Setups)
+            CheckEvaluateMany(Graph, Setup);
+    }
+    Graph->Reorder(pwd::NodeOrdering::Input);
+
+
+    delete Graph;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
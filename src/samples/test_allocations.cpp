@@ -0,0 +1,174 @@
+/**
+ * @file        test_allocations.cpp
+ * 
+ * @brief       Sample application for testing the allocations of the time stepping.
+ * 
+ * @details     This application counts the heap allocations done by the evaluations of
+ *              water models in the stepping mode, once their time step is factorized,
+ *              and checks that there are none, also when the steps run on a thread
+ *              pool.\n
+ *              On glibc the allocations are counted by wrapping malloc, which is used
+ *              by both Eigen and operator new. On other platforms only the allocations
+ *              of operator new are counted.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+#define NUM_WARMUP      10
+#define NUM_STEPS       200
+#define TIME_STEP       0.01
+
+
+static std::atomic<long> g_Allocations(0);
+static std::atomic<bool> g_Counting(false);
+
+static void CountAllocation()
+{
+    if (g_Counting.load(std::memory_order_relaxed))
+        g_Allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+#if defined(__GLIBC__)
+extern "C" void* __libc_malloc(size_t Size);
+extern "C" void* __libc_calloc(size_t Num, size_t Size);
+extern "C" void* __libc_realloc(void* Ptr, size_t Size);
+
+extern "C" void* malloc(size_t Size)
+{
+    CountAllocation();
+    return __libc_malloc(Size);
+}
+
+extern "C" void* calloc(size_t Num, size_t Size)
+{
+    CountAllocation();
+    return __libc_calloc(Num, Size);
+}
+
+extern "C" void* realloc(void* Ptr, size_t Size)
+{
+    CountAllocation();
+    return __libc_realloc(Ptr, Size);
+}
+#else
+void* operator new(size_t Size)
+{
+    CountAllocation();
+    void* Ptr = std::malloc(Size == 0 ? 1 : Size);
+    if (Ptr == nullptr)
+        throw std::bad_alloc();
+    return Ptr;
+}
+
+void operator delete(void* Ptr) noexcept { std::free(Ptr); }
+void operator delete(void* Ptr, size_t) noexcept { std::free(Ptr); }
+#endif
+
+
+// Number of allocations of the evaluations after the warm-up
+long CountSteps(pwd::WaterModel& Model)
+{
+    for (int t = 0; t < NUM_WARMUP; ++t)
+        Model.Evaluate(Model.LastEvaluationTime() + TIME_STEP);
+
+    long Before = g_Allocations.load();
+    g_Counting = true;
+    for (int t = 0; t < NUM_STEPS; ++t)
+        Model.Evaluate(Model.LastEvaluationTime() + TIME_STEP);
+    g_Counting = false;
+    Assert(Model.Water().allFinite());
+    return g_Allocations.load() - Before;
+}
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+    int n = Graph->NumNodes();
+
+
+    // Tree backends, with no allocations at all
+    for (pwd::SolverBackend Backend : { pwd::SolverBackend::Tree, pwd::SolverBackend::ParallelTree })
+    {
+        pwd::WaterModel Model(Graph, 0.1, 4.0);
+        Model.SetSolverBackend(Backend);
+        Assert(CountSteps(Model) == 0);
+    }
+
+    // The parallel tree backend on a pool, whose loops are not allocated either
+    pwd::ThreadPool Pool(4);
+    pwd::WaterModel Parallel(Graph, 0.1, 4.0);
+    Parallel.SetSolverBackend(pwd::SolverBackend::ParallelTree);
+    Parallel.SetThreadPool(&Pool);
+    Assert(CountSteps(Parallel) == 0);
+
+    // Inflows and loss rate schedules, once each segment has been factorized
+    pwd::WaterModel Sources(Graph, 0.1, 4.0);
+    Sources.SetSolverBackend(pwd::SolverBackend::Tree);
+    pwd::SourceProfile Profile(pwd::Interpolation::Linear);
+    Profile.AddKnot(0.0, Eigen::VectorXd::Zero(n));
+    Profile.AddKnot(100.0, Eigen::VectorXd::Constant(n, 0.01));
+    Sources.SetSources(Profile);
+    Assert(CountSteps(Sources) == 0);
+
+    pwd::WaterModel Schedule(Graph, 0.1, 4.0);
+    Schedule.SetSolverBackend(pwd::SolverBackend::Tree);
+    pwd::LossSchedule Cycle;
+    Cycle.AddSegment(0.05, Eigen::VectorXd::Constant(n, 0.2));
+    Cycle.AddSegment(0.05, Eigen::VectorXd::Constant(n, 0.05));
+    Schedule.SetLossSchedule(Cycle);
+    Assert(CountSteps(Schedule) == 0);
+
+    // Evaluations between the steps of the clock
+    pwd::WaterModel Clock(Graph, 0.1, 4.0);
+    Clock.SetSolverBackend(pwd::SolverBackend::Tree);
+    Clock.SetStepSize(0.3 * TIME_STEP);
+    Assert(CountSteps(Clock) == 0);
+
+    // The performance counters do not allocate either
+    pwd::EnableMetrics(true);
+    pwd::WaterModel Measured(Graph, 0.1, 4.0);
+    Measured.SetSolverBackend(pwd::SolverBackend::Tree);
+    Assert(CountSteps(Measured) == 0);
+    Assert(pwd::GetMetrics(pwd::Phase::Evaluate).Count == NUM_WARMUP + NUM_STEPS);
+    Assert(pwd::GetMetrics(pwd::Phase::Solve).Count >= NUM_WARMUP + NUM_STEPS);
+    pwd::EnableMetrics(false);
+
+    // The supernodal solves of Eigen allocate a work vector
+    pwd::WaterModel General(Graph, 0.1, 4.0);
+    General.SetSolverBackend(pwd::SolverBackend::SparseLU);
+    Assert(CountSteps(General) <= NUM_STEPS);
+
+
+    delete Graph;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file        test_checkpoints.cpp
+ * 
+ * @brief       Sample application for testing the checkpoints of a water model.
+ * 
+ * @details     This application saves a checkpoint in the middle of a simulation,
+ *              loads it in a new model and checks that the evaluations continue
+ *              bitwise as in the saved model, in all the evaluation modes.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+#include "test_commons.hpp"
+#include <filesystem>
+#include <functional>
+
+
+#define NUM_EVALS       20
+#define TIME_STEP       0.05
+#define PRODUCT_TOL     1e-12
+
+
+// Evaluates the model and returns the water at each time
+Eigen::MatrixXd Run(pwd::WaterModel& Model, int First)
+{
+    Eigen::MatrixXd Water(Model.Water().size(), NUM_EVALS);
+    for (int t = 0; t < NUM_EVALS; ++t)
+    {
+        Model.Evaluate((First + t + 1) * TIME_STEP);
+        Water.col(t) = Model.Water();
+    }
+    return Water;
+}
+
+// Saves a model in the middle of a run, loads it and checks that the run continues bitwise
+void CheckRoundTrip(const pwd::Graph* Graph, const std::string& Path,
+                    const std::function<void(pwd::WaterModel&)>& Setup)
+{
+    pwd::WaterModel Model(Graph, 0.1, 4.0);
+    Setup(Model);
+    Run(Model, 0);
+    Model.SaveCheckpoint(Path);
+    Eigen::MatrixXd Expected = Run(Model, NUM_EVALS);
+
+    pwd::WaterModel Loaded(Graph, 0.5, 1.0);
+    pwd::ResetMetrics();
+    Loaded.LoadCheckpoint(Path);
+    // The factorization of the tree backend is read from the checkpoint
+    if (Loaded.GetSolverBackend() == pwd::SolverBackend::Tree)
+        Assert(pwd::GetMetrics(pwd::Phase::NumericFactorization).Count == 0);
+    Assert((Run(Loaded, NUM_EVALS).array() == Expected.array()).all());
+
+    // The matrix-free operator follows the loaded system
+    Eigen::VectorXd x = Eigen::VectorXd::Random(Loaded.Water().size());
+    Eigen::VectorXd Out(x.size());
+    Loaded.ApplySystem(x, Out);
+    Assert(RelativeError(Out, Loaded.SystemMatrix() * x) <= PRODUCT_TOL);
+}
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+
+
+    std::string Path = (std::filesystem::temp_directory_path() / "pwd_checkpoint.bin").string();
+    pwd::EnableMetrics(true);
+
+    auto Tree = [](pwd::WaterModel& Model) { Model.SetSolverBackend(pwd::SolverBackend::Tree); };
+    auto SparseLU = [](pwd::WaterModel& Model) { Model.SetSolverBackend(pwd::SolverBackend::SparseLU); };
+    auto Clock = [](pwd::WaterModel& Model)
+    {
+        Model.SetSolverBackend(pwd::SolverBackend::Tree);
+        Model.SetStepSize(0.5 * TIME_STEP);
+    };
+    auto Spectral = [](pwd::WaterModel& Model) { Model.Build(); };
+    auto Krylov = [](pwd::WaterModel& Model) { Model.BuildKrylov(); };
+    auto Adaptive = [](pwd::WaterModel& Model) { Model.BuildAdaptive(); };
+    auto Dead = [](pwd::WaterModel& Model)
+    {
+        const pwd::Graph* Graph = Model.GetGraph();
+        int i = Graph->NumNodes() / 2;
+        Model.SetSolverBackend(pwd::SolverBackend::Tree);
+        Model.KillEdge(i, Graph->GetNodeID(Graph->GetNode(i)->GetAdjacent(0)));
+    };
+    // The schedule crosses a boundary and starts a new period after the restore
+    int n = Graph->NumNodes();
+    pwd::LossSchedule Cycle;
+    Cycle.AddSegment(25 * TIME_STEP, Eigen::VectorXd::Constant(n, 0.1));
+    Cycle.AddSegment(10 * TIME_STEP, Eigen::VectorXd::Constant(n, 0.4));
+    auto TreeSchedule = [&](pwd::WaterModel& Model)
+    {
+        Model.SetSolverBackend(pwd::SolverBackend::Tree);
+        Model.SetLossSchedule(Cycle);
+    };
+    auto LUSchedule = [&](pwd::WaterModel& Model)
+    {
+        Model.SetSolverBackend(pwd::SolverBackend::SparseLU);
+        Model.SetLossSchedule(Cycle);
+    };
+    // The inflows change after the restore
+    pwd::SourceProfile Profile(pwd::Interpolation::Linear);
+    Profile.AddKnot(0.0, Eigen::VectorXd::Constant(n, 0.01));
+    Profile.AddKnot(30 * TIME_STEP, Eigen::VectorXd::LinSpaced(n, 0.0, 0.05));
+    Profile.AddKnot(35 * TIME_STEP, Eigen::VectorXd::Zero(n));
+    auto SteppingSources = [&](pwd::WaterModel& Model)
+    {
+        Model.SetSolverBackend(pwd::SolverBackend::Tree);
+        Model.SetSources(Profile);
+    };
+    auto SpectralSources = [&](pwd::WaterModel& Model)
+    {
+        Model.Build();
+        Model.SetSources(Profile);
+    };
+
+    CheckRoundTrip(Graph, Path, Tree);
+    CheckRoundTrip(Graph, Path, SparseLU);
+    CheckRoundTrip(Graph, Path, Clock);
+    CheckRoundTrip(Graph, Path, Spectral);
+    CheckRoundTrip(Graph, Path, Krylov);
+    CheckRoundTrip(Graph, Path, Adaptive);
+    CheckRoundTrip(Graph, Path, Dead);
+    CheckRoundTrip(Graph, Path, TreeSchedule);
+    CheckRoundTrip(Graph, Path, LUSchedule);
+    CheckRoundTrip(Graph, Path, SteppingSources);
+    CheckRoundTrip(Graph, Path, SpectralSources);
+
+    std::filesystem::remove(Path);
+    pwd::EnableMetrics(false);
+
+
+    delete Graph;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
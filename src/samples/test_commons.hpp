@@ -0,0 +1,25 @@
+/**
+ * @file        test_commons.hpp
+ * 
+ * @brief       Helpers shared by the sample applications.
+ * 
+ * @details     This file contains small utilities used by more than one sample
+ *              application to check the results of the water models.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#pragma once
+
+#include <pwd/pwd.hpp>
+
+
+// Relative error of a vector in any precision
+template<typename Derived>
+double RelativeError(const Eigen::MatrixBase<Derived>& x, const Eigen::VectorXd& Expected)
+{
+    return (x.template cast<double>() - Expected).norm() / Expected.norm();
+}
@@ -0,0 +1,223 @@
+/**
+ * @file        test_concurrency.cpp
+ * 
+ * @brief       Sample application for testing concurrent water models.
+ * 
+ * @details     This application evaluates many independent water models on the same
+ *              graph, first serially and then in parallel on multiple threads, and
+ *              checks that the results are bit-identical. The same check is done on a
+ *              parameter sweep run on a pwd::ThreadPool, and on a model evaluated by a
+ *              pwd::SimulationWorker. The members of a pwd::Ensemble are checked
+ *              against standalone models with the same parameters.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+#include <thread>
+#include "test_commons.hpp"
+
+
+#define NUM_MODELS      48
+#define NUM_EVALS       20
+#define TIME_STEP       0.05
+// The batched factorization of the ensemble rounds differently from the models
+#define ENSEMBLE_TOL    1e-9
+
+
+void Simulate(const pwd::Graph* Graph, int i, std::vector<Eigen::VectorXd>& Results)
+{
+    // Each model has its own loss rate, solver backend and evaluation mode
+    pwd::WaterModel Model(Graph, 0.1 + 0.01 * i, 4.0);
+    Model.SetSolverBackend((i / 3) % 2 == 0 ? pwd::SolverBackend::Tree
+                                            : pwd::SolverBackend::SparseLU);
+    if (i % 3 == 1)
+        Model.BuildKrylov();
+    else if (i % 3 == 2)
+        Model.BuildAdaptive();
+
+    Results[i].resize(Model.Water0().size() * NUM_EVALS);
+    for (int t = 0; t < NUM_EVALS; ++t)
+    {
+        Model.Evaluate((t + 1) * TIME_STEP);
+        Results[i].segment(t * Model.Water().size(), Model.Water().size()) = Model.Water();
+    }
+}
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+
+    int NumThreads = std::max<int>(std::thread::hardware_concurrency(), 2);
+    if (argc > 2)
+        NumThreads = std::atoi(argv[2]);
+    Assert(NumThreads > 0);
+
+
+    // Serial evaluation
+    std::vector<Eigen::VectorXd> Serial(NUM_MODELS);
+    for (int i = 0; i < NUM_MODELS; ++i)
+        Simulate(Graph, i, Serial);
+
+    // Parallel evaluation, the models are interleaved among the threads
+    std::vector<Eigen::VectorXd> Parallel(NUM_MODELS);
+    std::vector<std::thread> Threads;
+    for (int t = 0; t < NumThreads; ++t)
+    {
+        Threads.emplace_back([&, t]() {
+            for (int i = t; i < NUM_MODELS; i += NumThreads)
+                Simulate(Graph, i, Parallel);
+        });
+    }
+    for (int t = 0; t < NumThreads; ++t)
+        Threads[t].join();
+
+    // The results must not depend on the other models
+    for (int i = 0; i < NUM_MODELS; ++i)
+    {
+        Assert(Serial[i].size() == Parallel[i].size());
+        Assert((Serial[i].array() == Parallel[i].array()).all());
+        Assert(Serial[i].allFinite());
+    }
+    // Different models must give different results
+    Assert(Serial[0] != Serial[3]);
+
+
+    // Parameter sweep on a thread pool, with the same parameters of the first models
+    pwd::Sweep Sweep(Graph);
+    std::vector<double> Rates;
+    std::vector<double> Times;
+    for (int i = 0; i < NUM_MODELS; i += 3)
+        Rates.push_back(0.1 + 0.01 * i);
+    for (int t = 0; t < NUM_EVALS; ++t)
+        Times.push_back((t + 1) * TIME_STEP);
+    Sweep.AddGrid(Rates, { 4.0 });
+    Sweep.SetTimes(Times);
+    Sweep.SetSolverBackend(pwd::SolverBackend::Tree);
+    Assert(Sweep.NumScenarios() == (int)Rates.size());
+
+    pwd::ThreadPool Pool(NumThreads);
+    Eigen::MatrixXd Sweeps(Graph->NumNodes(), Sweep.NumScenarios() * Sweep.NumTimes());
+    Sweep.Run(Pool, Sweeps);
+    for (int s = 0; s < Sweep.NumScenarios(); ++s)
+    {
+        // Models 0, 6, 12, ... use the tree backend and the stepping mode
+        if (s % 2 != 0)
+            continue;
+        Eigen::Map<Eigen::VectorXd> Res(Sweeps.col(s * NUM_EVALS).data(), Serial[3 * s].size());
+        Assert((Res.array() == Serial[3 * s].array()).all());
+    }
+
+
+    // Ensemble with the same parameters, each member advancing as a standalone model
+    int NumNodes = Graph->NumNodes();
+    pwd::Ensemble Ensemble(Graph, Rates, 4.0);
+    for (int t = 0; t < NUM_EVALS; ++t)
+    {
+        Ensemble.Evaluate((t + 1) * TIME_STEP);
+        for (int k = 0; k < Ensemble.NumMembers(); ++k)
+        {
+            Eigen::VectorXd Expected = Serial[3 * k].segment(t * NumNodes, NumNodes);
+            Assert(RelativeError(Ensemble.Water().col(k), Expected) <= ENSEMBLE_TOL);
+        }
+    }
+
+    // Members with their own loss rate of each node and initial water, and dead edges
+    int DeadNode = NumNodes / 2;
+    std::vector<std::pair<int, int>> DeadEdges = {
+        { DeadNode, Graph->GetNodeID(Graph->GetNode(DeadNode)->GetAdjacent(0)) }
+    };
+    pwd::RowMatrixXd NodeRates(NumNodes, 2);
+    NodeRates.col(0).setConstant(0.1);
+    NodeRates.col(1) = Eigen::VectorXd::LinSpaced(NumNodes, 0.05, 0.2);
+    Eigen::Vector2d InitialWater(4.0, 2.0);
+    pwd::Ensemble Custom(Graph, NodeRates, InitialWater, DeadEdges);
+    std::vector<pwd::WaterModel> Members;
+    for (int k = 0; k < 2; ++k)
+    {
+        Members.emplace_back(Graph, Eigen::VectorXd(NodeRates.col(k)), InitialWater[k], DeadEdges);
+        Members.back().SetSolverBackend(pwd::SolverBackend::Tree);
+    }
+    for (int t = 0; t < NUM_EVALS; ++t)
+    {
+        Custom.Evaluate((t + 1) * TIME_STEP);
+        for (int k = 0; k < 2; ++k)
+        {
+            Members[k].Evaluate((t + 1) * TIME_STEP);
+            Assert(RelativeError(Custom.Water().col(k), Members[k].Water()) <= ENSEMBLE_TOL);
+        }
+    }
+
+
+    // Step systems solved on the pool by domains must match the sequential tree solver
+    pwd::WaterModel Model(Graph, 0.1, 4.0);
+    Eigen::SparseMatrix<double> Eye(Graph->NumNodes(), Graph->NumNodes());
+    Eye.setIdentity();
+    Eigen::SparseMatrix<double> A = Eye - TIME_STEP * Model.SystemMatrix();
+    A.makeCompressed();
+    pwd::TreeSolver Tree;
+    Tree.Compute(A);
+    Eigen::VectorXd Expected = Tree.Solve(Model.Water0());
+    for (int Parts : { 1, 4, 64 })
+    {
+        pwd::ParallelTreeSolver ParallelTree(Parts);
+        ParallelTree.SetThreadPool(&Pool);
+        ParallelTree.Compute(A);
+        Eigen::VectorXd x = ParallelTree.Solve(Model.Water0());
+        Assert((x - Expected).norm() <= 1.0e-12 * Expected.norm());
+
+        // The solves of tasks of the pool run on their own workers, on copies of the
+        // solver since a solver cannot solve two systems at once
+        std::vector<Eigen::VectorXd> Inner(NumThreads);
+        Pool.ParallelFor(0, NumThreads, [&](int t) {
+            pwd::ParallelTreeSolver Copy = ParallelTree;
+            Inner[t] = Copy.Solve(Model.Water0());
+        });
+        for (int t = 0; t < NumThreads; ++t)
+            Assert((Inner[t].array() == x.array()).all());
+    }
+
+
+    // Same evaluations of the first model on a simulation thread, one state at a time
+    pwd::SimulationWorker Simulation(Graph, 0.1, 4.0);
+    Simulation.Submit([](pwd::WaterModel& Model) { Model.SetSolverBackend(pwd::SolverBackend::Tree); });
+    while (!Simulation.Update())
+        std::this_thread::yield();
+    int n = Graph->NumNodes();
+    for (int t = 0; t < NUM_EVALS; ++t)
+    {
+        Simulation.SetTime((t + 1) * TIME_STEP);
+        while (!Simulation.Update())
+            std::this_thread::yield();
+        Assert(Simulation.State().Time == (t + 1) * TIME_STEP);
+        Assert((Simulation.State().Water.array() == Serial[0].segment(t * n, n).array()).all());
+    }
+
+
+    delete Graph;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file        test_factorizations.cpp
+ * 
+ * @brief       Sample application for testing the reuse of the factorizations.
+ * 
+ * @details     This application alternates time steps on water models whose cache
+ *              holds all of them, and checks that each time step is factorized once,
+ *              that the pattern is analyzed once for the cache and the segments of a
+ *              loss rate schedule, and that a copied analysis gives the same
+ *              factorization of a computed one.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+
+
+#define NUM_ROUNDS      10
+#define CACHE_SIZE      3
+
+
+int NumFactorizations() { return pwd::GetMetrics(pwd::Phase::NumericFactorization).Count; }
+int NumAnalyses() { return pwd::GetMetrics(pwd::Phase::SymbolicFactorization).Count; }
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+
+
+    int n = Graph->NumNodes();
+    // Exact in binary, so that the time steps of all the rounds are the same
+    std::vector<double> Steps = { 1.0 / 64.0, 2.0 / 64.0, 3.0 / 64.0 };
+    pwd::ThreadPool Pool(4);
+    pwd::EnableMetrics(true);
+
+    for (pwd::SolverBackend Backend : { pwd::SolverBackend::SparseLU,
+                                        pwd::SolverBackend::Tree,
+                                        pwd::SolverBackend::ParallelTree })
+    {
+        // Alternating time steps, each one factorized during the first round only
+        pwd::WaterModel Model(Graph, 0.1, 4.0);
+        Model.SetSolverBackend(Backend);
+        Model.SetThreadPool(&Pool);
+        Model.SetStepCacheSize(CACHE_SIZE);
+        pwd::ResetMetrics();
+        double Time = 0.0;
+        for (int r = 0; r < NUM_ROUNDS; ++r)
+        {
+            for (double Step : Steps)
+            {
+                Time += Step;
+                Model.Evaluate(Time);
+            }
+            Assert(NumFactorizations() == (int)Steps.size());
+            Assert(NumAnalyses() == 1);
+        }
+
+        // A smaller cache factorizes each time step again, with the same results
+        pwd::WaterModel Single(Graph, 0.1, 4.0);
+        Single.SetSolverBackend(Backend);
+        Single.SetStepCacheSize(1);
+        pwd::ResetMetrics();
+        Time = 0.0;
+        for (int r = 0; r < NUM_ROUNDS; ++r)
+        {
+            for (double Step : Steps)
+            {
+                Time += Step;
+                Single.Evaluate(Time);
+            }
+        }
+        Assert(NumFactorizations() == NUM_ROUNDS * (int)Steps.size());
+        Assert(NumAnalyses() == 1);
+        Assert((Single.Water().array() == Model.Water().array()).all());
+
+        // The segments of a schedule reuse the analysis of the cache
+        pwd::LossSchedule Cycle;
+        Cycle.AddSegment(2.0 * Steps[0], Eigen::VectorXd::Constant(n, 0.2));
+        Cycle.AddSegment(2.0 * Steps[0], Eigen::VectorXd::Constant(n, 0.05));
+        pwd::ResetMetrics();
+        Model.SetLossSchedule(Cycle);
+        for (int t = 0; t < 8; ++t)
+        {
+            Time += Steps[0];
+            Model.Evaluate(Time);
+        }
+        Assert(NumFactorizations() == Cycle.NumSegments());
+        Assert(NumAnalyses() == 0);
+
+        // A copied analysis gives bitwise the factorization of a computed one
+        Eigen::SparseMatrix<double> Eye(n, n);
+        Eye.setIdentity();
+        Eigen::SparseMatrix<double> A = Eye - Steps[0] * Model.SystemMatrix();
+        A.makeCompressed();
+        pwd::LinearSolver Computed(Backend);
+        pwd::LinearSolver Analysis(Backend);
+        pwd::LinearSolver Copied(Backend);
+        Computed.Compute(A);
+        Analysis.AnalyzePattern(A);
+        Copied.CopyAnalysis(Analysis);
+        Assert(Copied.IsAnalyzed() && !Copied.IsFactorized());
+        Copied.Factorize(A);
+        Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+        Assert((Computed.Solve(b).array() == Copied.Solve(b).array()).all());
+    }
+
+    pwd::EnableMetrics(false);
+
+
+    delete Graph;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
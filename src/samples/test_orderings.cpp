@@ -0,0 +1,187 @@
+/**
+ * @file        test_orderings.cpp
+ * 
+ * @brief       Sample application for testing the orderings of the nodes.
+ * 
+ * @details     This application simulates the same scenario on a graph in input order
+ *              and on the same graph reordered in each pwd::NodeOrdering, and checks
+ *              that the water of each input node is unchanged up to rounding.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+#include "test_commons.hpp"
+
+
+#define NUM_EVALS       10
+#define TIME_STEP       0.05
+#define ORDER_TOL       1e-9
+
+
+// The water of each input node, read one node at a time
+Eigen::VectorXd NodeWater(const pwd::WaterModel& Model)
+{
+    Eigen::VectorXd Water(Model.Water().size());
+    for (int i = 0; i < Water.size(); ++i)
+    {
+        Water[i] = Model.Water(i);
+        Assert(Model.Water()[i] == Water[i]);
+    }
+    return Water;
+}
+
+// Simulates a scenario given with the IDs of the input file, and returns its results
+std::vector<Eigen::VectorXd> Simulate(const pwd::Graph* Graph,
+                                      const Eigen::VectorXd& LossRates,
+                                      const std::vector<std::pair<int, int>>& DeadEdges,
+                                      const std::pair<int, int>& Edge)
+{
+    int n = Graph->NumNodes();
+    std::vector<Eigen::VectorXd> Results;
+
+    // Time stepping, with an edge killed and inflows at the first node
+    pwd::WaterModel Model(Graph, LossRates, 4.0, DeadEdges);
+    Model.SetSolverBackend(pwd::SolverBackend::Tree);
+    Results.push_back(Model.Water0());
+    for (int t = 0; t < NUM_EVALS; ++t)
+    {
+        Model.Evaluate((t + 1) * TIME_STEP);
+        Results.push_back(NodeWater(Model));
+    }
+    Assert(Model.IsEdgeDead(DeadEdges[0].first, DeadEdges[0].second));
+    Model.KillEdge(Edge.first, Edge.second);
+    Assert(Model.IsEdgeDead(Edge.second, Edge.first));
+    pwd::SourceProfile Profile;
+    Eigen::VectorXd Inflow = Eigen::VectorXd::Zero(n);
+    Inflow[0] = 0.5;
+    Profile.AddKnot(Model.LastEvaluationTime(), Inflow);
+    Model.SetSources(Profile);
+    Assert((Model.GetSources().Values().col(0).array() == Inflow.array()).all());
+    std::vector<double> Times;
+    for (int t = 0; t < NUM_EVALS; ++t)
+        Times.push_back((NUM_EVALS + t + 1) * TIME_STEP);
+    Eigen::MatrixXd Trajectory(n, NUM_EVALS);
+    Model.EvaluateMany(Times, Trajectory);
+    for (int t = 0; t < NUM_EVALS; ++t)
+        Results.push_back(Trajectory.col(t));
+    Results.push_back(NodeWater(Model));
+    Eigen::VectorXd Wilting(n);
+    Model.WiltingTimes(0.9, 2.0, TIME_STEP, Wilting);
+    Results.push_back(Wilting.cwiseMin(1.0e3));
+    Results.push_back(NodeWater(Model));
+
+    // Loss schedule
+    pwd::WaterModel Schedule(Graph, LossRates, 4.0, DeadEdges);
+    pwd::LossSchedule Cycle;
+    Cycle.AddSegment(2.0 * TIME_STEP, 2.0 * LossRates);
+    Cycle.AddSegment(2.0 * TIME_STEP, 0.5 * LossRates);
+    Schedule.SetLossSchedule(Cycle);
+    for (int t = 0; t < NUM_EVALS; ++t)
+        Schedule.Evaluate((t + 1) * TIME_STEP);
+    Results.push_back(NodeWater(Schedule));
+
+    // Spectral evaluation
+    pwd::WaterModel Spectral(Graph, LossRates, 4.0, DeadEdges);
+    Spectral.Build();
+    Spectral.Evaluate(1.0);
+    Results.push_back(NodeWater(Spectral));
+    Spectral.WiltingTimes(0.9, 5.0, TIME_STEP, Wilting);
+    Results.push_back(Wilting.cwiseMin(1.0e3));
+
+    // Custom precision and ensembles
+    pwd::BasicWaterModel<double> Double(Graph, LossRates, 4.0, DeadEdges);
+    Double.Evaluate(NUM_EVALS * TIME_STEP);
+    Results.push_back(Double.Water());
+    Results.push_back(Results.back());
+    for (int i = 0; i < n; ++i)
+        Results.back()[i] = Double.Water(i);
+    pwd::RowMatrixXd Rates(n, 2);
+    Rates << LossRates, 0.5 * LossRates;
+    pwd::Ensemble Ensemble(Graph, Rates, Eigen::Vector2d(4.0, 2.0), DeadEdges);
+    for (int t = 0; t < NUM_EVALS; ++t)
+        Ensemble.Evaluate((t + 1) * TIME_STEP);
+    Results.push_back(Ensemble.Water().col(1));
+    for (int i = 0; i < n; ++i)
+        Assert(Ensemble.Water(i, 1) == Results.back()[i]);
+
+    // Scenarios of a sweep
+    pwd::Sweep Sweep(Graph);
+    Sweep.AddScenario(LossRates, 4.0, DeadEdges);
+    Sweep.SetTimes({ TIME_STEP, 2.0 * TIME_STEP });
+    Eigen::MatrixXd Swept(n, 2);
+    pwd::ThreadPool Pool(1);
+    Sweep.Run(Pool, Swept);
+    Results.push_back(Swept.col(1));
+
+    return Results;
+}
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    pwd::Graph* Reference;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+        Reference = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+
+
+    // The scenario, with the IDs of the input file
+    int n = Reference->NumNodes();
+    Eigen::VectorXd LossRates(n);
+    for (int i = 0; i < n; ++i)
+        LossRates[i] = Reference->GetNode(i)->IsOnLeaf() ? 0.05 + 0.01 * (i % 7) : 0.0;
+    int i = n / 3;
+    int j = Reference->GetNodeID(Reference->GetNode(i)->GetAdjacent(0));
+    std::vector<std::pair<int, int>> DeadEdges = { { i, j } };
+    i = 2 * n / 3;
+    j = Reference->GetNodeID(Reference->GetNode(i)->GetAdjacent(0));
+    std::pair<int, int> Edge = { i, j };
+    std::vector<Eigen::VectorXd> Expected = Simulate(Reference, LossRates, DeadEdges, Edge);
+
+    for (pwd::NodeOrdering Ordering : { pwd::NodeOrdering::DepthFirst,
+                                        pwd::NodeOrdering::BreadthFirst,
+                                        pwd::NodeOrdering::ReverseCuthillMcKee,
+                                        pwd::NodeOrdering::Input })
+    {
+        Graph->Reorder(Ordering);
+        int Moved = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            Assert(Graph->NodeID(Graph->InputID(k)) == k);
+            Moved += Graph->InputID(k) != k;
+        }
+        Assert((Moved > 0) == (Ordering != pwd::NodeOrdering::Input));
+        std::vector<Eigen::VectorXd> Results = Simulate(Graph, LossRates, DeadEdges, Edge);
+        Assert(Results.size() == Expected.size());
+        for (int r = 0; r < (int)Results.size(); ++r)
+            Assert(RelativeError(Results[r], Expected[r]) <= ORDER_TOL);
+    }
+
+
+    delete Graph;
+    delete Reference;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
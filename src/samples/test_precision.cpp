@@ -0,0 +1,134 @@
+/**
+ * @file        test_precision.cpp
+ * 
+ * @brief       Sample application for testing the water models with a custom precision.
+ * 
+ * @details     This application evaluates the single precision and the mixed precision
+ *              water models next to the double precision one, in the stepping and in
+ *              the spectral modes, and checks that their results agree up to the
+ *              precision of their storage.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+#include "test_commons.hpp"
+
+
+#define NUM_EVALS       20
+#define TIME_STEP       0.05
+#define FLOAT_TOL       1e-5
+
+
+// Checks the models in the current mode against the double precision model
+void Compare(pwd::WaterModel& Model, pwd::BasicWaterModel<double>& Double,
+             pwd::MixedWaterModel& Mixed, pwd::FloatWaterModel& Float, double Time)
+{
+    Model.Evaluate(Time);
+    Double.Evaluate(Time);
+    Mixed.Evaluate(Time);
+    Float.Evaluate(Time);
+    Assert((Double.Water().array() == Model.Water().array()).all());
+    Assert(RelativeError(Mixed.Water(), Model.Water()) <= FLOAT_TOL);
+    Assert(RelativeError(Float.Water(), Model.Water()) <= FLOAT_TOL);
+}
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+
+
+    // Time stepping, with the factorizations of the inner models
+    for (pwd::SolverBackend Backend : { pwd::SolverBackend::SparseLU, pwd::SolverBackend::Tree })
+    {
+        pwd::WaterModel Model(Graph, 0.1, 4.0);
+        pwd::BasicWaterModel<double> Double(Graph, 0.1, 4.0);
+        pwd::MixedWaterModel Mixed(Graph, 0.1, 4.0);
+        pwd::FloatWaterModel Float(Graph, 0.1, 4.0);
+        Model.SetSolverBackend(Backend);
+        Double.SetSolverBackend(Backend);
+        Mixed.SetSolverBackend(Backend);
+        Float.SetSolverBackend(Backend);
+        for (int t = 0; t < NUM_EVALS; ++t)
+            Compare(Model, Double, Mixed, Float, (t + 1) * TIME_STEP);
+        // A different time step restarts the history
+        for (int t = 0; t < NUM_EVALS; ++t)
+            Compare(Model, Double, Mixed, Float, (NUM_EVALS + 2 * t + 2) * TIME_STEP);
+    }
+
+    // Spectral evaluation, only the converted eigenvectors are kept
+    int n = Graph->NumNodes();
+    for (int NumModes : { n, n / 4 })
+    {
+        pwd::WaterModel Model(Graph, 0.1, 4.0);
+        pwd::BasicWaterModel<double> Double(Graph, 0.1, 4.0);
+        pwd::MixedWaterModel Mixed(Graph, 0.1, 4.0);
+        pwd::FloatWaterModel Float(Graph, 0.1, 4.0);
+        if (NumModes == n)
+        {
+            Model.Build();
+            Double.Build();
+            Mixed.Build();
+            Float.Build();
+        }
+        else
+        {
+            Model.Build(NumModes);
+            Double.Build(NumModes);
+            Mixed.Build(NumModes);
+            Float.Build(NumModes);
+        }
+
+        double Start = Model.SpectralTime();
+        if (Start > 0.0)
+            Compare(Model, Double, Mixed, Float, 0.5 * Start);
+        for (double Time : { 0.1, 1.0, 10.0 })
+            Compare(Model, Double, Mixed, Float, Start + Time);
+
+        std::vector<double> Times;
+        for (int t = 0; t < NUM_EVALS; ++t)
+            Times.push_back(Start + 10.0 + (t + 1) * TIME_STEP);
+        Eigen::MatrixXd Expected(n, NUM_EVALS);
+        pwd::BasicWaterModel<double>::MatrixType DoubleOut(n, NUM_EVALS);
+        pwd::MixedWaterModel::MatrixType MixedOut(n, NUM_EVALS);
+        pwd::FloatWaterModel::MatrixType FloatOut(n, NUM_EVALS);
+        Model.EvaluateMany(Times, Expected);
+        Double.EvaluateMany(Times, DoubleOut);
+        Mixed.EvaluateMany(Times, MixedOut);
+        Float.EvaluateMany(Times, FloatOut);
+        for (int t = 0; t < NUM_EVALS; ++t)
+        {
+            Assert((DoubleOut.col(t).array() == Expected.col(t).array()).all());
+            Assert(RelativeError(MixedOut.col(t), Expected.col(t)) <= FLOAT_TOL);
+            Assert(RelativeError(FloatOut.col(t), Expected.col(t)) <= FLOAT_TOL);
+        }
+    }
+
+
+    delete Graph;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file        test_schedule.cpp
+ * 
+ * @brief       Sample application for testing the loss rate schedules.
+ * 
+ * @details     This application runs water models on a periodic loss rate schedule,
+ *              and checks that they give exactly the water of a model whose loss rates
+ *              are switched by hand at the boundaries of the segments, and that the
+ *              periods after the first one factorize no implicit system.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+#include "test_commons.hpp"
+
+
+#define NUM_PERIODS     3
+#define DAY_STEPS       4
+#define NIGHT_STEPS     6
+#define TIME_STEP       0.05
+// The losses are patched on the diagonal, which rounds them
+#define LOSS_TOL        1e-12
+
+
+// A schedule with a single segment, which keeps the given loss rates
+pwd::LossSchedule Constant(const Eigen::VectorXd& LossRates)
+{
+    pwd::LossSchedule Schedule;
+    Schedule.AddSegment(1.0, LossRates);
+    return Schedule;
+}
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+
+
+    int n = Graph->NumNodes();
+    Eigen::VectorXd Day = Eigen::VectorXd::LinSpaced(n, 0.1, 0.4);
+    Eigen::VectorXd Night = Eigen::VectorXd::Constant(n, 0.02);
+    pwd::LossSchedule Cycle;
+    Cycle.AddSegment(DAY_STEPS * TIME_STEP, Day);
+    Cycle.AddSegment(NIGHT_STEPS * TIME_STEP, Night);
+    int PeriodSteps = DAY_STEPS + NIGHT_STEPS;
+    pwd::EnableMetrics(true);
+
+    for (pwd::SolverBackend Backend : { pwd::SolverBackend::SparseLU, pwd::SolverBackend::Tree })
+    {
+        pwd::WaterModel Schedule(Graph, 0.1, 4.0);
+        Schedule.SetSolverBackend(Backend);
+        Schedule.SetLossSchedule(Cycle);
+        Eigen::MatrixXd Water(n, NUM_PERIODS * PeriodSteps);
+        for (int t = 0; t < Water.cols(); ++t)
+        {
+            // Each segment is factorized during the first period only
+            if (t == PeriodSteps)
+                pwd::ResetMetrics();
+            Schedule.Evaluate((t + 1) * TIME_STEP);
+            Water.col(t) = Schedule.Water();
+        }
+        Assert(pwd::GetMetrics(pwd::Phase::NumericFactorization).Count == 0);
+
+        // The same steps, switching the loss rates at the boundaries
+        pwd::WaterModel Switched(Graph, 0.1, 4.0);
+        Switched.SetSolverBackend(Backend);
+        for (int t = 0; t < Water.cols(); ++t)
+        {
+            if (t % PeriodSteps == 0)
+                Switched.SetLossSchedule(Constant(Day));
+            else if (t % PeriodSteps == DAY_STEPS)
+                Switched.SetLossSchedule(Constant(Night));
+            Switched.Evaluate((t + 1) * TIME_STEP);
+            Assert((Switched.Water().array() == Water.col(t).array()).all());
+        }
+
+        // Clearing the schedule restores the loss rates of the model
+        pwd::WaterModel Cleared(Schedule);
+        pwd::WaterModel Plain(Graph, 0.1, 4.0);
+        Cleared.ClearLossSchedule();
+        Eigen::VectorXd Diagonal = Plain.SystemMatrix().diagonal();
+        Assert(RelativeError(Cleared.SystemMatrix().diagonal(), Diagonal) <= LOSS_TOL);
+    }
+
+    pwd::EnableMetrics(false);
+
+
+    delete Graph;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
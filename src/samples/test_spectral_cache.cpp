@@ -0,0 +1,151 @@
+/**
+ * @file        test_spectral_cache.cpp
+ * 
+ * @brief       Sample application for testing the spectral cache.
+ * 
+ * @details     This application builds water models in spectral mode with a cache
+ *              directory, and checks that a decomposition is read back instead of
+ *              computed, that a different system misses the cache, and that a damaged
+ *              entry falls back to a fresh decomposition.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/pwd.hpp>
+#include <filesystem>
+#include <fstream>
+
+
+#define NUM_EVALS       20
+#define TIME_STEP       0.05
+
+
+// Builds a model and returns the number of decompositions it computed
+int Build(pwd::WaterModel& Model, const std::string& CacheDir)
+{
+    Model.SetCacheDirectory(CacheDir);
+    pwd::ResetMetrics();
+    Model.Build();
+    return pwd::GetMetrics(pwd::Phase::Eigendecomposition).Count;
+}
+
+// Evaluates the model and returns the water at each time
+Eigen::MatrixXd Run(pwd::WaterModel& Model)
+{
+    Eigen::MatrixXd Water(Model.Water().size(), NUM_EVALS);
+    for (int t = 0; t < NUM_EVALS; ++t)
+    {
+        Model.Evaluate((t + 1) * TIME_STEP);
+        Water.col(t) = Model.Water();
+    }
+    return Water;
+}
+
+// The only entry of the cache
+std::filesystem::path CacheEntry(const std::string& CacheDir)
+{
+    std::vector<std::filesystem::path> Entries;
+    for (const auto& Entry : std::filesystem::directory_iterator(CacheDir))
+        Entries.push_back(Entry.path());
+    Assert(Entries.size() == 1);
+    return Entries[0];
+}
+
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "This executable needs an input graph file." << std::endl;
+        exit(-1);
+    }
+
+    // Load the graph from file
+    std::string GraphFile = argv[1];
+    pwd::Graph* Graph;
+    try
+    {
+        Graph = new pwd::Graph(GraphFile);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        exit(-1);
+    }
+
+
+    std::string CacheDir = (std::filesystem::temp_directory_path() / "pwd_spectral_cache").string();
+    std::filesystem::remove_all(CacheDir);
+    pwd::EnableMetrics(true);
+
+    // The reference decomposition, with no cache
+    pwd::WaterModel Reference(Graph, 0.1, 4.0);
+    Assert(Build(Reference, "") == 1);
+    Eigen::MatrixXd Expected = Run(Reference);
+
+    // The second build reads the decomposition of the first one
+    pwd::WaterModel First(Graph, 0.1, 4.0);
+    Assert(Build(First, CacheDir) == 1);
+    Assert((Run(First).array() == Expected.array()).all());
+    pwd::WaterModel Second(Graph, 0.1, 4.0);
+    Assert(Build(Second, CacheDir) == 0);
+    Assert((Second.Eigenvalues().array() == Reference.Eigenvalues().array()).all());
+    Assert((Run(Second).array() == Expected.array()).all());
+
+    // A different loss rate or a dead edge is a different system
+    pwd::WaterModel Rate(Graph, 0.2, 4.0);
+    Assert(Build(Rate, CacheDir) == 1);
+    pwd::WaterModel Dead(Graph, 0.1, 4.0);
+    int i = Graph->NumNodes() / 2;
+    Dead.KillEdge(i, Graph->GetNodeID(Graph->GetNode(i)->GetAdjacent(0)));
+    Assert(Build(Dead, CacheDir) == 1);
+    pwd::WaterModel Again(Graph, 0.1, 4.0);
+    Assert(Build(Again, CacheDir) == 0);
+
+    // A truncated entry is computed again, and written back
+    std::filesystem::remove_all(CacheDir);
+    pwd::WaterModel Writer(Graph, 0.1, 4.0);
+    Assert(Build(Writer, CacheDir) == 1);
+    std::filesystem::path Entry = CacheEntry(CacheDir);
+    std::filesystem::resize_file(Entry, std::filesystem::file_size(Entry) / 2);
+    pwd::WaterModel Truncated(Graph, 0.1, 4.0);
+    Assert(Build(Truncated, CacheDir) == 1);
+    Assert((Run(Truncated).array() == Expected.array()).all());
+    pwd::WaterModel Restored(Graph, 0.1, 4.0);
+    Assert(Build(Restored, CacheDir) == 0);
+
+    // A damaged byte of the eigenvectors, or of the header, is a miss as well
+    for (int Offset : { 64, 4 })
+    {
+        uintmax_t Size = std::filesystem::file_size(Entry);
+        std::fstream Stream(Entry, std::ios::in | std::ios::out | std::ios::binary);
+        Stream.seekg(Offset > 8 ? Size - Offset : Offset);
+        char Byte = Stream.get();
+        Stream.seekp(Offset > 8 ? Size - Offset : Offset);
+        Stream.put(Byte ^ 0x10);
+        Stream.close();
+        pwd::WaterModel Corrupted(Graph, 0.1, 4.0);
+        Assert(Build(Corrupted, CacheDir) == 1);
+        Assert((Run(Corrupted).array() == Expected.array()).all());
+    }
+
+    // An entry that can be neither read nor written does not stop the build
+    std::filesystem::remove(Entry);
+    std::filesystem::create_directory(Entry);
+    pwd::WaterModel Blocked(Graph, 0.1, 4.0);
+    Assert(Build(Blocked, CacheDir) == 1);
+    Assert((Run(Blocked).array() == Expected.array()).all());
+
+    std::filesystem::remove_all(CacheDir);
+    pwd::EnableMetrics(false);
+
+
+    delete Graph;
+    std::cout << "Everything has been evaluated without any errors." << std::endl;
+
+
+    return 0;
+}
@@ -52,6 +52,90 @@ int main(int argc, char const *argv[])
     Assert(Stack.IsEmpty());
 
 
+    // Each iteration of a parallel loop is executed exactly once
+    pwd::ThreadPool Pool(4);
+    Assert(Pool.NumThreads() == 4);
+    std::vector<int> Counts(NumElems, 0);
+    Pool.ParallelFor(0, NumElems, [&](int i) { Counts[i]++; });
+    for (int i = 0; i < NumElems; ++i)
+        Assert(Counts[i] == 1);
+
+    // Exceptions thrown by the tasks are rethrown by the caller
+    bool Thrown = false;
+    try
+    {
+        Pool.ParallelFor(0, NumElems, [&](int i) { Assert(i != NumElems / 2); });
+    }
+    catch(const pwd::AssertFailException& e)
+    {
+        Thrown = true;
+    }
+    Assert(Thrown);
+    Pool.ParallelFor(0, NumElems, [&](int i) { Counts[i]++; });
+    for (int i = 0; i < NumElems; ++i)
+        Assert(Counts[i] == 2);
+
+    // Concurrent loops on the same pool only receive their own errors
+    bool OtherThrown = false;
+    std::thread Other([&]()
+    {
+        try
+        {
+            Pool.ParallelFor(0, NumElems, [&](int i) { Assert(i != 0); });
+        }
+        catch(const pwd::AssertFailException& e)
+        {
+            OtherThrown = true;
+        }
+    });
+    for (int r = 0; r < 10; ++r)
+        Pool.ParallelFor(0, NumElems, [&](int i) { Counts[i]++; });
+    Other.join();
+    Assert(OtherThrown);
+    for (int i = 0; i < NumElems; ++i)
+        Assert(Counts[i] == 12);
+
+    // Loops inside the tasks of the pool run on the worker of the task
+    std::vector<int> Nested(NumElems * NumElems, 0);
+    Pool.ParallelFor(0, NumElems, [&](int i)
+    {
+        Pool.ParallelFor(0, NumElems, [&](int j) { Nested[i * NumElems + j]++; });
+    });
+    for (int i = 0; i < NumElems * NumElems; ++i)
+        Assert(Nested[i] == 1);
+
+
+    // Binary buffers are read back in the same order, with aligned arrays
+    Eigen::VectorXd Values = Eigen::VectorXd::LinSpaced(NumElems, 0.0, 1.0);
+    pwd::BinaryWriter Writer;
+    Writer.Write<int32_t>(NumElems);
+    Writer.WriteVector(Values);
+    Writer.Write(0.5);
+    pwd::BinaryReader Reader(Writer.Data(), Writer.Size());
+    Assert(Reader.Read<int32_t>() == NumElems);
+    Eigen::Map<const Eigen::VectorXd> Read = Reader.ReadVector();
+    Assert((Read.data() - (const double*)Writer.Data()) % (PWD_BINARY_ALIGNMENT / sizeof(double)) == 0);
+    Assert(Read == Values);
+    Assert(Reader.Read<double>() == 0.5);
+    Assert(Reader.Offset() == Reader.Size());
+
+
+    // Phases are counted only while the metrics are enabled, from any thread
+    pwd::ResetMetrics();
+    { pwd::PhaseTimer Timer(pwd::Phase::Solve); }
+    Assert(pwd::GetMetrics(pwd::Phase::Solve).Count == 0);
+    pwd::EnableMetrics(true);
+    Pool.ParallelFor(0, NumElems, [&](int) { pwd::PhaseTimer Timer(pwd::Phase::Solve); });
+    pwd::EnableMetrics(false);
+    pwd::PhaseMetrics Solves = pwd::GetMetrics(pwd::Phase::Solve);
+    Assert(Solves.Count == (size_t)NumElems);
+    Assert(Solves.MaxTime >= 0.0 && Solves.MaxTime <= Solves.TotalTime);
+    Assert(pwd::GetMetrics(pwd::Phase::Evaluate).Count == 0);
+    pwd::ResetMetrics();
+    Assert(pwd::GetMetrics(pwd::Phase::Solve).Count == 0);
+    Assert(pwd::GetMetrics(pwd::Phase::Solve).TotalTime == 0.0);
+
+
 
     std::cout << "Everything has been evaluated without any errors." << std::endl;
 
@@ -15,9 +15,6 @@
 #include <io/io.hpp>
 
 
-void TimerStart();
-double TimerStop();
-
 int main(int argc, char const *argv[])
 {
     if (argc < 2)
@@ -26,6 +23,9 @@ int main(int argc, char const *argv[])
         exit(-1);
     }
 
+    // Time spent in each phase of the library, reported at exit
+    pwd::EnableMetrics(true);
+
     // Load the graph from file
     std::string GraphFile = argv[1];
     pwd::Graph* Graph;
@@ -46,6 +46,8 @@ int main(int argc, char const *argv[])
 
     // Create the window and the 3D model
     render::Window Window("Test Water Model");
+    // Rendering is paced by vsync, the simulation by its own target rate
+    Window.ToggleVSync(true);
     render::Model Model(Mesh);
 
     // Create the camera
@@ -74,11 +76,11 @@ int main(int argc, char const *argv[])
     UIManager.AttachComponent(WModProp);
 
 
-    pwd::WaterModel WaterModel(Graph, WModProp.GetLossRate(), WModProp.GetInitialWater());
-    // WaterModel.Build();
-    double TotWater0 = WaterModel.Water0().maxCoeff();
-    size_t NumFrames = 0;
-    double TotTime = 0.0;
+    // The model runs on its own thread, so slow evaluations and builds do not stall the frames
+    pwd::SimulationWorker Simulation(Graph, WModProp.GetLossRate(), WModProp.GetInitialWater());
+    // Exact solutions of plants already seen are loaded from the cache
+    Simulation.Submit([](pwd::WaterModel& Model) { Model.SetCacheDirectory("spectral-cache"); });
+    double TotWater0 = Simulation.State().Water.maxCoeff();
     while (!Window.ShouldClose())
     {
         Window.PollEvents();
@@ -88,22 +90,59 @@ int main(int argc, char const *argv[])
         if (Window.KeyDown(GLFW_KEY_ESCAPE)) 
             Window.Close();
 
-        if (!WModProp.IsPaused())
+        // Parameter changes are queued and applied by the simulation thread
+        if (WModProp.IsReset())
         {
-            TimerStart();
-            WaterModel.Evaluate(WModProp.GetTime());
-            TotTime += TimerStop();
-            NumFrames += 1;
+            double LossRate = WModProp.GetLossRate();
+            double InitialWater = WModProp.GetInitialWater();
+            bool Exact = WModProp.IsExact();
+            bool Krylov = WModProp.IsKrylov();
+            Simulation.Submit([=](pwd::WaterModel& Model)
+            {
+                Model.Initialize(LossRate, InitialWater);
+                if (Exact)
+                    Model.Build();
+                else if (Krylov)
+                    Model.BuildKrylov();
+            });
         }
-        if (WModProp.IsReset())
+        if (WModProp.IsReset() || WModProp.IsChanged())
         {
-            WaterModel.Initialize(WModProp.GetLossRate(), WModProp.GetInitialWater());
-            if (WModProp.IsExact())
-                WaterModel.Build();
+            pwd::SolverBackend Backend = WModProp.IsTreeSolver() ? pwd::SolverBackend::Tree
+                                                                 : pwd::SolverBackend::SparseLU;
+            // The model integrates with its own step, independently of the evaluations
+            double SolverStep = WModProp.GetSolverStep();
+            Simulation.Submit([=](pwd::WaterModel& Model)
+            {
+                Model.SetSolverBackend(Backend);
+                Model.SetStepSize(SolverStep);
+            });
+            Simulation.SetTimeStep(WModProp.GetTimeStep());
+            Simulation.SetTargetRate(WModProp.GetTargetRate());
+            Simulation.SetPaused(WModProp.IsPaused());
         }
+        if (WModProp.IsTimeChanged())
+            Simulation.SetTime(WModProp.GetTime());
         
         if (Window.KeyPressed(GLFW_KEY_SPACE))
+        {
             WModProp.Pause();
+            Simulation.SetPaused(WModProp.IsPaused());
+        }
+
+        // Latest state of the simulation, without waiting for it
+        try
+        {
+            Simulation.Update();
+        }
+        catch(const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+            if (!WModProp.IsPaused())
+                WModProp.Pause();
+        }
+        const pwd::SimulationState& State = Simulation.State();
+        WModProp.SetTime(State.Time);
 
         // Camera aspect ratio to match window
         Camera.SetAspectRatio(Window.Width(), Window.Height());
@@ -162,7 +201,7 @@ int main(int argc, char const *argv[])
             Model.Transform().SetScale(GLScale);
 
             render::Material Mat = ModProps.GetMaterial();
-            float Val = WaterModel.Water(i) / TotWater0;
+            float Val = State.Water[i] / TotWater0;
             Mat.Ambient = CMapProps.GetColor(Val);
 
             Model.Shader().Use();
@@ -174,25 +213,10 @@ int main(int argc, char const *argv[])
         Window.SwapBuffers();
     }
 
-    std::cout << "Average time per frame is " << (TotTime / NumFrames) << " ms." << std::endl;
+    const pwd::SimulationState& State = Simulation.State();
+    if (State.NumEvaluations > 0)
+        std::cout << "Average time per evaluation is " << (State.EvaluationTime / State.NumEvaluations) << " ms." << std::endl;
+    pwd::PrintMetrics(std::cout);
 
     return 0;
 }
-
-
-
-
-
-std::chrono::system_clock::time_point Start;
-void TimerStart()
-{
-    Start = std::chrono::system_clock::now();
-}
-double TimerStop()
-{
-    std::chrono::system_clock::time_point End;
-    End = std::chrono::system_clock::now();
-    std::chrono::system_clock::duration ETA = End - Start;
-    size_t us = std::chrono::duration_cast<std::chrono::microseconds>(ETA).count();
-    return 1.0e-3 * us;
-}
\ No newline at end of file
@@ -0,0 +1,353 @@
+/**
+ * @file        adaptivebdf.cpp
+ * 
+ * @brief       Implements pwd::AdaptiveBDF.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/adaptivebdf.hpp>
+
+
+pwd::AdaptiveBDF::AdaptiveBDF(double RelTol, double AbsTol, int MaxOrder)
+    : m_Gamma(-1.0), m_Head(0), m_NumHistory(0), m_Step(0.0), m_Order(1),
+      m_StepsAtOrder(0), m_NumFailures(0), m_NumSteps(0), m_NumRejected(0),
+      m_NumFactorizations(0)
+{
+    SetTolerances(RelTol, AbsTol);
+    SetMaxOrder(MaxOrder);
+}
+
+pwd::AdaptiveBDF::~AdaptiveBDF() { }
+
+
+void pwd::AdaptiveBDF::SetMatrix(const Eigen::SparseMatrix<double>& S)
+{
+    Assert(S.rows() == S.cols());
+    m_S = S;
+    m_Eye.resize(m_S.rows(), m_S.cols());
+    m_Eye.setIdentity();
+    m_Solver.AnalyzePattern(m_Eye - m_S);
+    m_Gamma = -1.0;
+    m_NumHistory = 0;
+}
+
+void pwd::AdaptiveBDF::UpdateMatrix(const Eigen::SparseMatrix<double>& S,
+                                    const std::vector<int>& Nodes)
+{
+    Assert(S.rows() == m_S.rows() && S.cols() == m_S.cols());
+    Assert(S.nonZeros() == m_S.nonZeros());
+
+    bool Shifted = m_Gamma > 0.0 && m_Shifted.nonZeros() == m_S.nonZeros();
+    for (int j : Nodes)
+    {
+        for (int Idx = m_S.outerIndexPtr()[j]; Idx < m_S.outerIndexPtr()[j + 1]; ++Idx)
+        {
+            int i = m_S.innerIndexPtr()[Idx];
+            if (std::find(Nodes.begin(), Nodes.end(), i) == Nodes.end())
+                continue;
+            m_S.valuePtr()[Idx] = S.valuePtr()[Idx];
+            if (Shifted)
+                m_Shifted.valuePtr()[Idx] = (i == j ? 1.0 : 0.0) - m_Gamma * m_S.valuePtr()[Idx];
+        }
+    }
+
+    if (Shifted)
+        m_Solver.Refactorize(m_Shifted, Nodes);
+    else
+        m_Gamma = -1.0;
+    m_NumHistory = 0;
+}
+
+void pwd::AdaptiveBDF::SetTolerances(double RelTol, double AbsTol)
+{
+    Assert(RelTol > 0.0);
+    Assert(AbsTol > 0.0);
+    m_RelTol = RelTol;
+    m_AbsTol = AbsTol;
+}
+
+double pwd::AdaptiveBDF::GetRelTolerance() const { return m_RelTol; }
+double pwd::AdaptiveBDF::GetAbsTolerance() const { return m_AbsTol; }
+
+void pwd::AdaptiveBDF::SetMaxOrder(int MaxOrder)
+{
+    Assert(MaxOrder >= 1 && MaxOrder <= 6);
+    m_MaxOrder = MaxOrder;
+    m_NumHistory = 0;
+}
+
+int pwd::AdaptiveBDF::GetMaxOrder() const { return m_MaxOrder; }
+
+void pwd::AdaptiveBDF::SetBackend(pwd::SolverBackend Backend)
+{
+    if (Backend == m_Solver.GetBackend())
+        return;
+    m_Solver.SetBackend(Backend);
+    if (m_S.rows() > 0)
+        m_Solver.AnalyzePattern(m_Eye - m_S);
+    m_Gamma = -1.0;
+}
+
+pwd::SolverBackend pwd::AdaptiveBDF::GetBackend() const { return m_Solver.GetBackend(); }
+
+
+double pwd::AdaptiveBDF::Time() const { return HistoryTime(0); }
+Eigen::VectorXd pwd::AdaptiveBDF::State() const { return m_History.col(m_Head); }
+int pwd::AdaptiveBDF::Order() const { return m_Order; }
+double pwd::AdaptiveBDF::StepSize() const { return m_Step; }
+int pwd::AdaptiveBDF::NumSteps() const { return m_NumSteps; }
+int pwd::AdaptiveBDF::NumRejectedSteps() const { return m_NumRejected; }
+int pwd::AdaptiveBDF::NumFactorizations() const { return m_NumFactorizations; }
+
+
+Eigen::MatrixXd::ColXpr pwd::AdaptiveBDF::HistoryValue(int j)
+{
+    int Cap = m_History.cols();
+    return m_History.col((m_Head - j + Cap) % Cap);
+}
+
+double pwd::AdaptiveBDF::HistoryTime(int j) const
+{
+    int Cap = m_Times.size();
+    return m_Times[(m_Head - j + Cap) % Cap];
+}
+
+double pwd::AdaptiveBDF::WeightedNorm(const Eigen::VectorXd& v) const
+{
+    const auto& y = m_History.col(m_Head);
+    Eigen::ArrayXd W = m_RelTol * y.array().abs().max(m_Y.array().abs()) + m_AbsTol;
+    return std::sqrt((v.array() / W).square().mean());
+}
+
+void pwd::AdaptiveBDF::Predict(double t, int NumPoints)
+{
+    m_Pred.setZero();
+    for (int j = 0; j < NumPoints; ++j)
+    {
+        // Lagrange basis of the j-th history point
+        double Lj = 1.0;
+        for (int m = 0; m < NumPoints; ++m)
+        {
+            if (m != j)
+                Lj *= (t - HistoryTime(m)) / (HistoryTime(j) - HistoryTime(m));
+        }
+        m_Pred += Lj * HistoryValue(j);
+    }
+}
+
+double pwd::AdaptiveBDF::EstimateError(double t, int q)
+{
+    double Factor;
+    if (m_NumHistory < q + 1)
+    {
+        // First step, compare with the explicit Euler method
+        m_Pred = HistoryValue(0) + (t - HistoryTime(0)) * m_F0;
+        Factor = 1.0;
+    }
+    else
+    {
+        Predict(t, q + 1);
+        Factor = (t - HistoryTime(0)) / (t - HistoryTime(q));
+    }
+    return Factor * WeightedNorm(m_Y - m_Pred);
+}
+
+void pwd::AdaptiveBDF::Factorize(double Gamma)
+{
+    if (Gamma == m_Gamma)
+        return;
+    m_Shifted = m_Eye - Gamma * m_S;
+    m_Solver.Factorize(m_Shifted);
+    m_Gamma = Gamma;
+    m_NumFactorizations++;
+}
+
+
+void pwd::AdaptiveBDF::Reset(const Eigen::VectorXd& y0, double t0)
+{
+    Assert(m_S.rows() > 0);
+    Assert(y0.size() == m_S.rows());
+
+    m_History.resize(y0.size(), m_MaxOrder + 2);
+    m_Times.assign(m_MaxOrder + 2, t0);
+    m_Head = 0;
+    m_History.col(m_Head) = y0;
+    m_NumHistory = 1;
+    m_Order = 1;
+    m_StepsAtOrder = 0;
+    m_NumFailures = 0;
+    m_NumSteps = 0;
+    m_NumRejected = 0;
+    m_NumFactorizations = 0;
+
+    // Initial step from the ratio between the state and its derivative
+    m_Y = y0;
+    m_F0 = m_S * y0;
+    double d0 = WeightedNorm(y0);
+    double d1 = WeightedNorm(m_F0);
+    m_Step = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+}
+
+void pwd::AdaptiveBDF::Advance(double Time)
+{
+    Assert(m_NumHistory > 0);
+    Assert(Time >= HistoryTime(0));
+
+    while (HistoryTime(0) < Time)
+    {
+        double tn = HistoryTime(0);
+        double Remaining = Time - tn;
+        double h = m_Step;
+        if (Remaining <= h)
+            h = Remaining;
+        else if (Remaining < 2.0 * h)
+            h = 0.5 * Remaining;
+        bool Clipped = h < m_Step;
+        double t = (h == Remaining) ? Time : tn + h;
+        int k = std::min(m_Order, m_NumHistory);
+
+        // Derivative of the polynomial interpolating the new solution and the last
+        // k solutions, evaluated at the new time point
+        double a0 = 0.0;
+        for (int m = 0; m < k; ++m)
+            a0 += 1.0 / (t - HistoryTime(m));
+        m_Rhs.setZero(m_S.rows());
+        for (int j = 0; j < k; ++j)
+        {
+            double Num = 1.0;
+            double Den = HistoryTime(j) - t;
+            for (int m = 0; m < k; ++m)
+            {
+                if (m == j)
+                    continue;
+                Num *= t - HistoryTime(m);
+                Den *= HistoryTime(j) - HistoryTime(m);
+            }
+            m_Rhs -= (Num / Den) * HistoryValue(j);
+        }
+        double Gamma = 1.0 / a0;
+        Factorize(Gamma);
+        m_Rhs *= Gamma;
+        m_Y = m_Solver.Solve(m_Rhs);
+
+        double Err = EstimateError(t, k);
+        if (Err > 1.0)
+        {
+            m_NumRejected++;
+            m_NumFailures++;
+            m_Step = h * std::max(0.2, 0.9 * std::pow(Err, -1.0 / (k + 1)));
+            // Repeated failures mean the history is unreliable
+            if (m_NumFailures >= 2 && m_Order > 1)
+            {
+                m_Order--;
+                m_StepsAtOrder = 0;
+            }
+            Assert(tn + m_Step > tn);
+            continue;
+        }
+
+        // Candidate orders for the next step
+        double ErrDown = k > 1 ? EstimateError(t, k - 1) : 0.0;
+        bool CanRaise = k == m_Order && k < m_MaxOrder && m_StepsAtOrder >= k + 1 &&
+                        m_NumHistory >= k + 2;
+        double ErrUp = CanRaise ? EstimateError(t, k + 1) : 0.0;
+        int q = k;
+        double Ratio = Err > 0.0 ? std::pow(Err, -1.0 / (k + 1)) : 10.0;
+        if (k > 1)
+        {
+            double RatioDown = ErrDown > 0.0 ? std::pow(ErrDown, -1.0 / k) : 10.0;
+            if (RatioDown > Ratio)
+            {
+                q = k - 1;
+                Ratio = RatioDown;
+            }
+        }
+        if (CanRaise)
+        {
+            double RatioUp = ErrUp > 0.0 ? std::pow(ErrUp, -1.0 / (k + 2)) : 10.0;
+            if (RatioUp > Ratio)
+            {
+                q = k + 1;
+                Ratio = RatioUp;
+            }
+        }
+        Ratio = std::min(std::max(0.9 * Ratio, 0.2), 2.0);
+        // Small increments are not worth a new factorization
+        if (q == k && Ratio >= 1.0 && Ratio < 1.5)
+            Ratio = 1.0;
+
+        // Accept the step
+        m_Head = (m_Head + 1) % m_History.cols();
+        m_History.col(m_Head) = m_Y;
+        m_Times[m_Head] = t;
+        m_NumHistory = std::min<int>(m_NumHistory + 1, m_History.cols());
+        m_NumSteps++;
+        m_NumFailures = 0;
+        if (q != m_Order)
+        {
+            m_Order = q;
+            m_StepsAtOrder = 0;
+        }
+        else
+            m_StepsAtOrder++;
+        if (!Clipped || Ratio < 1.0)
+            m_Step = h * Ratio;
+    }
+}
+
+void pwd::AdaptiveBDF::Save(pwd::BinaryWriter& Writer) const
+{
+    Writer.Write(m_RelTol);
+    Writer.Write(m_AbsTol);
+    Writer.Write<int32_t>(m_MaxOrder);
+    Writer.Write<int32_t>(m_Head);
+    Writer.Write<int32_t>(m_NumHistory);
+    Writer.Write(m_Step);
+    Writer.Write<int32_t>(m_Order);
+    Writer.Write<int32_t>(m_StepsAtOrder);
+    Writer.Write<int32_t>(m_NumFailures);
+    Writer.Write<int32_t>(m_NumSteps);
+    Writer.Write<int32_t>(m_NumRejected);
+    Writer.Write<int32_t>(m_NumFactorizations);
+    Writer.WriteMatrix(m_History);
+    Writer.WriteArray(m_Times.data(), m_Times.size(), 1);
+    Writer.WriteVector(m_F0);
+}
+
+void pwd::AdaptiveBDF::Load(pwd::BinaryReader& Reader)
+{
+    Assert(m_S.rows() > 0);
+    double RelTol = Reader.Read<double>();
+    double AbsTol = Reader.Read<double>();
+    SetTolerances(RelTol, AbsTol);
+    SetMaxOrder(Reader.Read<int32_t>());
+    m_Head = Reader.Read<int32_t>();
+    int NumHistory = Reader.Read<int32_t>();
+    m_Step = Reader.Read<double>();
+    m_Order = Reader.Read<int32_t>();
+    m_StepsAtOrder = Reader.Read<int32_t>();
+    m_NumFailures = Reader.Read<int32_t>();
+    m_NumSteps = Reader.Read<int32_t>();
+    m_NumRejected = Reader.Read<int32_t>();
+    m_NumFactorizations = Reader.Read<int32_t>();
+    m_History = Reader.ReadMatrix();
+    Eigen::Map<const Eigen::VectorXd> Times = Reader.ReadVector();
+    m_Times.assign(Times.data(), Times.data() + Times.size());
+    m_F0 = Reader.ReadVector();
+
+    Assert(m_History.rows() == m_S.rows());
+    Assert(m_History.cols() == m_MaxOrder + 2);
+    Assert((int)m_Times.size() == m_MaxOrder + 2);
+    Assert(m_F0.size() == m_S.rows());
+    Assert(m_Head >= 0 && m_Head < m_History.cols());
+    Assert(NumHistory > 0 && NumHistory <= m_History.cols());
+    Assert(m_Order >= 1 && m_Order <= m_MaxOrder);
+    m_NumHistory = NumHistory;
+    m_Y = m_History.col(m_Head);
+    m_Pred.setZero(m_S.rows());
+    m_Gamma = -1.0;
+}
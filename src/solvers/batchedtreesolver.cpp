@@ -0,0 +1,108 @@
+/**
+ * @file        batchedtreesolver.cpp
+ * 
+ * @brief       Implements pwd::BatchedTreeSolver.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/batchedtreesolver.hpp>
+
+
+pwd::BatchedTreeSolver::BatchedTreeSolver()
+    : m_K(0), m_Factorized(false)
+{ }
+
+pwd::BatchedTreeSolver::~BatchedTreeSolver() { }
+
+
+int pwd::BatchedTreeSolver::Size() const { return m_Tree.Size(); }
+int pwd::BatchedTreeSolver::NumSystems() const { return m_K; }
+bool pwd::BatchedTreeSolver::IsAnalyzed() const { return m_Tree.IsAnalyzed(); }
+bool pwd::BatchedTreeSolver::IsFactorized() const { return m_Factorized; }
+
+
+void pwd::BatchedTreeSolver::AnalyzePattern(const Eigen::SparseMatrix<double>& A)
+{
+    m_Factorized = false;
+    m_Tree.AnalyzePattern(A);
+    m_Upper.resize(m_Tree.Size());
+}
+
+void pwd::BatchedTreeSolver::Factorize(const Eigen::SparseMatrix<double>& A,
+                                       const pwd::RowMatrixXd& Shifts)
+{
+    Assert(m_Tree.IsAnalyzed());
+    Assert(A.rows() == m_Tree.Size());
+    Assert(Shifts.rows() == m_Tree.Size());
+    m_Factorized = false;
+
+    int n = m_Tree.Size();
+    m_K = Shifts.cols();
+    const std::vector<int>& Order = m_Tree.EliminationOrder();
+    const std::vector<int>& Parent = m_Tree.Parents();
+    const std::vector<int>& DiagIdx = m_Tree.DiagonalIndices();
+    const std::vector<int>& UpperIdx = m_Tree.UpperIndices();
+    const std::vector<int>& LowerIdx = m_Tree.LowerIndices();
+    const double* Vals = A.valuePtr();
+
+    m_Pivots = Shifts;
+    for (int k = 0; k < n; ++k)
+        m_Pivots.row(Order[k]).array() += Vals[DiagIdx[k]];
+    m_InvPivots.resize(n, m_K);
+    m_Lower.resize(n, m_K);
+
+    // Leaves-to-root elimination, for all the systems at once
+    for (int k = 0; k < n; ++k)
+    {
+        int i = Order[k];
+        Assert((m_Pivots.row(i).array() != 0.0).all());
+        m_InvPivots.row(k) = m_Pivots.row(i).cwiseInverse();
+        int p = Parent[k];
+        if (p < 0)
+        {
+            m_Lower.row(k).setZero();
+            m_Upper[k] = 0.0;
+            continue;
+        }
+        m_Lower.row(k) = Vals[LowerIdx[k]] * m_InvPivots.row(k);
+        m_Upper[k] = Vals[UpperIdx[k]];
+        m_Pivots.row(p) -= m_Upper[k] * m_Lower.row(k);
+    }
+
+    m_Factorized = true;
+}
+
+
+void pwd::BatchedTreeSolver::SolveInPlace(pwd::RowMatrixXd& X) const
+{
+    Assert(m_Factorized);
+    Assert(X.rows() == m_Tree.Size());
+    Assert(X.cols() == m_K);
+
+    int n = m_Tree.Size();
+    const std::vector<int>& Order = m_Tree.EliminationOrder();
+    const std::vector<int>& Parent = m_Tree.Parents();
+
+    // Forward substitution, from the leaves to the roots
+    for (int k = 0; k < n; ++k)
+    {
+        int p = Parent[k];
+        if (p >= 0)
+            X.row(p) -= m_Lower.row(k).cwiseProduct(X.row(Order[k]));
+    }
+
+    // Back substitution, from the roots to the leaves
+    for (int k = n - 1; k >= 0; --k)
+    {
+        int i = Order[k];
+        int p = Parent[k];
+        if (p >= 0)
+            X.row(i) = (X.row(i) - m_Upper[k] * X.row(p)).cwiseProduct(m_InvPivots.row(k));
+        else
+            X.row(i) = X.row(i).cwiseProduct(m_InvPivots.row(k));
+    }
+}
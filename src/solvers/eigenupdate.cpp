@@ -0,0 +1,184 @@
+/**
+ * @file        eigenupdate.cpp
+ * 
+ * @brief       Implements pwd::RankOneEigenUpdate().
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/eigenupdate.hpp>
+#include <numeric>
+
+
+void pwd::RankOneEigenUpdate(Eigen::VectorXd& Evals,
+                             Eigen::MatrixXd& Basis,
+                             const Eigen::VectorXd& z,
+                             double Rho)
+{
+    int n = Evals.size();
+    Assert(Basis.cols() == n);
+    Assert(z.size() == n);
+    double zNorm2 = z.squaredNorm();
+    if (Rho == 0.0 || zNorm2 == 0.0)
+        return;
+
+    // A negative update of D is a positive update of -D. The problem is normalized
+    // to a unit vector w and a positive coefficient r, with D sorted ascending.
+    double Sign = Rho > 0.0 ? 1.0 : -1.0;
+    double r = std::abs(Rho) * zNorm2;
+    std::vector<int> Perm(n);
+    std::iota(Perm.begin(), Perm.end(), 0);
+    std::sort(Perm.begin(), Perm.end(), [&](int a, int b) {
+        return Sign * Evals[a] < Sign * Evals[b];
+    });
+    Eigen::VectorXd d(n);
+    Eigen::VectorXd w(n);
+    for (int k = 0; k < n; ++k)
+    {
+        d[k] = Sign * Evals[Perm[k]];
+        w[k] = z[Perm[k]] / std::sqrt(zNorm2);
+    }
+
+    // Deflation of negligible components and of close eigenvalues
+    double Eps = std::numeric_limits<double>::epsilon();
+    double Tol = 8.0 * Eps * std::max(d.cwiseAbs().maxCoeff(), r);
+    std::vector<int> Active;
+    for (int k = 0; k < n; ++k)
+    {
+        if (r * std::abs(w[k]) <= Tol)
+            continue;
+        if (!Active.empty())
+        {
+            // A rotation moves the whole component of the previous pair on this one
+            int p = Active.back();
+            double h = std::hypot(w[p], w[k]);
+            double c = w[k] / h;
+            double s = w[p] / h;
+            if (std::abs(c * s * (d[k] - d[p])) <= Tol)
+            {
+                Eigen::VectorXd Bp = Basis.col(Perm[p]);
+                Basis.col(Perm[p]) = c * Bp - s * Basis.col(Perm[k]);
+                Basis.col(Perm[k]) = s * Bp + c * Basis.col(Perm[k]);
+                double dp = c * c * d[p] + s * s * d[k];
+                double dk = s * s * d[p] + c * c * d[k];
+                d[p] = dp;
+                d[k] = dk;
+                w[p] = 0.0;
+                w[k] = h;
+                Evals[Perm[p]] = Sign * d[p];
+                Active.pop_back();
+            }
+        }
+        Active.push_back(k);
+    }
+    int m = Active.size();
+    if (m == 0)
+        return;
+    Eigen::VectorXd dd(m);
+    Eigen::VectorXd ww(m);
+    for (int a = 0; a < m; ++a)
+    {
+        dd[a] = d[Active[a]];
+        ww[a] = w[Active[a]];
+    }
+
+    // Roots of the secular equation 1 + r * sum(w_j^2 / (d_j - x)) = 0. Each root is
+    // stored as an offset from its closest pole, to compute differences accurately.
+    std::vector<int> Origin(m);
+    Eigen::VectorXd Mu(m);
+    Eigen::VectorXd Diff(m);
+    for (int a = 0; a < m; ++a)
+    {
+        double Lo;
+        double Hi;
+        if (a < m - 1)
+        {
+            double Mid = 0.5 * (dd[a + 1] - dd[a]);
+            double f = 1.0;
+            for (int j = 0; j < m; ++j)
+                f += r * ww[j] * ww[j] / ((dd[j] - dd[a]) - Mid);
+            if (f >= 0.0)
+            {
+                Origin[a] = a;
+                Lo = 0.0;
+                Hi = Mid;
+            }
+            else
+            {
+                Origin[a] = a + 1;
+                Lo = -Mid;
+                Hi = 0.0;
+            }
+        }
+        else
+        {
+            Origin[a] = a;
+            Lo = 0.0;
+            Hi = r;
+        }
+        for (int j = 0; j < m; ++j)
+            Diff[j] = dd[j] - dd[Origin[a]];
+
+        // Newton's method, safeguarded by bisection. The function is increasing.
+        double x = 0.5 * (Lo + Hi);
+        for (int It = 0; It < 200; ++It)
+        {
+            double f = 1.0;
+            double df = 0.0;
+            double Abs = 1.0;
+            for (int j = 0; j < m; ++j)
+            {
+                double t = ww[j] / (Diff[j] - x);
+                f += r * ww[j] * t;
+                df += r * t * t;
+                Abs += std::abs(r * ww[j] * t);
+            }
+            if (f < 0.0)
+                Lo = x;
+            else
+                Hi = x;
+            if (std::abs(f) <= Eps * m * Abs)
+                break;
+            if (Hi - Lo <= 2.0 * Eps * std::max(std::abs(Lo), std::abs(Hi)))
+                break;
+            double Next = x - f / df;
+            if (!(Next > Lo && Next < Hi))
+                Next = 0.5 * (Lo + Hi);
+            x = Next;
+        }
+        Mu[a] = x;
+    }
+
+    // Gu-Eisenstat: the vector w for which the computed roots are exact
+    Eigen::VectorXd wHat(m);
+    for (int k = 0; k < m; ++k)
+    {
+        double Prod = ((dd[Origin[m - 1]] - dd[k]) + Mu[m - 1]) / r;
+        for (int j = 0; j < k; ++j)
+            Prod *= ((dd[Origin[j]] - dd[k]) + Mu[j]) / (dd[j] - dd[k]);
+        for (int j = k; j < m - 1; ++j)
+            Prod *= ((dd[Origin[j]] - dd[k]) + Mu[j]) / (dd[j + 1] - dd[k]);
+        wHat[k] = std::copysign(std::sqrt(std::max(Prod, 0.0)), ww[k]);
+    }
+
+    // Eigenvectors of the updated problem, in the basis of the active eigenvectors
+    Eigen::MatrixXd W(m, m);
+    for (int a = 0; a < m; ++a)
+    {
+        for (int k = 0; k < m; ++k)
+            W(k, a) = wHat[k] / ((dd[k] - dd[Origin[a]]) - Mu[a]);
+        W.col(a).normalize();
+    }
+    Eigen::MatrixXd Cols(Basis.rows(), m);
+    for (int a = 0; a < m; ++a)
+        Cols.col(a) = Basis.col(Perm[Active[a]]);
+    Eigen::MatrixXd NewCols = Cols * W;
+    for (int a = 0; a < m; ++a)
+    {
+        Basis.col(Perm[Active[a]]) = NewCols.col(a);
+        Evals[Perm[Active[a]]] = Sign * (dd[Origin[a]] + Mu[a]);
+    }
+}
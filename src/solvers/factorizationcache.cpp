@@ -0,0 +1,140 @@
+/**
+ * @file        factorizationcache.cpp
+ * 
+ * @brief       Implements pwd::FactorizationCache.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/factorizationcache.hpp>
+
+
+pwd::FactorizationCache::FactorizationCache(int Capacity, pwd::SolverBackend Backend)
+    : m_Backend(Backend), m_Pool(nullptr), m_Capacity(Capacity)
+{
+    Assert(Capacity >= 1);
+    m_Analysis = std::make_unique<pwd::LinearSolver>(Backend);
+}
+
+pwd::FactorizationCache::~FactorizationCache() { }
+
+
+pwd::SolverBackend pwd::FactorizationCache::GetBackend() const { return m_Backend; }
+
+void pwd::FactorizationCache::SetBackend(pwd::SolverBackend Backend)
+{
+    if (Backend == m_Backend)
+        return;
+    m_Backend = Backend;
+    Reset();
+}
+
+void pwd::FactorizationCache::SetThreadPool(pwd::ThreadPool* Pool)
+{
+    m_Pool = Pool;
+    for (auto& Solver : m_Solvers)
+        Solver->SetThreadPool(Pool);
+}
+
+int pwd::FactorizationCache::GetCapacity() const { return m_Capacity; }
+
+void pwd::FactorizationCache::SetCapacity(int Capacity)
+{
+    Assert(Capacity >= 1);
+    m_Capacity = Capacity;
+    if ((int)m_Solvers.size() > Capacity)
+    {
+        m_Keys.resize(Capacity);
+        m_Solvers.resize(Capacity);
+    }
+}
+
+int pwd::FactorizationCache::NumFactorizations() const
+{
+    int Num = 0;
+    for (int i = 0; i < (int)m_Solvers.size(); ++i)
+        Num += m_Solvers[i]->IsFactorized();
+    return Num;
+}
+
+
+pwd::LinearSolver* pwd::FactorizationCache::MoveToFront(int i)
+{
+    std::rotate(m_Keys.begin(), m_Keys.begin() + i, m_Keys.begin() + i + 1);
+    std::rotate(m_Solvers.begin(), m_Solvers.begin() + i, m_Solvers.begin() + i + 1);
+    return m_Solvers[0].get();
+}
+
+pwd::LinearSolver* pwd::FactorizationCache::Find(double& Key, double Tol)
+{
+    for (int i = 0; i < (int)m_Solvers.size(); ++i)
+    {
+        // The NaN keys of the solvers with no factorization never match
+        if (std::abs(m_Keys[i] - Key) <= Tol && m_Solvers[i]->IsFactorized())
+        {
+            Key = m_Keys[i];
+            return MoveToFront(i);
+        }
+    }
+    return nullptr;
+}
+
+const pwd::LinearSolver* pwd::FactorizationCache::Lookup(double Key) const
+{
+    for (int i = 0; i < (int)m_Solvers.size(); ++i)
+    {
+        if (m_Keys[i] == Key && m_Solvers[i]->IsFactorized())
+            return m_Solvers[i].get();
+    }
+    return nullptr;
+}
+
+pwd::LinearSolver* pwd::FactorizationCache::Insert(double Key)
+{
+    // A solver with no factorization, otherwise a new one or the least recently used
+    int NumSolvers = m_Solvers.size();
+    int i = 0;
+    while (i < NumSolvers && m_Solvers[i]->IsFactorized())
+        ++i;
+    if (i == NumSolvers && NumSolvers < m_Capacity)
+    {
+        m_Keys.push_back(Key);
+        m_Solvers.push_back(std::make_unique<pwd::LinearSolver>(m_Backend));
+        m_Solvers.back()->SetThreadPool(m_Pool);
+    }
+    else if (i == NumSolvers)
+        i = NumSolvers - 1;
+    m_Keys[i] = Key;
+    m_Solvers[i]->Clear();
+    return MoveToFront(i);
+}
+
+void pwd::FactorizationCache::Analyze(pwd::LinearSolver& Solver,
+                                      const Eigen::SparseMatrix<double>& A)
+{
+    Assert(Solver.GetBackend() == m_Backend);
+    if (!m_Analysis->IsAnalyzed())
+        m_Analysis->AnalyzePattern(A);
+    Solver.CopyAnalysis(*m_Analysis);
+}
+
+void pwd::FactorizationCache::Clear(const pwd::LinearSolver* Keep)
+{
+    for (int i = 0; i < (int)m_Solvers.size(); ++i)
+    {
+        if (m_Solvers[i].get() == Keep)
+            continue;
+        m_Keys[i] = std::numeric_limits<double>::quiet_NaN();
+        m_Solvers[i]->Clear();
+    }
+}
+
+void pwd::FactorizationCache::Reset()
+{
+    m_Keys.clear();
+    m_Solvers.clear();
+    m_Analysis = std::make_unique<pwd::LinearSolver>(m_Backend);
+}
@@ -0,0 +1,182 @@
+/**
+ * @file        krylov.cpp
+ * 
+ * @brief       Implements pwd::KrylovExponential.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/krylov.hpp>
+
+
+pwd::KrylovExponential::KrylovExponential(double Tolerance, int MaxBasis)
+    : m_Gamma(-1.0), m_NumIterations(0)
+{
+    SetTolerance(Tolerance);
+    SetMaxBasis(MaxBasis);
+}
+
+pwd::KrylovExponential::~KrylovExponential() { }
+
+
+void pwd::KrylovExponential::SetMatrix(const Eigen::SparseMatrix<double>& H)
+{
+    Assert(H.rows() == H.cols());
+    m_H = H;
+    m_Gamma = -1.0;
+}
+
+void pwd::KrylovExponential::UpdateMatrix(const Eigen::SparseMatrix<double>& H,
+                                          const std::vector<int>& Nodes)
+{
+    Assert(H.rows() == m_H.rows() && H.cols() == m_H.cols());
+    Assert(H.nonZeros() == m_H.nonZeros());
+
+    bool Shifted = m_Gamma > 0.0 && m_Shifted.nonZeros() == m_H.nonZeros();
+    for (int j : Nodes)
+    {
+        for (int Idx = m_H.outerIndexPtr()[j]; Idx < m_H.outerIndexPtr()[j + 1]; ++Idx)
+        {
+            int i = m_H.innerIndexPtr()[Idx];
+            if (std::find(Nodes.begin(), Nodes.end(), i) == Nodes.end())
+                continue;
+            m_H.valuePtr()[Idx] = H.valuePtr()[Idx];
+            if (Shifted)
+                m_Shifted.valuePtr()[Idx] = (i == j ? 1.0 : 0.0) - m_Gamma * m_H.valuePtr()[Idx];
+        }
+    }
+
+    if (Shifted)
+        m_Solver.Refactorize(m_Shifted, Nodes);
+    else
+        m_Gamma = -1.0;
+}
+
+double pwd::KrylovExponential::GetTolerance() const { return m_Tolerance; }
+void pwd::KrylovExponential::SetTolerance(double Tolerance)
+{
+    Assert(Tolerance > 0.0);
+    m_Tolerance = Tolerance;
+}
+
+int pwd::KrylovExponential::GetMaxBasis() const { return m_MaxBasis; }
+void pwd::KrylovExponential::SetMaxBasis(int MaxBasis)
+{
+    Assert(MaxBasis >= 2);
+    m_MaxBasis = MaxBasis;
+}
+
+void pwd::KrylovExponential::SetBackend(pwd::SolverBackend Backend)
+{
+    if (Backend == m_Solver.GetBackend())
+        return;
+    m_Solver.SetBackend(Backend);
+    m_Gamma = -1.0;
+}
+
+int pwd::KrylovExponential::NumIterations() const { return m_NumIterations; }
+
+
+void pwd::KrylovExponential::Factorize(double Gamma)
+{
+    if (Gamma == m_Gamma && m_Solver.IsFactorized())
+        return;
+
+    Eigen::SparseMatrix<double> Eye(m_H.rows(), m_H.cols());
+    Eye.setIdentity();
+    m_Shifted = Eye - Gamma * m_H;
+    m_Solver.Compute(m_Shifted);
+    m_Gamma = Gamma;
+}
+
+bool pwd::KrylovExponential::Step(double Tau, double Gamma, Eigen::VectorXd& w)
+{
+    double Beta0 = w.norm();
+    if (Beta0 == 0.0)
+        return true;
+
+    Factorize(Gamma);
+
+    int n = m_H.rows();
+    if (m_Basis.rows() != n || m_Basis.cols() != m_MaxBasis)
+        m_Basis.resize(n, m_MaxBasis);
+    m_Alpha.resize(m_MaxBasis);
+    m_Beta.resize(m_MaxBasis);
+
+    m_Basis.col(0) = w / Beta0;
+    Eigen::VectorXd y;
+    Eigen::VectorXd yPrev;
+    int NumConverged = 0;
+    for (int j = 0; j < m_MaxBasis; ++j)
+    {
+        m_NumIterations++;
+        Eigen::VectorXd p = m_Solver.Solve(m_Basis.col(j));
+        m_Alpha[j] = m_Basis.col(j).dot(p);
+        // Full reorthogonalization, twice is enough
+        for (int r = 0; r < 2; ++r)
+            p -= m_Basis.leftCols(j + 1) * (m_Basis.leftCols(j + 1).transpose() * p);
+        m_Beta[j] = p.norm();
+
+        // The projection T of the shifted inverse has eigenvalues theta in (0, 1],
+        // corresponding to the eigenvalues (1 - 1 / theta) / gamma of H
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> TSolver;
+        TSolver.computeFromTridiagonal(m_Alpha.head(j + 1),
+                                       m_Beta.head(j),
+                                       Eigen::ComputeEigenvectors);
+        Eigen::ArrayXd Theta = TSolver.eigenvalues().array();
+        Theta = Theta.max(std::numeric_limits<double>::min()).min(1.0);
+        Eigen::ArrayXd Mu = (1.0 - Theta.inverse()) / m_Gamma;
+        y = TSolver.eigenvectors() *
+            ((Mu * Tau).exp() * TSolver.eigenvectors().row(0).transpose().array()).matrix();
+
+        bool Breakdown = m_Beta[j] <= 1e-14;
+        if (j > 0)
+        {
+            double Err = (y.head(j) - yPrev).squaredNorm() + y[j] * y[j];
+            if (std::sqrt(Err) <= m_Tolerance * y.norm())
+                NumConverged++;
+            else
+                NumConverged = 0;
+        }
+        if (Breakdown || NumConverged == 2)
+        {
+            w.noalias() = Beta0 * (m_Basis.leftCols(j + 1) * y);
+            return true;
+        }
+        if (j + 1 < m_MaxBasis)
+            m_Basis.col(j + 1) = p / m_Beta[j];
+        yPrev = y;
+    }
+
+    return false;
+}
+
+void pwd::KrylovExponential::Apply(double Time, const Eigen::VectorXd& v, Eigen::VectorXd& Out)
+{
+    Assert(Time >= 0.0);
+    Assert(v.size() == m_H.rows());
+
+    m_NumIterations = 0;
+    Out = v;
+    // A shift proportional to the time keeps the number of iterations small. The
+    // mapped spectrum only depends on Tau / Gamma, hence the shift is kept on the
+    // shorter steps, which are smoother in the shifted inverse
+    double Gamma = 0.1 * Time;
+    double Remaining = Time;
+    double Tau = Time;
+    while (Remaining > 0.0)
+    {
+        Tau = std::min(Tau, Remaining);
+        if (!Step(Tau, Gamma, Out))
+        {
+            // Too many iterations, split the interval
+            Tau *= 0.5;
+            Assert(Tau > 0.0);
+            continue;
+        }
+        Remaining = (Tau == Remaining) ? 0.0 : Remaining - Tau;
+    }
+}
@@ -0,0 +1,201 @@
+/**
+ * @file        linearsolver.cpp
+ * 
+ * @brief       Implements pwd::LinearSolver.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/linearsolver.hpp>
+#include <pwd/utils/metrics.hpp>
+
+
+void pwd::SharedSparseLU::CopyAnalysis(const pwd::SharedSparseLU& Analyzed)
+{
+    Assert(Analyzed.m_analysisIsOk);
+    m_perm_c = Analyzed.m_perm_c;
+    m_etree = Analyzed.m_etree;
+    m_analysisIsOk = true;
+    m_factorizationIsOk = false;
+    m_isInitialized = false;
+}
+
+
+pwd::LinearSolver::LinearSolver(pwd::SolverBackend Backend)
+    : m_Backend(Backend), m_Analyzed(false), m_Factorized(false)
+{ }
+
+pwd::LinearSolver::~LinearSolver() { }
+
+
+pwd::SolverBackend pwd::LinearSolver::GetBackend() const { return m_Backend; }
+
+void pwd::LinearSolver::SetBackend(pwd::SolverBackend Backend)
+{
+    if (Backend == m_Backend)
+        return;
+    m_Backend = Backend;
+    m_Analyzed = false;
+    m_Factorized = false;
+}
+
+void pwd::LinearSolver::SetThreadPool(pwd::ThreadPool* Pool)
+{
+    m_ParallelTree.SetThreadPool(Pool);
+}
+
+
+void pwd::LinearSolver::AnalyzePattern(const Eigen::SparseMatrix<double>& A)
+{
+    pwd::PhaseTimer Timer(pwd::Phase::SymbolicFactorization);
+    m_Factorized = false;
+    switch (m_Backend)
+    {
+    case pwd::SolverBackend::SparseLU:
+        m_LU.analyzePattern(A);
+        break;
+    case pwd::SolverBackend::Tree:
+        m_Tree.AnalyzePattern(A);
+        break;
+    case pwd::SolverBackend::ParallelTree:
+        m_ParallelTree.AnalyzePattern(A);
+        break;
+    }
+    m_Analyzed = true;
+}
+
+void pwd::LinearSolver::CopyAnalysis(const pwd::LinearSolver& Analyzed)
+{
+    Assert(Analyzed.m_Analyzed);
+    Assert(Analyzed.m_Backend == m_Backend);
+    m_Factorized = false;
+    switch (m_Backend)
+    {
+    case pwd::SolverBackend::SparseLU:
+        m_LU.CopyAnalysis(Analyzed.m_LU);
+        break;
+    case pwd::SolverBackend::Tree:
+        m_Tree = Analyzed.m_Tree;
+        break;
+    case pwd::SolverBackend::ParallelTree:
+    {
+        // The analysis does not depend on the pool, which stays the one of this solver
+        pwd::ThreadPool* Pool = m_ParallelTree.GetThreadPool();
+        m_ParallelTree = Analyzed.m_ParallelTree;
+        m_ParallelTree.SetThreadPool(Pool);
+        break;
+    }
+    }
+    m_Analyzed = true;
+}
+
+void pwd::LinearSolver::Factorize(const Eigen::SparseMatrix<double>& A)
+{
+    Assert(m_Analyzed);
+    pwd::PhaseTimer Timer(pwd::Phase::NumericFactorization);
+    m_Factorized = false;
+    switch (m_Backend)
+    {
+    case pwd::SolverBackend::SparseLU:
+        m_LU.factorize(A);
+        Assert(m_LU.info() == Eigen::Success);
+        break;
+    case pwd::SolverBackend::Tree:
+        m_Tree.Factorize(A);
+        break;
+    case pwd::SolverBackend::ParallelTree:
+        m_ParallelTree.Factorize(A);
+        break;
+    }
+    m_Factorized = true;
+}
+
+void pwd::LinearSolver::Compute(const Eigen::SparseMatrix<double>& A)
+{
+    AnalyzePattern(A);
+    Factorize(A);
+}
+
+void pwd::LinearSolver::Refactorize(const Eigen::SparseMatrix<double>& A,
+                                    const std::vector<int>& Nodes)
+{
+    if (!m_Factorized)
+        return;
+    switch (m_Backend)
+    {
+    case pwd::SolverBackend::SparseLU:
+    case pwd::SolverBackend::ParallelTree:
+        Factorize(A);
+        break;
+    case pwd::SolverBackend::Tree:
+    {
+        pwd::PhaseTimer Timer(pwd::Phase::NumericFactorization);
+        m_Factorized = false;
+        m_Tree.Refactorize(A, Nodes);
+        m_Factorized = true;
+        break;
+    }
+    }
+}
+
+void pwd::LinearSolver::SaveFactorization(pwd::BinaryWriter& Writer) const
+{
+    Assert(m_Factorized);
+    Assert(m_Backend == pwd::SolverBackend::Tree);
+    m_Tree.SaveFactorization(Writer);
+}
+
+void pwd::LinearSolver::LoadFactorization(pwd::BinaryReader& Reader)
+{
+    Assert(m_Analyzed);
+    Assert(m_Backend == pwd::SolverBackend::Tree);
+    m_Factorized = false;
+    m_Tree.LoadFactorization(Reader);
+    m_Factorized = true;
+}
+
+bool pwd::LinearSolver::IsFactorized() const { return m_Factorized; }
+bool pwd::LinearSolver::IsAnalyzed() const { return m_Analyzed; }
+void pwd::LinearSolver::Clear() { m_Factorized = false; }
+
+
+Eigen::VectorXd pwd::LinearSolver::Solve(const Eigen::VectorXd& b) const
+{
+    Assert(m_Factorized);
+    pwd::PhaseTimer Timer(pwd::Phase::Solve);
+    switch (m_Backend)
+    {
+    case pwd::SolverBackend::SparseLU:
+        return m_LU.solve(b);
+    case pwd::SolverBackend::Tree:
+        return m_Tree.Solve(b);
+    case pwd::SolverBackend::ParallelTree:
+        return m_ParallelTree.Solve(b);
+    }
+    return b;
+}
+
+void pwd::LinearSolver::SolveInPlace(Eigen::Ref<Eigen::VectorXd> x) const
+{
+    Assert(m_Factorized);
+    pwd::PhaseTimer Timer(pwd::Phase::Solve);
+    switch (m_Backend)
+    {
+    case pwd::SolverBackend::SparseLU:
+        // Same steps of SparseLU::solve(), with the permutations out of place
+        m_Work.noalias() = m_LU.rowsPermutation() * x;
+        m_LU.matrixL().solveInPlace(m_Work);
+        m_LU.matrixU().solveInPlace(m_Work);
+        x.noalias() = m_LU.colsPermutation().inverse() * m_Work;
+        break;
+    case pwd::SolverBackend::Tree:
+        m_Tree.SolveInPlace(x);
+        break;
+    case pwd::SolverBackend::ParallelTree:
+        m_ParallelTree.SolveInPlace(x);
+        break;
+    }
+}
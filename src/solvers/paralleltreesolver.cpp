@@ -0,0 +1,467 @@
+/**
+ * @file        paralleltreesolver.cpp
+ * 
+ * @brief       Implements pwd::ParallelTreeSolver.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/paralleltreesolver.hpp>
+#include <pwd/utils/utils.hpp>
+#include <numeric>
+#include <queue>
+
+
+pwd::ParallelTreeSolver::ParallelTreeSolver(int NumParts)
+    : m_N(0), m_NNZ(0), m_Pool(nullptr), m_Analyzed(false), m_Factorized(false)
+{
+    Assert(NumParts > 0);
+    m_NumParts = NumParts;
+    m_TaskBeg.assign(1, 0);
+    m_DomainBeg.assign(1, 0);
+}
+
+pwd::ParallelTreeSolver::~ParallelTreeSolver() { }
+
+
+void pwd::ParallelTreeSolver::SetThreadPool(pwd::ThreadPool* Pool) { m_Pool = Pool; }
+pwd::ThreadPool* pwd::ParallelTreeSolver::GetThreadPool() const { return m_Pool; }
+
+int pwd::ParallelTreeSolver::Size() const { return m_N; }
+int pwd::ParallelTreeSolver::NumDomains() const { return m_DomainTop.size(); }
+int pwd::ParallelTreeSolver::NumJunctions() const { return m_Junctions.size(); }
+bool pwd::ParallelTreeSolver::IsAnalyzed() const { return m_Analyzed; }
+bool pwd::ParallelTreeSolver::IsFactorized() const { return m_Factorized; }
+
+
+void pwd::ParallelTreeSolver::RunTasks(const std::function<void(int)>& Body) const
+{
+    int NumTasks = m_TaskBeg.size() - 1;
+    if (m_Pool != nullptr && NumTasks > 1)
+        m_Pool->ParallelFor(0, NumTasks, Body);
+    else
+    {
+        for (int t = 0; t < NumTasks; ++t)
+            Body(t);
+    }
+}
+
+
+void pwd::ParallelTreeSolver::AnalyzePattern(const Eigen::SparseMatrix<double>& A)
+{
+    Assert(A.rows() == A.cols());
+    Assert(A.isCompressed());
+    m_Analyzed = false;
+    m_Factorized = false;
+    m_N = A.rows();
+    m_NNZ = A.nonZeros();
+
+    // The elimination forest and the entries of the tree edges come from the analysis
+    // of the sequential solver, which also checks the pattern
+    pwd::TreeSolver Tree;
+    Tree.AnalyzePattern(A);
+    const std::vector<int>& Elim = Tree.EliminationOrder();
+    const std::vector<int>& ElimParent = Tree.Parents();
+    const std::vector<int>& DiagIdx = Tree.DiagonalIndices();
+    const std::vector<int>& UpperIdx = Tree.UpperIndices();
+    const std::vector<int>& LowerIdx = Tree.LowerIndices();
+    std::vector<int> Position(m_N);
+    std::vector<int> Parent(m_N);
+    for (int k = 0; k < m_N; ++k)
+    {
+        Position[Elim[k]] = k;
+        Parent[Elim[k]] = ElimParent[k];
+    }
+
+    // Choose the junctions from the leaves to the roots. Each node collects from its
+    // children the size of the open region below it and the junction below the region,
+    // if any. A node becomes a junction when the region is large enough, or when it
+    // would reach two junctions below.
+    int Target = std::max(1, m_N / m_NumParts);
+    std::vector<int> RegionSize(m_N, 1);
+    std::vector<int> RegionLow(m_N, -1);
+    std::vector<int> NumLow(m_N, 0);
+    std::vector<bool> IsJunction(m_N, false);
+    for (int i : Elim)
+    {
+        if (NumLow[i] >= 2 || RegionSize[i] >= Target)
+            IsJunction[i] = true;
+        int p = Parent[i];
+        if (p < 0)
+            continue;
+        int Below = IsJunction[i] ? i : RegionLow[i];
+        if (!IsJunction[i])
+            RegionSize[p] += RegionSize[i];
+        if (Below >= 0)
+        {
+            RegionLow[p] = Below;
+            NumLow[p]++;
+        }
+    }
+    std::vector<int> JIndex(m_N, -1);
+    m_Junctions.clear();
+    for (int i = 0; i < m_N; ++i)
+    {
+        if (!IsJunction[i])
+            continue;
+        JIndex[i] = m_Junctions.size();
+        m_Junctions.push_back(i);
+    }
+
+    // The domains are labelled from their top node, which comes last in elimination order
+    std::vector<int> Domain(m_N, -1);
+    std::vector<int> DomTop;
+    std::vector<int> DomLow;
+    std::vector<int> DomSize;
+    for (int h = m_N - 1; h >= 0; --h)
+    {
+        int i = Elim[h];
+        if (IsJunction[i])
+            continue;
+        int p = Parent[i];
+        if (p >= 0 && !IsJunction[p])
+            Domain[i] = Domain[p];
+        else
+        {
+            Domain[i] = DomTop.size();
+            DomTop.push_back(p >= 0 ? JIndex[p] : -1);
+            DomLow.push_back(-1);
+            DomSize.push_back(0);
+        }
+        DomSize[Domain[i]]++;
+    }
+    // The nodes on the path from the junction below to the top are coupled with it
+    std::vector<bool> Carry(m_N, false);
+    for (int j : m_Junctions)
+    {
+        int p = Parent[j];
+        if (p < 0 || IsJunction[p])
+            continue;
+        Assert(DomLow[Domain[p]] < 0);
+        DomLow[Domain[p]] = JIndex[j];
+        for (int k = p; k >= 0 && !IsJunction[k]; k = Parent[k])
+            Carry[k] = true;
+    }
+
+    // Balance the domains over the tasks, largest first on the least loaded task
+    int NumDomains = DomTop.size();
+    int NumTasks = std::min(m_NumParts, NumDomains);
+    std::vector<int> BySize(NumDomains);
+    std::iota(BySize.begin(), BySize.end(), 0);
+    std::stable_sort(BySize.begin(), BySize.end(), [&](int a, int b) {
+        return DomSize[a] > DomSize[b];
+    });
+    std::priority_queue<std::pair<int64_t, int>,
+                        std::vector<std::pair<int64_t, int>>,
+                        std::greater<std::pair<int64_t, int>>> Loads;
+    for (int t = 0; t < NumTasks; ++t)
+        Loads.push({ 0, t });
+    std::vector<int> TaskOf(NumDomains);
+    for (int d : BySize)
+    {
+        std::pair<int64_t, int> Least = Loads.top();
+        Loads.pop();
+        TaskOf[d] = Least.second;
+        Loads.push({ Least.first + DomSize[d], Least.second });
+    }
+
+    // Domains are numbered by task, and their nodes are stored contiguously
+    std::vector<int> NewDomain(NumDomains);
+    std::iota(NewDomain.begin(), NewDomain.end(), 0);
+    std::stable_sort(NewDomain.begin(), NewDomain.end(), [&](int a, int b) {
+        return TaskOf[a] < TaskOf[b];
+    });
+    m_TaskBeg.assign(NumTasks + 1, 0);
+    m_DomainBeg.assign(NumDomains + 1, 0);
+    m_DomainTop.resize(NumDomains);
+    m_DomainLow.resize(NumDomains);
+    std::vector<int> Renumber(NumDomains);
+    for (int d = 0; d < NumDomains; ++d)
+    {
+        int Old = NewDomain[d];
+        Renumber[Old] = d;
+        m_TaskBeg[TaskOf[Old] + 1]++;
+        m_DomainBeg[d + 1] = m_DomainBeg[d] + DomSize[Old];
+        m_DomainTop[d] = DomTop[Old];
+        m_DomainLow[d] = DomLow[Old];
+    }
+    for (int t = 0; t < NumTasks; ++t)
+        m_TaskBeg[t + 1] += m_TaskBeg[t];
+
+    // Children before their parents inside each domain, so the top node is the last
+    int NumNodes = m_DomainBeg[NumDomains];
+    std::vector<int> Fill(m_DomainBeg.begin(), m_DomainBeg.end() - 1);
+    std::vector<int> DomainPos(m_N, -1);
+    m_Order.resize(NumNodes);
+    for (int i : Elim)
+    {
+        if (IsJunction[i])
+            continue;
+        int k = Fill[Renumber[Domain[i]]]++;
+        m_Order[k] = i;
+        DomainPos[i] = k;
+    }
+
+    // Locate the entries of the domain nodes inside the value array. The entries
+    // between a node and the junction below are the ones of the edge of the junction.
+    m_ParentPos.resize(NumNodes);
+    m_ParentNode.resize(NumNodes);
+    m_LowNode.resize(NumNodes);
+    m_DiagIdx.resize(NumNodes);
+    m_UpperIdx.resize(NumNodes);
+    m_LowerIdx.resize(NumNodes);
+    m_JUpperIdx.resize(NumNodes);
+    m_JLowerIdx.resize(NumNodes);
+    for (int d = 0; d < NumDomains; ++d)
+    {
+        for (int k = m_DomainBeg[d]; k < m_DomainBeg[d + 1]; ++k)
+        {
+            int i = m_Order[k];
+            int p = Parent[i];
+            int Low = m_DomainLow[d] >= 0 ? m_Junctions[m_DomainLow[d]] : -1;
+            m_ParentPos[k] = (p >= 0 && !IsJunction[p]) ? DomainPos[p] : -1;
+            m_ParentNode[k] = p >= 0 ? p : i;
+            m_LowNode[k] = Carry[i] ? Low : i;
+            m_DiagIdx[k] = DiagIdx[Position[i]];
+            m_UpperIdx[k] = UpperIdx[Position[i]];
+            m_LowerIdx[k] = LowerIdx[Position[i]];
+            bool AboveLow = Low >= 0 && Parent[Low] == i;
+            m_JUpperIdx[k] = AboveLow ? LowerIdx[Position[Low]] : -1;
+            m_JLowerIdx[k] = AboveLow ? UpperIdx[Position[Low]] : -1;
+        }
+    }
+
+    // The interface system couples the adjacent junctions, and the two junctions of
+    // each domain
+    int m = m_Junctions.size();
+    std::vector<Eigen::Triplet<double>> Trips;
+    std::vector<std::pair<int, int>> JEntries;
+    m_JSrcIdx.clear();
+    for (int a = 0; a < m; ++a)
+    {
+        int j = m_Junctions[a];
+        int p = Parent[j];
+        JEntries.emplace_back(a, a);
+        m_JSrcIdx.push_back(DiagIdx[Position[j]]);
+        if (p < 0 || !IsJunction[p])
+            continue;
+        JEntries.emplace_back(a, JIndex[p]);
+        m_JSrcIdx.push_back(UpperIdx[Position[j]]);
+        JEntries.emplace_back(JIndex[p], a);
+        m_JSrcIdx.push_back(LowerIdx[Position[j]]);
+    }
+    for (auto E : JEntries)
+        Trips.emplace_back(E.first, E.second, 0.0);
+    for (int d = 0; d < NumDomains; ++d)
+    {
+        if (m_DomainTop[d] < 0 || m_DomainLow[d] < 0)
+            continue;
+        Trips.emplace_back(m_DomainTop[d], m_DomainLow[d], 0.0);
+        Trips.emplace_back(m_DomainLow[d], m_DomainTop[d], 0.0);
+    }
+    m_Interface.resize(m, m);
+    m_Interface.setFromTriplets(Trips.begin(), Trips.end());
+    m_Interface.makeCompressed();
+    m_JDstIdx.resize(JEntries.size());
+    for (int e = 0; e < (int)JEntries.size(); ++e)
+        m_JDstIdx[e] = pwd::EntryIndex(m_Interface, JEntries[e].first, JEntries[e].second);
+    m_TopDiagIdx.assign(NumDomains, -1);
+    m_LowDiagIdx.assign(NumDomains, -1);
+    m_TopLowIdx.assign(NumDomains, -1);
+    m_LowTopIdx.assign(NumDomains, -1);
+    for (int d = 0; d < NumDomains; ++d)
+    {
+        int Top = m_DomainTop[d];
+        int Low = m_DomainLow[d];
+        if (Top >= 0)
+            m_TopDiagIdx[d] = pwd::EntryIndex(m_Interface, Top, Top);
+        if (Low >= 0)
+            m_LowDiagIdx[d] = pwd::EntryIndex(m_Interface, Low, Low);
+        if (Top >= 0 && Low >= 0)
+        {
+            m_TopLowIdx[d] = pwd::EntryIndex(m_Interface, Top, Low);
+            m_LowTopIdx[d] = pwd::EntryIndex(m_Interface, Low, Top);
+        }
+    }
+    if (m > 0)
+        m_InterfaceSolver.AnalyzePattern(m_Interface);
+
+    m_InvPivots.resize(NumNodes);
+    m_Lower.resize(NumNodes);
+    m_Upper.resize(NumNodes);
+    m_JLower.resize(NumNodes);
+    m_JUpper.resize(NumNodes);
+    m_Pivots.resize(NumNodes);
+    m_TopPivot.resize(NumDomains);
+    m_LowPivot.resize(NumDomains);
+    m_TopLow.resize(NumDomains);
+    m_LowTop.resize(NumDomains);
+    m_TopRhs.resize(NumDomains);
+    m_LowRhs.resize(NumDomains);
+    m_JunctionRhs.resize(m_Junctions.size());
+    m_Analyzed = true;
+}
+
+void pwd::ParallelTreeSolver::Factorize(const Eigen::SparseMatrix<double>& A)
+{
+    Assert(m_Analyzed);
+    Assert(A.rows() == m_N);
+    Assert(A.nonZeros() == m_NNZ);
+    m_Factorized = false;
+
+    // Leaves-to-top elimination of each domain. Eliminating a node updates the pivot
+    // of its parent, and the coupling of the parent with the junction below.
+    const double* Vals = A.valuePtr();
+    RunTasks([&](int t) {
+        for (int d = m_TaskBeg[t]; d < m_TaskBeg[t + 1]; ++d)
+        {
+            int Beg = m_DomainBeg[d];
+            int End = m_DomainBeg[d + 1];
+            for (int k = Beg; k < End; ++k)
+            {
+                m_Pivots[k] = Vals[m_DiagIdx[k]];
+                m_JUpper[k] = m_JUpperIdx[k] >= 0 ? Vals[m_JUpperIdx[k]] : 0.0;
+                m_JLower[k] = m_JLowerIdx[k] >= 0 ? Vals[m_JLowerIdx[k]] : 0.0;
+            }
+
+            double TopPivot = 0.0;
+            double LowPivot = 0.0;
+            double TopLow = 0.0;
+            double LowTop = 0.0;
+            for (int k = Beg; k < End; ++k)
+            {
+                Assert(m_Pivots[k] != 0.0);
+                double InvPivot = 1.0 / m_Pivots[k];
+                double Lower = m_LowerIdx[k] >= 0 ? Vals[m_LowerIdx[k]] * InvPivot : 0.0;
+                double Upper = m_UpperIdx[k] >= 0 ? Vals[m_UpperIdx[k]] : 0.0;
+                double JLower = m_JLower[k] * InvPivot;
+                double JUpper = m_JUpper[k];
+                m_InvPivots[k] = InvPivot;
+                m_Lower[k] = Lower;
+                m_Upper[k] = Upper;
+                m_JLower[k] = JLower;
+
+                int p = m_ParentPos[k];
+                if (p >= 0)
+                {
+                    m_Pivots[p] -= Lower * Upper;
+                    m_JUpper[p] -= Lower * JUpper;
+                    m_JLower[p] -= JLower * Upper;
+                }
+                else
+                {
+                    TopPivot -= Lower * Upper;
+                    TopLow -= Lower * JUpper;
+                    LowTop -= JLower * Upper;
+                }
+                LowPivot -= JLower * JUpper;
+            }
+            m_TopPivot[d] = TopPivot;
+            m_LowPivot[d] = LowPivot;
+            m_TopLow[d] = TopLow;
+            m_LowTop[d] = LowTop;
+        }
+    });
+
+    // Schur complement of the domains on the junctions
+    if (!m_Junctions.empty())
+    {
+        double* IVals = m_Interface.valuePtr();
+        std::fill(IVals, IVals + m_Interface.nonZeros(), 0.0);
+        for (int e = 0; e < (int)m_JSrcIdx.size(); ++e)
+            IVals[m_JDstIdx[e]] = Vals[m_JSrcIdx[e]];
+        for (int d = 0; d < NumDomains(); ++d)
+        {
+            if (m_TopDiagIdx[d] >= 0)
+                IVals[m_TopDiagIdx[d]] += m_TopPivot[d];
+            if (m_LowDiagIdx[d] >= 0)
+                IVals[m_LowDiagIdx[d]] += m_LowPivot[d];
+            if (m_TopLowIdx[d] >= 0)
+            {
+                IVals[m_TopLowIdx[d]] += m_TopLow[d];
+                IVals[m_LowTopIdx[d]] += m_LowTop[d];
+            }
+        }
+        m_InterfaceSolver.Factorize(m_Interface);
+    }
+
+    m_Factorized = true;
+}
+
+void pwd::ParallelTreeSolver::Compute(const Eigen::SparseMatrix<double>& A)
+{
+    AnalyzePattern(A);
+    Factorize(A);
+}
+
+
+Eigen::VectorXd pwd::ParallelTreeSolver::Solve(const Eigen::VectorXd& b) const
+{
+    Eigen::VectorXd x = b;
+    SolveInPlace(x);
+    return x;
+}
+
+void pwd::ParallelTreeSolver::SolveInPlace(Eigen::Ref<Eigen::VectorXd> x) const
+{
+    Assert(m_Factorized);
+    Assert(x.size() == m_N);
+    double* X = x.data();
+
+    // Forward substitution inside the domains, the updates of the junctions are kept
+    // apart since several domains share them. The tasks capture only two pointers,
+    // which fit in the storage of std::function without allocations
+    RunTasks([this, X](int t) {
+        for (int d = m_TaskBeg[t]; d < m_TaskBeg[t + 1]; ++d)
+        {
+            double Top = 0.0;
+            double Low = 0.0;
+            for (int k = m_DomainBeg[d]; k < m_DomainBeg[d + 1]; ++k)
+            {
+                double xk = X[m_Order[k]];
+                int p = m_ParentPos[k];
+                if (p >= 0)
+                    X[m_Order[p]] -= m_Lower[k] * xk;
+                else
+                    Top -= m_Lower[k] * xk;
+                Low -= m_JLower[k] * xk;
+            }
+            m_TopRhs[d] = Top;
+            m_LowRhs[d] = Low;
+        }
+    });
+
+    // Interface system
+    int m = m_Junctions.size();
+    if (m > 0)
+    {
+        Eigen::VectorXd& y = m_JunctionRhs;
+        for (int a = 0; a < m; ++a)
+            y[a] = X[m_Junctions[a]];
+        for (int d = 0; d < NumDomains(); ++d)
+        {
+            if (m_DomainTop[d] >= 0)
+                y[m_DomainTop[d]] += m_TopRhs[d];
+            if (m_DomainLow[d] >= 0)
+                y[m_DomainLow[d]] += m_LowRhs[d];
+        }
+        m_InterfaceSolver.SolveInPlace(y);
+        for (int a = 0; a < m; ++a)
+            X[m_Junctions[a]] = y[a];
+    }
+
+    // Back substitution inside the domains, from the top to the leaves
+    RunTasks([this, X](int t) {
+        for (int d = m_TaskBeg[t]; d < m_TaskBeg[t + 1]; ++d)
+        {
+            for (int k = m_DomainBeg[d + 1] - 1; k >= m_DomainBeg[d]; --k)
+            {
+                int i = m_Order[k];
+                X[i] = (X[i] - m_Upper[k] * X[m_ParentNode[k]] - m_JUpper[k] * X[m_LowNode[k]]) * m_InvPivots[k];
+            }
+        }
+    });
+}
@@ -0,0 +1,158 @@
+/**
+ * @file        shiftinverteig.cpp
+ * 
+ * @brief       Implements pwd::ShiftInvertEigensolver.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/shiftinverteig.hpp>
+#include <numeric>
+
+
+pwd::ShiftInvertEigensolver::ShiftInvertEigensolver(double Tolerance, int MaxRestarts)
+    : m_NumIterations(0), m_Converged(false)
+{
+    SetTolerance(Tolerance);
+    Assert(MaxRestarts > 0);
+    m_MaxRestarts = MaxRestarts;
+}
+
+pwd::ShiftInvertEigensolver::~ShiftInvertEigensolver() { }
+
+
+double pwd::ShiftInvertEigensolver::GetTolerance() const { return m_Tolerance; }
+void pwd::ShiftInvertEigensolver::SetTolerance(double Tolerance)
+{
+    Assert(Tolerance > 0.0);
+    m_Tolerance = Tolerance;
+}
+
+void pwd::ShiftInvertEigensolver::SetBackend(pwd::SolverBackend Backend)
+{
+    m_Solver.SetBackend(Backend);
+}
+
+const Eigen::VectorXd& pwd::ShiftInvertEigensolver::Eigenvalues() const { return m_Evals; }
+const Eigen::MatrixXd& pwd::ShiftInvertEigensolver::Eigenvectors() const { return m_Evecs; }
+int pwd::ShiftInvertEigensolver::NumIterations() const { return m_NumIterations; }
+bool pwd::ShiftInvertEigensolver::Converged() const { return m_Converged; }
+
+
+void pwd::ShiftInvertEigensolver::Compute(const Eigen::SparseMatrix<double>& H,
+                                          int NumModes,
+                                          double Shift)
+{
+    int n = H.rows();
+    Assert(H.cols() == n);
+    Assert(NumModes > 0 && NumModes <= n);
+
+    Eigen::SparseMatrix<double> Eye(n, n);
+    Eye.setIdentity();
+    m_Solver.Compute(H - Shift * Eye);
+
+    // Basis size, and number of Ritz vectors kept at each restart
+    int m = std::min(n, std::max(2 * NumModes, NumModes + 20));
+    int Keep = std::min(m - 1, (m + NumModes) / 2);
+    Eigen::MatrixXd V(n, m + 1);
+    Eigen::MatrixXd T = Eigen::MatrixXd::Zero(m, m);
+    Eigen::VectorXd w(n);
+    Eigen::VectorXd h;
+
+    // Deterministic start vector, touching every node
+    for (int i = 0; i < n; ++i)
+        V(i, 0) = 1.0 + 0.5 * std::sin(1.0 + i);
+    V.col(0).normalize();
+
+    m_NumIterations = 0;
+    m_Converged = false;
+    int Start = 0;
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> Ritz;
+    std::vector<int> Order(m);
+    for (int Restart = 0; Restart <= m_MaxRestarts; ++Restart)
+    {
+        // Extend the Krylov-Schur decomposition up to m vectors
+        double Beta = 0.0;
+        for (int j = Start; j < m; ++j)
+        {
+            w = m_Solver.Solve(V.col(j));
+            // Classical Gram-Schmidt, applied twice
+            h = V.leftCols(j + 1).transpose() * w;
+            w -= V.leftCols(j + 1) * h;
+            Eigen::VectorXd h2 = V.leftCols(j + 1).transpose() * w;
+            w -= V.leftCols(j + 1) * h2;
+            h += h2;
+            T.col(j).head(j + 1) = h;
+            T.row(j).head(j + 1) = h.transpose();
+            Beta = w.norm();
+            m_NumIterations++;
+
+            // An invariant subspace has been found, continue with any orthogonal vector
+            if (Beta <= 1e-14 * h.cwiseAbs().maxCoeff() && j + 1 < n)
+            {
+                for (int i = 0; i < n; ++i)
+                    w[i] = std::sin(2.0 + i * (j + 1.0));
+                for (int Pass = 0; Pass < 2; ++Pass)
+                    w -= V.leftCols(j + 1) * (V.leftCols(j + 1).transpose() * w);
+                Beta = 0.0;
+                V.col(j + 1) = w.normalized();
+                if (j + 1 < m)
+                    T(j + 1, j) = T(j, j + 1) = 0.0;
+                continue;
+            }
+            V.col(j + 1) = w / Beta;
+            if (j + 1 < m)
+                T(j + 1, j) = T(j, j + 1) = Beta;
+        }
+
+        // Ritz pairs sorted by decreasing magnitude
+        Ritz.compute(T);
+        std::iota(Order.begin(), Order.end(), 0);
+        const Eigen::VectorXd& Theta = Ritz.eigenvalues();
+        std::sort(Order.begin(), Order.end(), [&](int a, int b) {
+            return std::abs(Theta[a]) > std::abs(Theta[b]);
+        });
+
+        // The residual of a Ritz pair is Beta times the last component of its vector
+        bool Done = true;
+        for (int k = 0; k < NumModes; ++k)
+        {
+            double Res = Beta * std::abs(Ritz.eigenvectors()(m - 1, Order[k]));
+            if (Res > m_Tolerance * std::abs(Theta[Order[k]]))
+                Done = false;
+        }
+        if (Done || m == n)
+            m_Converged = true;
+        if (m_Converged || Restart == m_MaxRestarts)
+        {
+            m_Evals.resize(NumModes);
+            Eigen::MatrixXd U(m, NumModes);
+            for (int k = 0; k < NumModes; ++k)
+            {
+                // theta = 1 / (lambda - sigma)
+                m_Evals[k] = Shift + 1.0 / Theta[Order[k]];
+                U.col(k) = Ritz.eigenvectors().col(Order[k]);
+            }
+            m_Evecs.noalias() = V.leftCols(m) * U;
+            return;
+        }
+
+        // Thick restart, keeping the dominant Ritz vectors
+        Eigen::MatrixXd U(m, Keep);
+        for (int k = 0; k < Keep; ++k)
+            U.col(k) = Ritz.eigenvectors().col(Order[k]);
+        Eigen::MatrixXd Kept = V.leftCols(m) * U;
+        V.leftCols(Keep) = Kept;
+        V.col(Keep) = V.col(m);
+        T.setZero();
+        for (int k = 0; k < Keep; ++k)
+        {
+            T(k, k) = Theta[Order[k]];
+            T(Keep, k) = T(k, Keep) = Beta * U(m - 1, k);
+        }
+        Start = Keep;
+    }
+}
@@ -0,0 +1,140 @@
+/**
+ * @file        treeoperator.cpp
+ * 
+ * @brief       Implements pwd::TreeOperator.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/treeoperator.hpp>
+
+
+pwd::TreeOperator::TreeOperator() { }
+
+pwd::TreeOperator::~TreeOperator() { }
+
+
+int pwd::TreeOperator::Size() const { return m_Parent.size(); }
+const std::vector<int>& pwd::TreeOperator::Parents() const { return m_Parent; }
+
+
+void pwd::TreeOperator::Compute(const pwd::Graph* Graph,
+                                const Eigen::VectorXd& Volumes,
+                                const Eigen::VectorXd& Losses)
+{
+    CheckNull(Graph);
+    int n = Graph->NumNodes();
+    Assert(Volumes.size() == n);
+    Assert(Losses.size() == n);
+
+    // Visit each connected component breadth-first, starting from the root
+    m_Parent.assign(n, -1);
+    std::vector<int> BFSOrder;
+    BFSOrder.reserve(n);
+    int Root = n > 0 ? Graph->GetNodeID(Graph->Root()) : 0;
+    int NumEdges = 0;
+    int NumComponents = 0;
+    for (int s = 0; s < n; ++s)
+    {
+        int r = s == 0 ? Root : (s == Root ? 0 : s);
+        if (m_Parent[r] >= 0)
+            continue;
+        NumComponents++;
+        m_Parent[r] = r;
+        BFSOrder.push_back(r);
+        for (int h = BFSOrder.size() - 1; h < (int)BFSOrder.size(); ++h)
+        {
+            int i = BFSOrder[h];
+            const pwd::Node* N = Graph->GetNode(i);
+            NumEdges += N->Degree();
+            for (int a = 0; a < N->Degree(); ++a)
+            {
+                int j = Graph->GetNodeID(N->GetAdjacent(a));
+                if (m_Parent[j] >= 0)
+                    continue;
+                m_Parent[j] = i;
+                BFSOrder.push_back(j);
+            }
+        }
+    }
+    // Each edge is seen from both its endpoints
+    Assert(NumEdges == 2 * (n - NumComponents));
+
+    m_Order.clear();
+    m_Order.reserve(n - NumComponents);
+    for (int i : BFSOrder)
+    {
+        if (m_Parent[i] != i)
+            m_Order.push_back(i);
+    }
+
+    m_Conductances.setZero(n);
+    m_ParentCoeffs.setZero(n);
+    m_NodeCoeffs.setZero(n);
+    m_InvVolumes = Volumes.cwiseInverse();
+    m_Losses = Losses;
+}
+
+
+int pwd::TreeOperator::ChildOf(int i, int j) const
+{
+    Assert(i >= 0 && i < Size());
+    Assert(j >= 0 && j < Size());
+    Assert(i != j);
+    if (m_Parent[i] == j)
+        return i;
+    Assert(m_Parent[j] == i);
+    return j;
+}
+
+void pwd::TreeOperator::SetConductance(int i, int j, double Conductance)
+{
+    int k = ChildOf(i, j);
+    m_Conductances[k] = Conductance;
+    m_ParentCoeffs[k] = Conductance * m_InvVolumes[m_Parent[k]];
+    m_NodeCoeffs[k] = Conductance * m_InvVolumes[k];
+}
+
+double pwd::TreeOperator::GetConductance(int i, int j) const
+{
+    return m_Conductances[ChildOf(i, j)];
+}
+
+void pwd::TreeOperator::SetLosses(const Eigen::VectorXd& Losses)
+{
+    Assert(Losses.size() == Size());
+    m_Losses = Losses;
+}
+
+
+void pwd::TreeOperator::Apply(const Eigen::Ref<const Eigen::VectorXd>& In,
+                              Eigen::Ref<Eigen::VectorXd> Out) const
+{
+    int n = Size();
+    Assert(In.size() == n);
+    Assert(Out.size() == n);
+    Assert(In.data() + n <= Out.data() || Out.data() + n <= In.data());
+
+    const int* Parent = m_Parent.data();
+    const double* PCoeffs = m_ParentCoeffs.data();
+    const double* NCoeffs = m_NodeCoeffs.data();
+    const double* Loss = m_Losses.data();
+    const double* w = In.data();
+    double* f = Out.data();
+
+    // Flow from the parent of each node. The loop has no dependencies, and the roots
+    // have zero coefficients.
+    for (int i = 0; i < n; ++i)
+        f[i] = PCoeffs[i] * w[Parent[i]] - NCoeffs[i] * w[i];
+
+    // The flow leaves the parent. Parents are visited before their children, so the
+    // flow of a node is read before its children update it.
+    for (int i : m_Order)
+        f[Parent[i]] -= f[i];
+
+    for (int i = 0; i < n; ++i)
+        f[i] -= Loss[i] * w[i];
+}
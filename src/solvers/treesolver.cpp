@@ -0,0 +1,289 @@
+/**
+ * @file        treesolver.cpp
+ * 
+ * @brief       Implements pwd::TreeSolver.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/solvers/treesolver.hpp>
+#include <pwd/utils/utils.hpp>
+
+
+int pwd::EntryIndex(const Eigen::SparseMatrix<double>& A, int i, int j)
+{
+    const int* Beg = A.innerIndexPtr() + A.outerIndexPtr()[j];
+    const int* End = A.innerIndexPtr() + A.outerIndexPtr()[j + 1];
+    const int* It = std::lower_bound(Beg, End, i);
+    Assert(It != End && *It == i);
+    return It - A.innerIndexPtr();
+}
+
+
+pwd::TreeSolver::TreeSolver()
+    : m_N(0), m_NNZ(0), m_Analyzed(false), m_Factorized(false)
+{ }
+
+pwd::TreeSolver::~TreeSolver() { }
+
+
+int pwd::TreeSolver::Size() const { return m_N; }
+bool pwd::TreeSolver::IsAnalyzed() const { return m_Analyzed; }
+bool pwd::TreeSolver::IsFactorized() const { return m_Factorized; }
+const std::vector<int>& pwd::TreeSolver::EliminationOrder() const { return m_Order; }
+const std::vector<int>& pwd::TreeSolver::Parents() const { return m_Parent; }
+const std::vector<int>& pwd::TreeSolver::DiagonalIndices() const { return m_DiagIdx; }
+const std::vector<int>& pwd::TreeSolver::UpperIndices() const { return m_UpperIdx; }
+const std::vector<int>& pwd::TreeSolver::LowerIndices() const { return m_LowerIdx; }
+
+
+void pwd::TreeSolver::AnalyzePattern(const Eigen::SparseMatrix<double>& A)
+{
+    Assert(A.rows() == A.cols());
+    Assert(A.isCompressed());
+    m_Analyzed = false;
+    m_Factorized = false;
+    m_N = A.rows();
+    m_NNZ = A.nonZeros();
+
+    // Adjacency of the off-diagonal pattern, in compressed form
+    std::vector<int> AdjBeg(m_N + 1, 0);
+    std::vector<int> Adj;
+    Adj.reserve(m_NNZ);
+    int NumDiag = 0;
+    for (int j = 0; j < m_N; ++j)
+    {
+        AdjBeg[j] = Adj.size();
+        for (Eigen::SparseMatrix<double>::InnerIterator it(A, j); it; ++it)
+        {
+            if (it.row() == j)
+                NumDiag++;
+            else
+                Adj.push_back(it.row());
+        }
+    }
+    AdjBeg[m_N] = Adj.size();
+    // Every node needs a pivot
+    Assert(NumDiag == m_N);
+
+    // Visit each connected component breadth-first, keeping track of the parents
+    std::vector<int> NodeParent(m_N, -1);
+    std::vector<bool> Visited(m_N, false);
+    std::vector<int> BFSOrder;
+    BFSOrder.reserve(m_N);
+    int NumComponents = 0;
+    for (int r = 0; r < m_N; ++r)
+    {
+        if (Visited[r])
+            continue;
+        NumComponents++;
+        Visited[r] = true;
+        BFSOrder.push_back(r);
+        for (int h = BFSOrder.size() - 1; h < (int)BFSOrder.size(); ++h)
+        {
+            int i = BFSOrder[h];
+            for (int a = AdjBeg[i]; a < AdjBeg[i + 1]; ++a)
+            {
+                int j = Adj[a];
+                if (Visited[j])
+                    continue;
+                Visited[j] = true;
+                NodeParent[j] = i;
+                BFSOrder.push_back(j);
+            }
+        }
+    }
+    // A forest has exactly one edge less than nodes for each tree, and each
+    // edge appears twice in a structurally symmetric pattern
+    Assert((int)Adj.size() == 2 * (m_N - NumComponents));
+
+    // Children are eliminated before their parents
+    m_Order.assign(BFSOrder.rbegin(), BFSOrder.rend());
+    std::vector<int> Position(m_N);
+    for (int k = 0; k < m_N; ++k)
+        Position[m_Order[k]] = k;
+    m_Parent.resize(m_N);
+    for (int k = 0; k < m_N; ++k)
+        m_Parent[k] = NodeParent[m_Order[k]];
+    m_Position = Position;
+
+    // Children of each position, sorted in elimination order
+    m_ChildBeg.assign(m_N + 1, 0);
+    for (int k = 0; k < m_N; ++k)
+    {
+        if (m_Parent[k] >= 0)
+            m_ChildBeg[Position[m_Parent[k]] + 1]++;
+    }
+    for (int k = 0; k < m_N; ++k)
+        m_ChildBeg[k + 1] += m_ChildBeg[k];
+    m_Children.resize(m_ChildBeg[m_N]);
+    std::vector<int> Fill(m_ChildBeg.begin(), m_ChildBeg.end() - 1);
+    for (int k = 0; k < m_N; ++k)
+    {
+        if (m_Parent[k] >= 0)
+            m_Children[Fill[Position[m_Parent[k]]]++] = k;
+    }
+
+    // Locate the entries of the factorization inside the value array
+    m_DiagIdx.assign(m_N, -1);
+    m_UpperIdx.assign(m_N, -1);
+    m_LowerIdx.assign(m_N, -1);
+    for (int j = 0; j < m_N; ++j)
+    {
+        for (int Idx = A.outerIndexPtr()[j]; Idx < A.outerIndexPtr()[j + 1]; ++Idx)
+        {
+            int i = A.innerIndexPtr()[Idx];
+            if (i == j)
+                m_DiagIdx[Position[j]] = Idx;
+            else if (NodeParent[i] == j)
+                m_UpperIdx[Position[i]] = Idx;
+            else if (NodeParent[j] == i)
+                m_LowerIdx[Position[j]] = Idx;
+        }
+    }
+    // Check the pattern is structurally symmetric
+    for (int k = 0; k < m_N; ++k)
+    {
+        if (m_Parent[k] < 0)
+            continue;
+        Assert(m_UpperIdx[k] >= 0);
+        Assert(m_LowerIdx[k] >= 0);
+    }
+
+    m_InvPivots.resize(m_N);
+    m_Lower.resize(m_N);
+    m_Upper.resize(m_N);
+    m_Pivots.resize(m_N);
+    m_Analyzed = true;
+}
+
+void pwd::TreeSolver::Factorize(const Eigen::SparseMatrix<double>& A)
+{
+    Assert(m_Analyzed);
+    Assert(A.rows() == m_N);
+    Assert(A.nonZeros() == m_NNZ);
+    m_Factorized = false;
+
+    const double* Vals = A.valuePtr();
+    for (int k = 0; k < m_N; ++k)
+        m_Pivots[m_Order[k]] = Vals[m_DiagIdx[k]];
+
+    // Leaves-to-root elimination. Eliminating a node only updates its parent pivot.
+    for (int k = 0; k < m_N; ++k)
+    {
+        double Pivot = m_Pivots[m_Order[k]];
+        Assert(Pivot != 0.0);
+        m_InvPivots[k] = 1.0 / Pivot;
+        int p = m_Parent[k];
+        if (p < 0)
+        {
+            m_Lower[k] = 0.0;
+            m_Upper[k] = 0.0;
+            continue;
+        }
+        m_Lower[k] = Vals[m_LowerIdx[k]] * m_InvPivots[k];
+        m_Upper[k] = Vals[m_UpperIdx[k]];
+        m_Pivots[p] -= m_Lower[k] * m_Upper[k];
+    }
+
+    m_Factorized = true;
+}
+
+void pwd::TreeSolver::Compute(const Eigen::SparseMatrix<double>& A)
+{
+    AnalyzePattern(A);
+    Factorize(A);
+}
+
+void pwd::TreeSolver::Refactorize(const Eigen::SparseMatrix<double>& A,
+                                  const std::vector<int>& Nodes)
+{
+    Assert(m_Factorized);
+    Assert(A.rows() == m_N);
+    Assert(A.nonZeros() == m_NNZ);
+
+    // Only the pivots of the nodes and of their ancestors change
+    std::vector<int> Path;
+    for (int i : Nodes)
+    {
+        Assert(i >= 0 && i < m_N);
+        for (int k = m_Position[i]; k >= 0; k = m_Parent[k] < 0 ? -1 : m_Position[m_Parent[k]])
+            Path.push_back(k);
+    }
+    std::sort(Path.begin(), Path.end());
+    Path.erase(std::unique(Path.begin(), Path.end()), Path.end());
+
+    // Same elimination of Factorize(), children are updated before their parents
+    m_Factorized = false;
+    const double* Vals = A.valuePtr();
+    for (int k : Path)
+    {
+        double Pivot = Vals[m_DiagIdx[k]];
+        for (int c = m_ChildBeg[k]; c < m_ChildBeg[k + 1]; ++c)
+            Pivot -= m_Lower[m_Children[c]] * m_Upper[m_Children[c]];
+        Assert(Pivot != 0.0);
+        m_Pivots[m_Order[k]] = Pivot;
+        m_InvPivots[k] = 1.0 / Pivot;
+        if (m_Parent[k] >= 0)
+        {
+            m_Lower[k] = Vals[m_LowerIdx[k]] * m_InvPivots[k];
+            m_Upper[k] = Vals[m_UpperIdx[k]];
+        }
+    }
+    m_Factorized = true;
+}
+
+void pwd::TreeSolver::SaveFactorization(pwd::BinaryWriter& Writer) const
+{
+    Assert(m_Factorized);
+    Writer.WriteVector(m_InvPivots);
+    Writer.WriteVector(m_Lower);
+    Writer.WriteVector(m_Upper);
+}
+
+void pwd::TreeSolver::LoadFactorization(pwd::BinaryReader& Reader)
+{
+    Assert(m_Analyzed);
+    m_Factorized = false;
+    m_InvPivots = Reader.ReadVector();
+    m_Lower = Reader.ReadVector();
+    m_Upper = Reader.ReadVector();
+    Assert(m_InvPivots.size() == m_N && m_Lower.size() == m_N && m_Upper.size() == m_N);
+    m_Factorized = true;
+}
+
+
+Eigen::VectorXd pwd::TreeSolver::Solve(const Eigen::VectorXd& b) const
+{
+    Eigen::VectorXd x = b;
+    SolveInPlace(x);
+    return x;
+}
+
+void pwd::TreeSolver::SolveInPlace(Eigen::Ref<Eigen::VectorXd> x) const
+{
+    Assert(m_Factorized);
+    Assert(x.size() == m_N);
+
+    // Forward substitution, from the leaves to the roots
+    for (int k = 0; k < m_N; ++k)
+    {
+        int p = m_Parent[k];
+        if (p >= 0)
+            x[p] -= m_Lower[k] * x[m_Order[k]];
+    }
+
+    // Back substitution, from the roots to the leaves
+    for (int k = m_N - 1; k >= 0; --k)
+    {
+        int i = m_Order[k];
+        int p = m_Parent[k];
+        if (p >= 0)
+            x[i] = (x[i] - m_Upper[k] * x[p]) * m_InvPivots[k];
+        else
+            x[i] *= m_InvPivots[k];
+    }
+}
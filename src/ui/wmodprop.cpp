@@ -22,9 +22,15 @@ ui::WaterModelProperties::WaterModelProperties(const std::string& Name,
     m_LossRate = 3e-1;
     m_Time = 0.0;
     m_TimeStep = 0.1;
+    m_SolverStep = 0.05;
+    m_TargetRate = 60.0;
     m_Exact = false;
+    m_TreeSolver = false;
+    m_Krylov = false;
     m_IsPaused = true;
     m_IsReset = true;
+    m_IsChanged = true;
+    m_IsTimeChanged = false;
 }
 
 ui::WaterModelProperties::~WaterModelProperties() { }
@@ -34,21 +40,35 @@ double ui::WaterModelProperties::GetInitialWater() const { return m_InitialWater
 double ui::WaterModelProperties::GetLossRate() const { return m_LossRate; }
 double ui::WaterModelProperties::GetTime() const { return m_Time; }
 double ui::WaterModelProperties::GetTimeStep() const { return m_TimeStep; }
+double ui::WaterModelProperties::GetSolverStep() const { return m_SolverStep; }
+double ui::WaterModelProperties::GetTargetRate() const { return m_TargetRate; }
 bool ui::WaterModelProperties::IsExact() const { return m_Exact; }
+bool ui::WaterModelProperties::IsTreeSolver() const { return m_TreeSolver; }
+bool ui::WaterModelProperties::IsKrylov() const { return m_Krylov; }
 bool ui::WaterModelProperties::IsPaused() const { return m_IsPaused; }
 bool ui::WaterModelProperties::IsReset() const { return m_IsReset; }
+bool ui::WaterModelProperties::IsChanged() const { return m_IsChanged; }
+bool ui::WaterModelProperties::IsTimeChanged() const { return m_IsTimeChanged; }
 
 void ui::WaterModelProperties::Pause() { m_IsPaused = !m_IsPaused; }
+void ui::WaterModelProperties::SetTime(double Time) { m_Time = Time; }
 
 
 void ui::WaterModelProperties::Draw()
 {
-    ImGui::InputDouble("Initial Water", &m_InitialWater);
-    ImGui::InputDouble("Loss Rate", &m_LossRate);
-    ImGui::InputDouble("Time Step", &m_TimeStep);
-    ImGui::InputDouble("Time", &m_Time);
-    ImGui::Checkbox("Exact Solution", &m_Exact);
-    ImGui::Checkbox("Paused", &m_IsPaused);
+    // The simulation applies the parameters only when they change
+    m_IsChanged = false;
+    m_IsChanged |= ImGui::InputDouble("Initial Water", &m_InitialWater);
+    m_IsChanged |= ImGui::InputDouble("Loss Rate", &m_LossRate);
+    m_IsChanged |= ImGui::InputDouble("Time Step", &m_TimeStep);
+    m_IsChanged |= ImGui::InputDouble("Solver Step", &m_SolverStep);
+    m_IsChanged |= ImGui::InputDouble("Target Rate", &m_TargetRate);
+    m_IsTimeChanged = ImGui::InputDouble("Time", &m_Time, 0.0, 0.0, "%.6f",
+                                         ImGuiInputTextFlags_EnterReturnsTrue);
+    m_IsChanged |= ImGui::Checkbox("Exact Solution", &m_Exact);
+    m_IsChanged |= ImGui::Checkbox("Krylov Solution", &m_Krylov);
+    m_IsChanged |= ImGui::Checkbox("Tree Solver", &m_TreeSolver);
+    m_IsChanged |= ImGui::Checkbox("Paused", &m_IsPaused);
     m_IsReset = ImGui::Button("Reset");
     if (m_IsReset)
     {
@@ -59,8 +79,9 @@ void ui::WaterModelProperties::Draw()
     m_InitialWater = std::max(m_InitialWater, 0.0);
     m_LossRate = std::max(m_LossRate, 0.0);
     m_TimeStep = std::max(m_TimeStep, 0.0);
+    // Zero evaluates each frame with a single step
+    m_SolverStep = m_SolverStep < 1e-6 ? 0.0 : m_SolverStep;
+    // Zero evaluates as fast as possible
+    m_TargetRate = std::max(m_TargetRate, 0.0);
     m_Time = std::max(m_Time, 0.0);
-
-    if (!m_IsPaused)
-        m_Time += m_TimeStep;
-}
\ No newline at end of file
+}
\ No newline at end of file
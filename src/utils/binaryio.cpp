@@ -0,0 +1,130 @@
+/**
+ * @file        binaryio.cpp
+ * 
+ * @brief       Implements pwd::BinaryWriter and pwd::BinaryReader.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/utils/binaryio.hpp>
+
+
+pwd::BinaryWriter::BinaryWriter() { }
+pwd::BinaryWriter::~BinaryWriter() { }
+
+void pwd::BinaryWriter::WriteBytes(const void* Data, size_t Size)
+{
+    const char* Bytes = static_cast<const char*>(Data);
+    m_Buffer.insert(m_Buffer.end(), Bytes, Bytes + Size);
+}
+
+void pwd::BinaryWriter::WriteArray(const double* Data, int64_t Rows, int64_t Cols)
+{
+    Assert(Rows >= 0 && Cols >= 0);
+    Write(Rows);
+    Write(Cols);
+    size_t Padding = (PWD_BINARY_ALIGNMENT - m_Buffer.size() % PWD_BINARY_ALIGNMENT) % PWD_BINARY_ALIGNMENT;
+    m_Buffer.resize(m_Buffer.size() + Padding, 0);
+    if (Rows * Cols > 0)
+        WriteBytes(Data, Rows * Cols * sizeof(double));
+}
+
+void pwd::BinaryWriter::WriteVector(const Eigen::VectorXd& v)
+{
+    WriteArray(v.data(), v.rows(), 1);
+}
+
+void pwd::BinaryWriter::WriteMatrix(const Eigen::MatrixXd& M)
+{
+    WriteArray(M.data(), M.rows(), M.cols());
+}
+
+size_t pwd::BinaryWriter::Size() const { return m_Buffer.size(); }
+const char* pwd::BinaryWriter::Data() const { return m_Buffer.data(); }
+
+void pwd::BinaryWriter::Save(const std::string& Filename) const
+{
+    std::ofstream Stream;
+    Stream.open(Filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    Assert(Stream.is_open());
+    Stream.write(m_Buffer.data(), m_Buffer.size());
+    Assert(Stream.good());
+}
+
+
+pwd::BinaryReader::BinaryReader(const std::string& Filename)
+{
+    std::ifstream Stream;
+    Stream.open(Filename, std::ios::in | std::ios::binary | std::ios::ate);
+    Assert(Stream.is_open());
+    m_Size = Stream.tellg();
+    Stream.seekg(0);
+    m_Owned.resize((m_Size + sizeof(double) - 1) / sizeof(double));
+    Stream.read(reinterpret_cast<char*>(m_Owned.data()), m_Size);
+    Assert(Stream.good());
+    m_Data = reinterpret_cast<const char*>(m_Owned.data());
+    m_Offset = 0;
+}
+
+pwd::BinaryReader::BinaryReader(const void* Data, size_t Size)
+{
+    CheckNull(Data);
+    m_Data = static_cast<const char*>(Data);
+    m_Size = Size;
+    m_Offset = 0;
+}
+
+pwd::BinaryReader::~BinaryReader() { }
+
+void pwd::BinaryReader::ReadBytes(void* Data, size_t Size)
+{
+    Assert(Size <= m_Size - m_Offset);
+    std::memcpy(Data, m_Data + m_Offset, Size);
+    m_Offset += Size;
+}
+
+const double* pwd::BinaryReader::ReadArray(int64_t& Rows, int64_t& Cols)
+{
+    Rows = Read<int64_t>();
+    Cols = Read<int64_t>();
+    Assert(Rows >= 0 && Cols >= 0);
+    m_Offset += (PWD_BINARY_ALIGNMENT - m_Offset % PWD_BINARY_ALIGNMENT) % PWD_BINARY_ALIGNMENT;
+    Assert(m_Offset <= m_Size);
+    Assert((uint64_t)(Rows * Cols) <= (m_Size - m_Offset) / sizeof(double));
+    const double* Values = reinterpret_cast<const double*>(m_Data + m_Offset);
+    m_Offset += Rows * Cols * sizeof(double);
+    return Values;
+}
+
+Eigen::Map<const Eigen::VectorXd> pwd::BinaryReader::ReadVector()
+{
+    int64_t Rows, Cols;
+    const double* Values = ReadArray(Rows, Cols);
+    Assert(Cols == 1);
+    return Eigen::Map<const Eigen::VectorXd>(Values, Rows);
+}
+
+Eigen::Map<const Eigen::MatrixXd> pwd::BinaryReader::ReadMatrix()
+{
+    int64_t Rows, Cols;
+    const double* Values = ReadArray(Rows, Cols);
+    return Eigen::Map<const Eigen::MatrixXd>(Values, Rows, Cols);
+}
+
+size_t pwd::BinaryReader::Offset() const { return m_Offset; }
+size_t pwd::BinaryReader::Size() const { return m_Size; }
+
+
+uint64_t pwd::HashBytes(const void* Data, size_t Size, uint64_t Hash)
+{
+    const unsigned char* Bytes = static_cast<const unsigned char*>(Data);
+    for (size_t i = 0; i < Size; ++i)
+    {
+        Hash ^= Bytes[i];
+        Hash *= 0x100000001B3ULL;
+    }
+    return Hash;
+}
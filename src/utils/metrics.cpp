@@ -0,0 +1,98 @@
+/**
+ * @file        metrics.cpp
+ * 
+ * @brief       Implements the performance counters.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/utils/metrics.hpp>
+#include <atomic>
+#include <iomanip>
+
+
+// Counters of the phases, in nanoseconds
+static std::atomic<bool> s_Enabled(false);
+static std::atomic<uint64_t> s_Count[pwd::NumPhases];
+static std::atomic<uint64_t> s_Total[pwd::NumPhases];
+static std::atomic<uint64_t> s_Max[pwd::NumPhases];
+
+
+void pwd::EnableMetrics(bool Enabled) { s_Enabled.store(Enabled, std::memory_order_relaxed); }
+bool pwd::MetricsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+void pwd::RecordPhase(pwd::Phase Phase, std::chrono::nanoseconds Time)
+{
+    int p = static_cast<int>(Phase);
+    uint64_t ns = Time.count();
+    s_Count[p].fetch_add(1, std::memory_order_relaxed);
+    s_Total[p].fetch_add(ns, std::memory_order_relaxed);
+    uint64_t Max = s_Max[p].load(std::memory_order_relaxed);
+    while (ns > Max && !s_Max[p].compare_exchange_weak(Max, ns, std::memory_order_relaxed));
+}
+
+pwd::PhaseMetrics pwd::GetMetrics(pwd::Phase Phase)
+{
+    int p = static_cast<int>(Phase);
+    pwd::PhaseMetrics Metrics;
+    Metrics.Count = s_Count[p].load(std::memory_order_relaxed);
+    Metrics.TotalTime = 1.0e-6 * s_Total[p].load(std::memory_order_relaxed);
+    Metrics.MaxTime = 1.0e-6 * s_Max[p].load(std::memory_order_relaxed);
+    return Metrics;
+}
+
+void pwd::ResetMetrics()
+{
+    for (int p = 0; p < pwd::NumPhases; ++p)
+    {
+        s_Count[p].store(0, std::memory_order_relaxed);
+        s_Total[p].store(0, std::memory_order_relaxed);
+        s_Max[p].store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* pwd::PhaseName(pwd::Phase Phase)
+{
+    switch (Phase)
+    {
+    case pwd::Phase::GraphLoad:
+        return "Graph load";
+    case pwd::Phase::Assembly:
+        return "Assembly";
+    case pwd::Phase::SymbolicFactorization:
+        return "Symbolic factorization";
+    case pwd::Phase::NumericFactorization:
+        return "Numeric factorization";
+    case pwd::Phase::Solve:
+        return "Solve";
+    case pwd::Phase::Eigendecomposition:
+        return "Eigendecomposition";
+    case pwd::Phase::Evaluate:
+        return "Evaluate";
+    }
+    return "Unknown";
+}
+
+void pwd::PrintMetrics(std::ostream& Stream)
+{
+    Stream << std::left << std::setw(24) << "Phase" << std::right
+           << std::setw(10) << "Count"
+           << std::setw(14) << "Total (ms)"
+           << std::setw(14) << "Mean (ms)"
+           << std::setw(14) << "Max (ms)" << std::endl;
+    for (int p = 0; p < pwd::NumPhases; ++p)
+    {
+        pwd::Phase Phase = static_cast<pwd::Phase>(p);
+        pwd::PhaseMetrics Metrics = pwd::GetMetrics(Phase);
+        if (Metrics.Count == 0)
+            continue;
+        Stream << std::left << std::setw(24) << pwd::PhaseName(Phase) << std::right
+               << std::setw(10) << Metrics.Count
+               << std::setw(14) << Metrics.TotalTime
+               << std::setw(14) << (Metrics.TotalTime / Metrics.Count)
+               << std::setw(14) << Metrics.MaxTime << std::endl;
+    }
+}
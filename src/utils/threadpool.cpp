@@ -0,0 +1,228 @@
+/**
+ * @file        threadpool.cpp
+ * 
+ * @brief       Implements pwd::ThreadPool.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/utils/threadpool.hpp>
+
+
+// Pool and index of the worker running on the calling thread
+static thread_local const pwd::ThreadPool* t_Pool = nullptr;
+static thread_local int t_Worker = -1;
+
+
+pwd::ThreadPool::ThreadPool(int NumThreads)
+    : m_NumQueued(0), m_NumPending(0), m_NextQueue(0), m_Stop(false), m_Loops(nullptr)
+{
+    if (NumThreads <= 0)
+        NumThreads = std::max<int>(std::thread::hardware_concurrency(), 1);
+
+    for (int i = 0; i < NumThreads; ++i)
+        m_Queues.emplace_back(new WorkQueue());
+    for (int i = 0; i < NumThreads; ++i)
+        m_Workers.emplace_back(&pwd::ThreadPool::WorkerLoop, this, i);
+}
+
+pwd::ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_WorkCV.notify_all();
+    for (size_t i = 0; i < m_Workers.size(); ++i)
+        m_Workers[i].join();
+}
+
+
+int pwd::ThreadPool::NumThreads() const { return m_Workers.size(); }
+
+int pwd::ThreadPool::CurrentWorker() const { return t_Pool == this ? t_Worker : -1; }
+
+
+void pwd::ThreadPool::Submit(std::function<void()> Task)
+{
+    // Workers keep their own tasks, external threads spread them
+    int Worker = CurrentWorker();
+    int q = Worker >= 0 ? Worker : m_NextQueue++ % m_Queues.size();
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_NumPending++;
+    }
+    {
+        std::unique_lock<std::mutex> Lock(m_Queues[q]->Mutex);
+        m_Queues[q]->Tasks.push_back(std::move(Task));
+    }
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_NumQueued++;
+    }
+    m_WorkCV.notify_one();
+}
+
+void pwd::ThreadPool::Wait()
+{
+    Assert(CurrentWorker() < 0);
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    m_DoneCV.wait(Lock, [this]() { return m_NumPending == 0; });
+    if (m_Error)
+    {
+        std::exception_ptr Error = m_Error;
+        m_Error = nullptr;
+        std::rethrow_exception(Error);
+    }
+}
+
+void pwd::ThreadPool::ParallelFor(int Begin, int End, const std::function<void(int)>& Body)
+{
+    // A loop inside a task would wait for the workers it is holding
+    if (CurrentWorker() >= 0)
+    {
+        for (int i = Begin; i < End; ++i)
+            Body(i);
+        return;
+    }
+    if (End <= Begin)
+        return;
+
+    // The loop waits only for its own iterations, so that concurrent loops on the same
+    // pool neither wait for each other nor receive the errors of each other. Its state
+    // is on the stack and the workers join it, so that no task is allocated.
+    ParallelLoop Loop;
+    Loop.Body = &Body;
+    Loop.Next = Begin;
+    Loop.End = End;
+    Loop.NumHelpers = 0;
+    Loop.Listed = true;
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        Loop.NextLoop = m_Loops;
+        m_Loops = &Loop;
+    }
+    m_WorkCV.notify_all();
+    RunLoop(Loop);
+
+    // The loop has left the list, the workers still in it are finishing its iterations
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    m_DoneCV.wait(Lock, [&Loop]() { return Loop.NumHelpers == 0; });
+    if (Loop.Error)
+        std::rethrow_exception(Loop.Error);
+}
+
+
+bool pwd::ThreadPool::TakeTask(int Worker, std::function<void()>& Task)
+{
+    int NumQueues = m_Queues.size();
+    for (int j = 0; j < NumQueues; ++j)
+    {
+        WorkQueue& Queue = *m_Queues[(Worker + j) % NumQueues];
+        std::unique_lock<std::mutex> Lock(Queue.Mutex);
+        if (Queue.Tasks.empty())
+            continue;
+        // Newest task from the own queue, oldest task from the others
+        if (j == 0)
+        {
+            Task = std::move(Queue.Tasks.back());
+            Queue.Tasks.pop_back();
+        }
+        else
+        {
+            Task = std::move(Queue.Tasks.front());
+            Queue.Tasks.pop_front();
+        }
+        m_NumQueued--;
+        return true;
+    }
+    return false;
+}
+
+void pwd::ThreadPool::RunTask(std::function<void()>& Task)
+{
+    try
+    {
+        Task();
+    }
+    catch (...)
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        if (!m_Error)
+            m_Error = std::current_exception();
+    }
+    Task = nullptr;
+
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    if (--m_NumPending == 0)
+        m_DoneCV.notify_all();
+}
+
+void pwd::ThreadPool::RunLoop(ParallelLoop& Loop)
+{
+    for (int i = Loop.Next++; i < Loop.End; i = Loop.Next++)
+    {
+        try
+        {
+            (*Loop.Body)(i);
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            if (!Loop.Error)
+                Loop.Error = std::current_exception();
+        }
+    }
+
+    // All the iterations are claimed, no other worker has to join the loop
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+    UnlistLoop(Loop);
+}
+
+void pwd::ThreadPool::UnlistLoop(ParallelLoop& Loop)
+{
+    if (!Loop.Listed)
+        return;
+    ParallelLoop** Link = &m_Loops;
+    while (*Link != &Loop)
+        Link = &(*Link)->NextLoop;
+    *Link = Loop.NextLoop;
+    Loop.Listed = false;
+}
+
+void pwd::ThreadPool::WorkerLoop(int Worker)
+{
+    t_Pool = this;
+    t_Worker = Worker;
+
+    std::function<void()> Task;
+    while (true)
+    {
+        if (TakeTask(Worker, Task))
+        {
+            RunTask(Task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        if (m_Loops != nullptr)
+        {
+            // Help the most recent loop, its caller waits for the worker to leave it
+            ParallelLoop* Loop = m_Loops;
+            Loop->NumHelpers++;
+            Lock.unlock();
+            RunLoop(*Loop);
+            Lock.lock();
+            if (--Loop->NumHelpers == 0)
+                m_DoneCV.notify_all();
+            continue;
+        }
+        m_WorkCV.wait(Lock, [this]() { return m_Stop || m_NumQueued > 0 || m_Loops != nullptr; });
+        if (m_Stop && m_NumQueued == 0)
+            return;
+    }
+}
@@ -0,0 +1,274 @@
+/**
+ * @file        basicwatermodel.cpp
+ * 
+ * @brief       Implements pwd::BasicWaterModel.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/basicwatermodel.hpp>
+#include <type_traits>
+
+
+#define MODE_PANEL              32
+
+
+// Coefficients below the precision of the accumulation would only produce subnormal numbers
+template<typename Derived>
+static void DropDecayedModes(Eigen::MatrixBase<Derived>& Coeffs)
+{
+    typedef typename Derived::Scalar T;
+    T Eps = std::numeric_limits<T>::epsilon();
+    for (int j = 0; j < Coeffs.cols(); ++j)
+    {
+        T Cutoff = Eps * Eps * Coeffs.col(j).cwiseAbs().maxCoeff();
+        Coeffs.col(j) = (Coeffs.col(j).array().abs() < Cutoff).select(T(0), Coeffs.col(j));
+    }
+}
+
+
+template<typename Scalar, typename AccumScalar>
+pwd::BasicWaterModel<Scalar, AccumScalar>::BasicWaterModel(const pwd::Graph* Graph,
+                                                           double LossRate,
+                                                           double InitialWater)
+    : m_Model(Graph, LossRate, InitialWater)
+{
+    Reset();
+}
+
+template<typename Scalar, typename AccumScalar>
+pwd::BasicWaterModel<Scalar, AccumScalar>::BasicWaterModel(const pwd::Graph* Graph,
+                                                           const Eigen::VectorXd& LossRates,
+                                                           double InitialWater,
+                                                           const std::vector<std::pair<int, int>>& DeadEdges)
+    : m_Model(Graph, LossRates, InitialWater, DeadEdges)
+{
+    Reset();
+}
+
+template<typename Scalar, typename AccumScalar>
+pwd::BasicWaterModel<Scalar, AccumScalar>::~BasicWaterModel() { }
+
+
+template<typename Scalar, typename AccumScalar>
+const typename pwd::BasicWaterModel<Scalar, AccumScalar>::VectorType&
+pwd::BasicWaterModel<Scalar, AccumScalar>::Water() const
+{
+    return m_Model.NodeIDs().empty() ? m_Water : m_InputWater;
+}
+
+template<typename Scalar, typename AccumScalar>
+Scalar pwd::BasicWaterModel<Scalar, AccumScalar>::Water(int i) const { return m_Water[m_Model.NodeID(i)]; }
+
+template<typename Scalar, typename AccumScalar>
+double pwd::BasicWaterModel<Scalar, AccumScalar>::LastEvaluationTime() const { return m_LastTime; }
+
+template<typename Scalar, typename AccumScalar>
+pwd::EvaluationMode pwd::BasicWaterModel<Scalar, AccumScalar>::GetEvaluationMode() const { return m_Mode; }
+
+template<typename Scalar, typename AccumScalar>
+pwd::SolverBackend pwd::BasicWaterModel<Scalar, AccumScalar>::GetSolverBackend() const
+{
+    return m_Model.GetSolverBackend();
+}
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::SetSolverBackend(pwd::SolverBackend Backend)
+{
+    m_Model.SetSolverBackend(Backend);
+}
+
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::Reset()
+{
+    m_Mode = m_Model.GetEvaluationMode();
+    Assert(m_Mode == pwd::EvaluationMode::Stepping || m_Mode == pwd::EvaluationMode::Spectral);
+    if (m_Mode == pwd::EvaluationMode::Spectral)
+    {
+        // The eigenvectors in double precision are not read anymore, only one copy is kept
+        if constexpr (std::is_same<Scalar, double>::value)
+            m_Model.ReleaseEigenvectors(m_Evecs);
+        else
+        {
+            Eigen::MatrixXd Evecs;
+            m_Model.ReleaseEigenvectors(Evecs);
+            m_Evecs = Evecs.template cast<Scalar>();
+        }
+        m_Evals = m_Model.Eigenvalues().template cast<AccumScalar>();
+        m_Xi = m_Model.SpectralCoefficients().template cast<AccumScalar>();
+    }
+
+    m_Water = m_Model.GraphWater0().template cast<Scalar>();
+    UpdateInputWater();
+    m_LastTime = 0.0;
+    m_Spt.resize(m_Water.rows(), 6);
+    m_SptHead = 0;
+    m_DT = 0.0;
+}
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::Build()
+{
+    m_Model.Build();
+    Reset();
+}
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::Build(int NumModes, double Tolerance)
+{
+    m_Model.Build(NumModes, Tolerance);
+    Reset();
+}
+
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::Evaluate(double Time)
+{
+    Assert(Time >= 0.0);
+    pwd::PhaseTimer Timer(pwd::Phase::Evaluate);
+
+    if (m_Mode == pwd::EvaluationMode::Stepping)
+        Step(Time);
+    else if (Time < m_Model.SpectralTime())
+    {
+        // The truncated modes are not accurate yet, the inner model steps
+        m_Model.Propagate(Time);
+        m_Water = m_Model.GraphWater().template cast<Scalar>();
+        m_LastTime = Time;
+    }
+    else
+    {
+        EvaluateSpectral(Time, m_Water);
+        m_LastTime = Time;
+    }
+    UpdateInputWater();
+}
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::EvaluateSpectral(double Time, Eigen::Ref<VectorType> Out)
+{
+    AccumScalar Elapsed = Time - m_Model.StartTime();
+    m_Xi2 = m_Xi.cwiseProduct((m_Evals * Elapsed).array().exp().matrix());
+    DropDecayedModes(m_Xi2);
+    CombineModes(m_Xi2, Out);
+}
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::CombineModes(const Eigen::Ref<const AccumMatrixType>& Coeffs,
+                                                             Eigen::Ref<MatrixType> Out)
+{
+    if constexpr (std::is_same<Scalar, AccumScalar>::value)
+        Out.noalias() = m_Evecs * Coeffs;
+    else
+    {
+        // The eigenvectors are read in the stored type and multiplied in the accumulation type
+        int NumModes = m_Evecs.cols();
+        m_Accum.setZero(m_Evecs.rows(), Coeffs.cols());
+        for (int j = 0; j < NumModes; j += MODE_PANEL)
+        {
+            int Width = std::min(MODE_PANEL, NumModes - j);
+            m_Panel = m_Evecs.middleCols(j, Width).template cast<AccumScalar>();
+            m_Accum.noalias() += m_Panel * Coeffs.middleRows(j, Width);
+        }
+        Out = m_Accum.template cast<Scalar>();
+    }
+}
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::EvaluateMany(const std::vector<double>& Times,
+                                                             Eigen::Ref<MatrixType> Out)
+{
+    int NumTimes = Times.size();
+    Assert(Out.rows() == m_Water.rows());
+    Assert(Out.cols() == NumTimes);
+    for (int j = 0; j < NumTimes; ++j)
+    {
+        Assert(Times[j] >= 0.0);
+        Assert(j == 0 || Times[j] >= Times[j - 1]);
+    }
+
+    // Time points evaluated one at a time, see pwd::WaterModel::EvaluateMany()
+    int First = NumTimes;
+    if (m_Mode == pwd::EvaluationMode::Spectral)
+    {
+        First = 0;
+        while (First < NumTimes && Times[First] < m_Model.SpectralTime())
+            ++First;
+    }
+    for (int j = 0; j < First; ++j)
+    {
+        Evaluate(Times[j]);
+        Out.col(j) = m_Water;
+    }
+    if (First < NumTimes)
+    {
+        // All the time points with a single matrix product
+        int Count = NumTimes - First;
+        Eigen::Map<const Eigen::RowVectorXd> Elapsed(Times.data() + First, Count);
+        m_ModeCoeffs.resize(m_Evals.rows(), Count);
+        m_ModeCoeffs.noalias() = m_Evals * (Elapsed.array() - m_Model.StartTime()).matrix().template cast<AccumScalar>();
+        m_ModeCoeffs = m_ModeCoeffs.array().exp().colwise() * m_Xi.array();
+        DropDecayedModes(m_ModeCoeffs);
+        CombineModes(m_ModeCoeffs, Out.rightCols(Count));
+
+        m_LastTime = Times.back();
+        m_Water = Out.col(NumTimes - 1);
+        UpdateInputWater();
+    }
+
+    // The rows are moved to the input order at once
+    if (!m_Model.NodeIDs().empty() && NumTimes > 0)
+    {
+        m_Permuted.resize(Out.rows(), Out.cols());
+        m_Permuted.noalias() = Out(m_Model.NodeIDs(), Eigen::all);
+        Out = m_Permuted;
+    }
+}
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::UpdateInputWater()
+{
+    if (!m_Model.NodeIDs().empty())
+        m_InputWater = m_Water(m_Model.NodeIDs());
+}
+
+template<typename Scalar, typename AccumScalar>
+void pwd::BasicWaterModel<Scalar, AccumScalar>::Step(double Time)
+{
+    double dt = Time - m_LastTime;
+    if (dt < 1e-7)
+        return;
+
+    // BDF6, with the same restarts of pwd::WaterModel
+    bool NewStep = std::abs(dt - m_DT) > 1e-7;
+    if (NewStep)
+    {
+        m_DT = dt;
+        for (int i = 0; i < 6; ++i)
+            m_Spt.col(i) = m_Water;
+        m_SptHead = 0;
+    }
+    // The factorizations of the inner model are reused, they are updated in place
+    pwd::LinearSolver& Solver = m_Model.StepSolver(m_DT);
+
+    // The combination of the history is accumulated, the system is solved in double
+    Scalar* History[6];
+    for (int i = 0; i < 6; ++i)
+        History[i] = m_Spt.col((m_SptHead + i) % 6).data();
+    m_StepRhs.resize(m_Water.rows());
+    pwd::BDFRhs<AccumScalar>(m_Spt.cols(), History, m_Water.data(), m_StepRhs.data(), m_Water.rows());
+    m_SptHead = (m_SptHead + 1) % 6;
+    Solver.SolveInPlace(m_StepRhs);
+    m_Water = m_StepRhs.template cast<Scalar>();
+
+    m_LastTime = Time;
+}
+
+
+template class pwd::BasicWaterModel<float, float>;
+template class pwd::BasicWaterModel<float, double>;
+template class pwd::BasicWaterModel<double, double>;
@@ -0,0 +1,164 @@
+/**
+ * @file        ensemble.cpp
+ * 
+ * @brief       Implements pwd::Ensemble.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/ensemble.hpp>
+
+
+pwd::Ensemble::Ensemble(const pwd::Graph* Graph,
+                        const std::vector<double>& LossRates,
+                        double InitialWater)
+    : m_Graph(Graph), m_Head(0), m_DT(0.0), m_LastTime(0.0)
+{
+    CheckNull(m_Graph);
+    Assert(!LossRates.empty());
+
+    int n = m_Graph->NumNodes();
+    int K = LossRates.size();
+    pwd::RowMatrixXd Rates(n, K);
+    for (int i = 0; i < n; ++i)
+    {
+        bool IsLeaf = m_Graph->GetNode(i)->IsOnLeaf();
+        for (int k = 0; k < K; ++k)
+            Rates(m_Graph->InputID(i), k) = IsLeaf ? LossRates[k] : 0.0;
+    }
+    Initialize(Rates, Eigen::VectorXd::Constant(K, InitialWater), { });
+}
+
+pwd::Ensemble::Ensemble(const pwd::Graph* Graph,
+                        const pwd::RowMatrixXd& LossRates,
+                        const Eigen::VectorXd& InitialWater,
+                        const std::vector<std::pair<int, int>>& DeadEdges)
+    : m_Graph(Graph), m_Head(0), m_DT(0.0), m_LastTime(0.0)
+{
+    CheckNull(m_Graph);
+    Initialize(LossRates, InitialWater, DeadEdges);
+}
+
+pwd::Ensemble::~Ensemble() { }
+
+
+const pwd::Graph* pwd::Ensemble::GetGraph() const { return m_Graph; }
+int pwd::Ensemble::NumMembers() const { return m_Water.cols(); }
+
+const pwd::RowMatrixXd& pwd::Ensemble::Water0() const { return m_NodeIDs.empty() ? m_Water0 : m_InputWater0; }
+const pwd::RowMatrixXd& pwd::Ensemble::Water() const { return m_NodeIDs.empty() ? m_Water : m_InputWater; }
+
+double pwd::Ensemble::Water(int i, int k) const
+{
+    Assert(i >= 0 && i < m_Graph->NumNodes());
+    return m_Water(m_NodeIDs.empty() ? i : m_NodeIDs[i], k);
+}
+
+double pwd::Ensemble::LastEvaluationTime() const { return m_LastTime; }
+
+
+void pwd::Ensemble::Initialize(const pwd::RowMatrixXd& LossRates,
+                               const Eigen::VectorXd& InitialWater,
+                               const std::vector<std::pair<int, int>>& DeadEdges)
+{
+    int n = m_Graph->NumNodes();
+    Assert(LossRates.rows() == n);
+    Assert(LossRates.cols() > 0);
+    Assert(InitialWater.size() == LossRates.cols());
+
+    // The loss-free model holds the part of the system shared by all the members
+    pwd::WaterModel Shared(m_Graph, Eigen::VectorXd::Zero(n), 1.0, DeadEdges);
+    m_S = Shared.SystemMatrix();
+
+    // The members are stored in the order of the graph, as the shared system
+    std::vector<int> InputIDs;
+    m_NodeIDs.clear();
+    if (m_Graph->GetOrdering() != pwd::NodeOrdering::Input)
+    {
+        InputIDs.resize(n);
+        m_NodeIDs.resize(n);
+        for (int i = 0; i < n; ++i)
+        {
+            InputIDs[i] = m_Graph->InputID(i);
+            m_NodeIDs[i] = m_Graph->NodeID(i);
+        }
+    }
+
+    // The diagonal of S is always in the pattern, the step matrix shares it
+    m_DiagIdx.resize(n);
+    for (int i = 0; i < n; ++i)
+        m_DiagIdx[i] = EntryIndex(m_S, i, i);
+    m_StepMatrix = m_S;
+
+    Eigen::VectorXd Areas(n);
+    for (int i = 0; i < n; ++i)
+        Areas[i] = m_Graph->GetNode(i)->Area();
+    if (InputIDs.empty())
+    {
+        m_Losses = LossRates.array().colwise() * Areas.array();
+        m_Water0 = Shared.Water0() * InitialWater.transpose();
+    }
+    else
+    {
+        m_Losses = LossRates(InputIDs, Eigen::all).array().colwise() * Areas.array();
+        m_Water0 = Shared.Water0()(InputIDs) * InitialWater.transpose();
+        m_InputWater0 = m_Water0(m_NodeIDs, Eigen::all);
+        m_InputWater = m_InputWater0;
+    }
+    m_Water = m_Water0;
+    for (int i = 0; i < 6; ++i)
+        m_History[i].setZero(n, LossRates.cols());
+    m_Head = 0;
+
+    m_Solver.AnalyzePattern(m_StepMatrix);
+    m_DT = 0.0;
+    m_LastTime = 0.0;
+}
+
+
+void pwd::Ensemble::Evaluate(double Time)
+{
+    Assert(Time >= 0.0);
+    pwd::PhaseTimer Timer(pwd::Phase::Evaluate);
+    // Same BDF6 scheme of pwd::WaterModel
+    static const double Alpha = pwd::BDFCoefficients<6>::Alpha;
+
+    double dt = Time - m_LastTime;
+    if (dt < 1e-7)
+        return;
+
+    bool NewStep = std::abs(dt - m_DT) > 1e-7;
+    if (NewStep)
+    {
+        m_DT = dt;
+        for (int i = 0; i < 6; ++i)
+            m_History[i] = m_Water;
+    }
+    if (NewStep || !m_Solver.IsFactorized())
+    {
+        // I - Alpha * DT * (S - diag(Losses)), where only the diagonal is per member
+        const double* Vals = m_S.valuePtr();
+        double* StepVals = m_StepMatrix.valuePtr();
+        for (int k = 0; k < m_S.nonZeros(); ++k)
+            StepVals[k] = -Alpha * m_DT * Vals[k];
+        for (int i = 0; i < m_S.cols(); ++i)
+            StepVals[m_DiagIdx[i]] += 1.0;
+        m_Solver.Factorize(m_StepMatrix, Alpha * m_DT * m_Losses);
+    }
+
+    // The oldest step is replaced by the current one, which is overwritten by the
+    // right-hand side in the same pass
+    double* H[6];
+    for (int j = 0; j < 6; ++j)
+        H[j] = m_History[(m_Head + j) % 6].data();
+    pwd::BDFRhs<double>(6, H, m_Water.data(), m_Water.data(), m_Water.size());
+    m_Head = (m_Head + 1) % 6;
+    m_Solver.SolveInPlace(m_Water);
+    if (!m_NodeIDs.empty())
+        m_InputWater = m_Water(m_NodeIDs, Eigen::all);
+
+    m_LastTime = Time;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file        lossschedule.cpp
+ * 
+ * @brief       Implements pwd::LossSchedule.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/lossschedule.hpp>
+#include <pwd/utils/binaryio.hpp>
+
+
+pwd::LossSchedule::LossSchedule() { }
+
+pwd::LossSchedule::~LossSchedule() { }
+
+
+void pwd::LossSchedule::AddSegment(double Duration, const Eigen::VectorXd& LossRates)
+{
+    Assert(Duration > 0.0);
+    Assert(m_LossRates.empty() || LossRates.size() == m_LossRates[0].size());
+    m_Ends.push_back(Period() + Duration);
+    m_LossRates.push_back(LossRates);
+}
+
+int pwd::LossSchedule::NumSegments() const { return m_Ends.size(); }
+double pwd::LossSchedule::Period() const { return m_Ends.empty() ? 0.0 : m_Ends.back(); }
+
+double pwd::LossSchedule::Duration(int i) const
+{
+    Assert(i >= 0 && i < NumSegments());
+    return i == 0 ? m_Ends[0] : m_Ends[i] - m_Ends[i - 1];
+}
+
+const Eigen::VectorXd& pwd::LossSchedule::LossRates(int i) const
+{
+    Assert(i >= 0 && i < NumSegments());
+    return m_LossRates[i];
+}
+
+int pwd::LossSchedule::SegmentAt(double Time) const
+{
+    Assert(NumSegments() > 0);
+    Assert(Time >= 0.0);
+    double Phase = std::fmod(Time, Period());
+    // The first segment ending after the phase, the rounding of fmod may reach the end
+    int i = std::upper_bound(m_Ends.begin(), m_Ends.end(), Phase) - m_Ends.begin();
+    return i < NumSegments() ? i : 0;
+}
+
+
+void pwd::LossSchedule::Save(pwd::BinaryWriter& Writer) const
+{
+    Writer.WriteArray(m_Ends.data(), m_Ends.size(), 1);
+    for (const Eigen::VectorXd& LossRates : m_LossRates)
+        Writer.WriteVector(LossRates);
+}
+
+void pwd::LossSchedule::Load(pwd::BinaryReader& Reader)
+{
+    Eigen::Map<const Eigen::VectorXd> Ends = Reader.ReadVector();
+    m_Ends.assign(Ends.data(), Ends.data() + Ends.size());
+    m_LossRates.clear();
+    for (int i = 0; i < NumSegments(); ++i)
+    {
+        Assert(m_Ends[i] > (i == 0 ? 0.0 : m_Ends[i - 1]));
+        m_LossRates.push_back(Reader.ReadVector());
+        Assert(m_LossRates[i].size() == m_LossRates[0].size());
+    }
+}
@@ -0,0 +1,154 @@
+/**
+ * @file        simulationworker.cpp
+ * 
+ * @brief       Implements pwd::SimulationWorker.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/simulationworker.hpp>
+#include <chrono>
+
+
+pwd::SimulationWorker::SimulationWorker(const pwd::Graph* Graph,
+                                        double LossRate,
+                                        double InitialWater)
+    : m_Model(Graph, LossRate, InitialWater),
+      m_States({ m_Model.Water(), m_Model.LastEvaluationTime(), 0, 0.0 }),
+      m_NumEvaluations(0), m_EvaluationTime(0.0),
+      m_TimeStep(0.0), m_TargetRate(0.0), m_IsPaused(true), m_Stop(false)
+{
+    m_Worker = std::thread(&pwd::SimulationWorker::WorkerLoop, this);
+}
+
+pwd::SimulationWorker::~SimulationWorker()
+{
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_CommandCV.notify_all();
+    m_Worker.join();
+}
+
+
+void pwd::SimulationWorker::Submit(std::function<void(pwd::WaterModel&)> Command)
+{
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        m_Commands.push_back(std::move(Command));
+    }
+    m_CommandCV.notify_one();
+}
+
+void pwd::SimulationWorker::SetPaused(bool Paused)
+{
+    Submit([this, Paused](pwd::WaterModel&) { m_IsPaused = Paused; });
+}
+
+void pwd::SimulationWorker::SetTimeStep(double TimeStep)
+{
+    Assert(TimeStep >= 0.0);
+    Submit([this, TimeStep](pwd::WaterModel&) { m_TimeStep = TimeStep; });
+}
+
+void pwd::SimulationWorker::SetTargetRate(double Rate)
+{
+    Assert(Rate >= 0.0);
+    Submit([this, Rate](pwd::WaterModel&) { m_TargetRate = Rate; });
+}
+
+void pwd::SimulationWorker::SetTime(double Time)
+{
+    Submit([Time](pwd::WaterModel& Model) { Model.Evaluate(Time); });
+}
+
+
+bool pwd::SimulationWorker::Update()
+{
+    {
+        std::unique_lock<std::mutex> Lock(m_Mutex);
+        if (m_Error)
+        {
+            std::exception_ptr Error = m_Error;
+            m_Error = nullptr;
+            std::rethrow_exception(Error);
+        }
+    }
+    return m_States.Update();
+}
+
+const pwd::SimulationState& pwd::SimulationWorker::State() const { return m_States.ReadBuffer(); }
+
+
+void pwd::SimulationWorker::Publish()
+{
+    // The copy reuses the memory of the state published two times before
+    pwd::SimulationState& State = m_States.WriteBuffer();
+    State.Water = m_Model.Water();
+    State.Time = m_Model.LastEvaluationTime();
+    State.NumEvaluations = m_NumEvaluations;
+    State.EvaluationTime = m_EvaluationTime;
+    m_States.Publish();
+}
+
+void pwd::SimulationWorker::WorkerLoop()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::deque<std::function<void(pwd::WaterModel&)>> Commands;
+    Clock::time_point Next = Clock::now();
+    while (true)
+    {
+        {
+            // Wait for a command while paused, or for the next evaluation at the target rate
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            auto HasWork = [this]() { return m_Stop || !m_Commands.empty(); };
+            if (m_IsPaused || m_TimeStep <= 0.0)
+                m_CommandCV.wait(Lock, HasWork);
+            else if (m_TargetRate > 0.0)
+                m_CommandCV.wait_until(Lock, Next, HasWork);
+            if (m_Stop)
+                return;
+            Commands.swap(m_Commands);
+        }
+
+        try
+        {
+            bool Changed = !Commands.empty();
+            while (!Commands.empty())
+            {
+                Commands.front()(m_Model);
+                Commands.pop_front();
+            }
+
+            Clock::time_point Start = Clock::now();
+            if (!m_IsPaused && m_TimeStep > 0.0 && (m_TargetRate <= 0.0 || Start >= Next))
+            {
+                m_Model.Evaluate(m_Model.LastEvaluationTime() + m_TimeStep);
+                Clock::duration ETA = Clock::now() - Start;
+                m_EvaluationTime += 1.0e-3 * std::chrono::duration_cast<std::chrono::microseconds>(ETA).count();
+                m_NumEvaluations++;
+                Changed = true;
+
+                // Late evaluations delay the next ones instead of bursting to catch up
+                if (m_TargetRate > 0.0)
+                    Next = std::max(Next, Start) +
+                           std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_TargetRate));
+            }
+            if (Changed)
+                Publish();
+        }
+        catch (...)
+        {
+            Commands.clear();
+            m_IsPaused = true;
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            if (!m_Error)
+                m_Error = std::current_exception();
+        }
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * @file        sourceprofile.cpp
+ * 
+ * @brief       Implements pwd::SourceProfile.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/sourceprofile.hpp>
+#include <pwd/utils/binaryio.hpp>
+
+
+pwd::SourceProfile::SourceProfile(pwd::Interpolation Interp)
+    : m_Interp(Interp) { }
+
+pwd::SourceProfile::~SourceProfile() { }
+
+
+void pwd::SourceProfile::AddKnot(double Time, const Eigen::VectorXd& Inflow)
+{
+    Assert(m_Times.empty() || Time > m_Times.back());
+    Assert(m_Times.empty() || Inflow.size() == m_Values.rows());
+    m_Times.push_back(Time);
+    m_Values.conservativeResize(Inflow.size(), m_Times.size());
+    m_Values.col(m_Times.size() - 1) = Inflow;
+}
+
+pwd::Interpolation pwd::SourceProfile::GetInterpolation() const { return m_Interp; }
+int pwd::SourceProfile::NumKnots() const { return m_Times.size(); }
+int pwd::SourceProfile::Size() const { return m_Values.rows(); }
+const Eigen::MatrixXd& pwd::SourceProfile::Values() const { return m_Values; }
+
+double pwd::SourceProfile::Time(int k) const
+{
+    Assert(k >= 0 && k < NumKnots());
+    return m_Times[k];
+}
+
+
+void pwd::SourceProfile::Inflow(double Time, Eigen::Ref<Eigen::VectorXd> Out) const
+{
+    Assert(Out.size() == Size());
+    // The last knot not after the time point
+    int k = std::upper_bound(m_Times.begin(), m_Times.end(), Time) - m_Times.begin() - 1;
+    if (k < 0)
+        Out.setZero();
+    else if (m_Interp == pwd::Interpolation::Constant || k == NumKnots() - 1)
+        Out = m_Values.col(k);
+    else
+    {
+        double x = (Time - m_Times[k]) / (m_Times[k + 1] - m_Times[k]);
+        Out = (1.0 - x) * m_Values.col(k) + x * m_Values.col(k + 1);
+    }
+}
+
+double pwd::SourceProfile::Inflow(double Time, int i) const
+{
+    Assert(i >= 0 && i < Size());
+    int k = std::upper_bound(m_Times.begin(), m_Times.end(), Time) - m_Times.begin() - 1;
+    if (k < 0)
+        return 0.0;
+    if (m_Interp == pwd::Interpolation::Constant || k == NumKnots() - 1)
+        return m_Values(i, k);
+    double x = (Time - m_Times[k]) / (m_Times[k + 1] - m_Times[k]);
+    return (1.0 - x) * m_Values(i, k) + x * m_Values(i, k + 1);
+}
+
+
+void pwd::SourceProfile::Save(pwd::BinaryWriter& Writer) const
+{
+    Writer.Write<int32_t>((int32_t)m_Interp);
+    Writer.WriteArray(m_Times.data(), m_Times.size(), 1);
+    Writer.WriteMatrix(m_Values);
+}
+
+void pwd::SourceProfile::Load(pwd::BinaryReader& Reader)
+{
+    int32_t Interp = Reader.Read<int32_t>();
+    Assert(Interp == (int32_t)pwd::Interpolation::Constant || Interp == (int32_t)pwd::Interpolation::Linear);
+    Eigen::Map<const Eigen::VectorXd> Times = Reader.ReadVector();
+    m_Interp = (pwd::Interpolation)Interp;
+    m_Times.assign(Times.data(), Times.data() + Times.size());
+    m_Values = Reader.ReadMatrix();
+    Assert(m_Values.cols() == NumKnots());
+    for (int k = 1; k < NumKnots(); ++k)
+        Assert(m_Times[k] > m_Times[k - 1]);
+}
@@ -0,0 +1,122 @@
+/**
+ * @file        sweep.cpp
+ * 
+ * @brief       Implements pwd::Sweep.
+ * 
+ * @author      Filippo Maggioli\n
+ *              (maggioli@di.uniroma1.it, maggioli.filippo@gmail.com)\n
+ *              Sapienza, University of Rome - Department of Computer Science
+ * 
+ * @date        2026-10-16
+ */
+#include <pwd/sweep.hpp>
+
+
+pwd::Sweep::Sweep(const pwd::Graph* Graph)
+    : m_Graph(Graph), m_Mode(pwd::EvaluationMode::Stepping),
+      m_Backend(pwd::SolverBackend::SparseLU)
+{
+    CheckNull(m_Graph);
+}
+
+pwd::Sweep::~Sweep() { }
+
+
+void pwd::Sweep::AddScenario(const Eigen::VectorXd& LossRates,
+                             double InitialWater,
+                             const std::vector<std::pair<int, int>>& DeadEdges)
+{
+    Assert(LossRates.size() == m_Graph->NumNodes());
+    m_Scenarios.push_back({ LossRates, InitialWater, DeadEdges });
+}
+
+void pwd::Sweep::AddScenario(double LossRate,
+                             double InitialWater,
+                             const std::vector<std::pair<int, int>>& DeadEdges)
+{
+    Eigen::VectorXd LossRates;
+    LossRates.resize(m_Graph->NumNodes());
+    for (int i = 0; i < m_Graph->NumNodes(); ++i)
+        LossRates[m_Graph->InputID(i)] = m_Graph->GetNode(i)->IsOnLeaf() ? LossRate : 0.0;
+    AddScenario(LossRates, InitialWater, DeadEdges);
+}
+
+void pwd::Sweep::AddGrid(const std::vector<double>& LossRates,
+                         const std::vector<double>& InitialWaters,
+                         const std::vector<std::vector<std::pair<int, int>>>& DeadEdges)
+{
+    for (size_t d = 0; d < DeadEdges.size(); ++d)
+    {
+        for (size_t w = 0; w < InitialWaters.size(); ++w)
+        {
+            for (size_t l = 0; l < LossRates.size(); ++l)
+                AddScenario(LossRates[l], InitialWaters[w], DeadEdges[d]);
+        }
+    }
+}
+
+void pwd::Sweep::ClearScenarios() { m_Scenarios.clear(); }
+int pwd::Sweep::NumScenarios() const { return m_Scenarios.size(); }
+const pwd::Scenario& pwd::Sweep::GetScenario(int s) const { return m_Scenarios[s]; }
+
+
+void pwd::Sweep::SetTimes(const std::vector<double>& Times)
+{
+    for (size_t t = 0; t < Times.size(); ++t)
+    {
+        Assert(Times[t] >= 0.0);
+        Assert(t == 0 || Times[t] >= Times[t - 1]);
+    }
+    m_Times = Times;
+}
+
+int pwd::Sweep::NumTimes() const { return m_Times.size(); }
+const std::vector<double>& pwd::Sweep::Times() const { return m_Times; }
+
+
+void pwd::Sweep::SetEvaluationMode(pwd::EvaluationMode Mode) { m_Mode = Mode; }
+pwd::EvaluationMode pwd::Sweep::GetEvaluationMode() const { return m_Mode; }
+void pwd::Sweep::SetSolverBackend(pwd::SolverBackend Backend) { m_Backend = Backend; }
+pwd::SolverBackend pwd::Sweep::GetSolverBackend() const { return m_Backend; }
+
+
+size_t pwd::Sweep::ResultSize() const
+{
+    return (size_t)m_Graph->NumNodes() * m_Times.size() * m_Scenarios.size();
+}
+
+void pwd::Sweep::Run(pwd::ThreadPool& Pool, double* Results) const
+{
+    CheckNull(Results);
+    Run(Pool, Eigen::Map<Eigen::MatrixXd>(Results,
+                                          m_Graph->NumNodes(),
+                                          m_Times.size() * m_Scenarios.size()));
+}
+
+void pwd::Sweep::Run(pwd::ThreadPool& Pool, Eigen::Ref<Eigen::MatrixXd> Results) const
+{
+    Assert(Results.rows() == m_Graph->NumNodes());
+    Assert(Results.cols() == NumTimes() * NumScenarios());
+
+    Pool.ParallelFor(0, NumScenarios(), [&](int s) {
+        const pwd::Scenario& Scen = m_Scenarios[s];
+        pwd::WaterModel Model(m_Graph, Scen.LossRates, Scen.InitialWater, Scen.DeadEdges);
+        Model.SetSolverBackend(m_Backend);
+        switch (m_Mode)
+        {
+        case pwd::EvaluationMode::Stepping:
+            break;
+        case pwd::EvaluationMode::Spectral:
+            Model.Build();
+            break;
+        case pwd::EvaluationMode::Krylov:
+            Model.BuildKrylov();
+            break;
+        case pwd::EvaluationMode::Adaptive:
+            Model.BuildAdaptive();
+            break;
+        }
+
+        Model.EvaluateMany(m_Times, Results.middleCols(s * NumTimes(), NumTimes()));
+    });
+}
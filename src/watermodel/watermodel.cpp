@@ -11,13 +11,20 @@
  */
 #include <pwd/watermodel.hpp>
 #include <Eigen/IterativeLinearSolvers>
-#include <Eigen/SparseLU>
+#include <filesystem>
 
 
 // #define GAS_CONST               8.31446261815324
 // #define GRAMS2MOL(grams)        ((grams) * 0.05550929780738273660838190396891)
 // #define PRESSURE(w, v)          (GAS_CONST * GRAMS2MOL(w) * 25.0) / (v)
 #define PRESS_CONST             11.538249539485484318623369414376
+#define BDF6_ALPHA              (pwd::BDFCoefficients<6>::Alpha)
+// "PWDCKPT" in little endian, a checkpoint with swapped bytes does not match
+#define CHECKPOINT_MAGIC        0x0054504B43445750ULL
+#define CHECKPOINT_VERSION      1
+// "PWDSPEC" in little endian
+#define SPECTRAL_CACHE_MAGIC    0x0043455053445750ULL
+#define SPECTRAL_CACHE_VERSION  1
 
 
 namespace std {
@@ -30,10 +37,68 @@ template <> struct hash<std::pair<int, int>> {
 }
 
 
+// Drop the modes that decayed below the precision of each column. Their products would
+// be subnormal numbers, which are slower than normal ones by orders of magnitude.
+static void DropDecayedModes(Eigen::Ref<Eigen::MatrixXd> Coeffs)
+{
+    double Eps = std::numeric_limits<double>::epsilon();
+    for (int j = 0; j < Coeffs.cols(); ++j)
+    {
+        double Cutoff = Eps * Eps * Coeffs.col(j).cwiseAbs().maxCoeff();
+        Coeffs.col(j) = (Coeffs.col(j).array().abs() < Cutoff).select(0.0, Coeffs.col(j));
+    }
+}
+
+// Find the time at which a function goes from non-negative to negative inside the
+// interval [a, b], with Newton iterations safeguarded by bisection. The function
+// returns its value at the given time point and writes its derivative.
+template<typename Func>
+static double FindCrossing(const Func& F, double a, double b)
+{
+    double t = 0.5 * (a + b);
+    for (int Iter = 0; Iter < 100; ++Iter)
+    {
+        double dF;
+        double Val = F(t, dF);
+        if (Val < 0.0)
+            b = t;
+        else
+            a = t;
+        double Next = t - Val / dF;
+        // Bisect if the Newton step leaves the bracket, or the derivative vanishes
+        if (!(Next > a && Next < b))
+            Next = 0.5 * (a + b);
+        double Tol = 1e-13 * std::max(1.0, std::abs(t));
+        bool Converged = std::abs(Next - t) < Tol || b - a < Tol;
+        t = Next;
+        if (Converged)
+            break;
+    }
+    return t;
+}
+
+// Integrals of exp(L * s) and s * exp(L * s) for s from 0 to h. When L * h is small, the
+// closed forms cancel out, and the Taylor series are used instead.
+static void DuhamelWeights(double L, double h, double& Phi, double& Psi)
+{
+    double x = L * h;
+    if (std::abs(x) < 1e-3)
+    {
+        Phi = h * (1.0 + x * (0.5 + x * (1.0 / 6.0 + x / 24.0)));
+        Psi = h * h * (0.5 + x * (1.0 / 3.0 + x * (0.125 + x / 30.0)));
+        return;
+    }
+    Phi = std::expm1(x) / L;
+    Psi = (h * std::exp(x) - Phi) / L;
+}
+
+
 pwd::WaterModel::WaterModel(const pwd::Graph* Graph, 
                             double LossRate,
                             double InitialWater)
-    : m_Graph(Graph), m_LastTime(0.0)
+    : m_Graph(Graph), m_LastTime(0.0), m_Mode(pwd::EvaluationMode::Stepping),
+      m_Backend(pwd::SolverBackend::SparseLU), m_Pool(nullptr), m_DT(0.0), m_ClockStep(0.0),
+      m_SpectralTol(1e-8)
 {
     Initialize(LossRate, InitialWater);
 }
@@ -42,7 +107,9 @@ pwd::WaterModel::WaterModel(const pwd::Graph* Graph,
                             double LossRate,
                             double InitialWater, 
                             const std::vector<std::pair<int, int>>& DeadEdges)
-    : m_Graph(Graph), m_LastTime(0.0)
+    : m_Graph(Graph), m_LastTime(0.0), m_Mode(pwd::EvaluationMode::Stepping),
+      m_Backend(pwd::SolverBackend::SparseLU), m_Pool(nullptr), m_DT(0.0), m_ClockStep(0.0),
+      m_SpectralTol(1e-8)
 {
     Initialize(LossRate, InitialWater, DeadEdges);
 }
@@ -51,31 +118,91 @@ pwd::WaterModel::WaterModel(const pwd::Graph* Graph,
                             const Eigen::VectorXd& LossRates,
                             double InitialWater, 
                             const std::vector<std::pair<int, int>>& DeadEdges)
-    : m_Graph(Graph), m_LastTime(0.0)
+    : m_Graph(Graph), m_LastTime(0.0), m_Mode(pwd::EvaluationMode::Stepping),
+      m_Backend(pwd::SolverBackend::SparseLU), m_Pool(nullptr), m_DT(0.0), m_ClockStep(0.0),
+      m_SpectralTol(1e-8)
 {
     Initialize(LossRates, InitialWater, DeadEdges);
 }
 
 pwd::WaterModel::WaterModel(const pwd::WaterModel& Model)
 {
-    m_Graph = Model.m_Graph;
-    m_LastTime = Model.m_LastTime;
-    m_Water0 = Model.m_Water0;
-    m_Water = Model.m_Water;
-    m_Evecs = Model.m_Evecs;
-    m_Evals = Model.m_Evals;
-    m_InvEvecs = Model.m_InvEvecs;
+    *this = Model;
 }
 
 pwd::WaterModel& pwd::WaterModel::operator=(const pwd::WaterModel& Model)
 {
+    if (this == &Model)
+        return *this;
+
     m_Graph = Model.m_Graph;
     m_LastTime = Model.m_LastTime;
     m_Water0 = Model.m_Water0;
     m_Water = Model.m_Water;
+    m_InputIDs = Model.m_InputIDs;
+    m_NodeIDs = Model.m_NodeIDs;
+    m_InputWater0 = Model.m_InputWater0;
+    m_InputWater = Model.m_InputWater;
+    m_Xi = Model.m_Xi;
+    m_Xi2 = Model.m_Xi2;
+    m_SqrtVolumes = Model.m_SqrtVolumes;
+    m_Volumes = Model.m_Volumes;
+    m_FlowRes = Model.m_FlowRes;
+    m_Losses = Model.m_Losses;
+    m_StartWater = Model.m_StartWater;
+    m_StartTime = Model.m_StartTime;
+    m_SpectralTime = Model.m_SpectralTime;
+    m_SpectralTol = Model.m_SpectralTol;
+    m_CacheDir = Model.m_CacheDir;
+    m_S = Model.m_S;
+    m_Operator = Model.m_Operator;
+    m_DiagIdx = Model.m_DiagIdx;
+    for (int i = 0; i < 4; ++i)
+        m_RK[i] = Model.m_RK[i];
+    m_Spt = Model.m_Spt;
+    m_SptHead = Model.m_SptHead;
+    m_ClockStep = Model.m_ClockStep;
+    m_ClockStart = Model.m_ClockStart;
+    m_ClockSteps = Model.m_ClockSteps;
+    m_ClockWater = Model.m_ClockWater;
     m_Evecs = Model.m_Evecs;
     m_Evals = Model.m_Evals;
-    m_InvEvecs = Model.m_InvEvecs;
+    m_Backend = Model.m_Backend;
+    m_Mode = Model.m_Mode;
+    m_SymS = Model.m_SymS;
+
+    // The factorizations are not copied, they are computed again when needed
+    m_DT = Model.m_DT;
+    m_StepMatrix = Model.m_StepMatrix;
+    m_Solvers.Reset();
+    m_Solvers.SetBackend(m_Backend);
+    m_Solvers.SetCapacity(Model.m_Solvers.GetCapacity());
+    m_Sources = Model.m_Sources;
+    m_InputSources = Model.m_InputSources;
+    m_SourceCoeffs = Model.m_SourceCoeffs;
+    m_Inflow = Model.m_Inflow;
+    m_Schedule = Model.m_Schedule;
+    m_ScheduleStart = Model.m_ScheduleStart;
+    m_SegmentLosses = Model.m_SegmentLosses;
+    m_Segment = Model.m_Segment;
+    m_BaseLosses = Model.m_BaseLosses;
+    m_SegmentSolvers.clear();
+    for (int s = 0; s < (int)Model.m_SegmentSolvers.size(); ++s)
+        m_SegmentSolvers.push_back(std::make_unique<pwd::LinearSolver>(m_Backend));
+    SetThreadPool(Model.m_Pool);
+    m_Krylov.SetTolerance(Model.m_Krylov.GetTolerance());
+    m_Krylov.SetMaxBasis(Model.m_Krylov.GetMaxBasis());
+    m_Krylov.SetBackend(m_Backend);
+    m_Krylov.SetMatrix(m_SymS);
+    m_Adaptive.SetTolerances(Model.m_Adaptive.GetRelTolerance(), Model.m_Adaptive.GetAbsTolerance());
+    m_Adaptive.SetMaxOrder(Model.m_Adaptive.GetMaxOrder());
+    m_Adaptive.SetBackend(m_Backend);
+    if (m_Mode == pwd::EvaluationMode::Adaptive)
+    {
+        // The adaptive integration restarts from the current state
+        m_Adaptive.SetMatrix(m_S);
+        m_Adaptive.Reset(m_Water, m_LastTime);
+    }
 
     return *this;
 }
@@ -84,77 +211,454 @@ pwd::WaterModel::~WaterModel() { }
 
 const pwd::Graph* pwd::WaterModel::GetGraph() const { return m_Graph; }
 
-const Eigen::VectorXd& pwd::WaterModel::Water0() const { return m_Water0; }
-double pwd::WaterModel::Water0(int i) const { return m_Water0[i]; }
+const Eigen::VectorXd& pwd::WaterModel::Water0() const { return m_NodeIDs.empty() ? m_Water0 : m_InputWater0; }
+double pwd::WaterModel::Water0(int i) const { return m_Water0[NodeID(i)]; }
+
+const Eigen::VectorXd& pwd::WaterModel::Water() const { return m_NodeIDs.empty() ? m_Water : m_InputWater; }
+double pwd::WaterModel::Water(int i) const { return m_Water[NodeID(i)]; }
 
-const Eigen::VectorXd& pwd::WaterModel::Water() const { return m_Water; }
-double pwd::WaterModel::Water(int i) const { return m_Water[i]; }
+const Eigen::VectorXd& pwd::WaterModel::GraphWater0() const { return m_Water0; }
+const Eigen::VectorXd& pwd::WaterModel::GraphWater() const { return m_Water; }
+const std::vector<int>& pwd::WaterModel::NodeIDs() const { return m_NodeIDs; }
+
+const Eigen::SparseMatrix<double>& pwd::WaterModel::SystemMatrix() const { return m_S; }
+const Eigen::VectorXd& pwd::WaterModel::Eigenvalues() const { return m_Evals; }
+const Eigen::MatrixXd& pwd::WaterModel::Eigenvectors() const { return m_Evecs; }
+const Eigen::VectorXd& pwd::WaterModel::SpectralCoefficients() const { return m_Xi; }
+double pwd::WaterModel::SpectralTime() const { return m_SpectralTime; }
+double pwd::WaterModel::StartTime() const { return m_StartTime; }
 
 void pwd::WaterModel::Evaluate(double Time)
 {
-    Assert(Time >= 0.0);
-    static const double Alpha = 60.0 / 147.0;
-    static const double Beta[6] = {
-        -10.0 / 147.0,
-        72.0 / 147.0,
-        -225.0 / 147.0,
-        400.0 / 147.0,
-        -450.0 / 147.0,
-        360.0 / 147.0
-    };
-    static const Eigen::Vector<double, 6> VBeta(Beta);
+    Propagate(Time);
+    UpdateInputWater();
+}
+
+void pwd::WaterModel::Propagate(double Time)
+{
+    Assert(Time >= m_StartTime);
+    pwd::PhaseTimer Timer(pwd::Phase::Evaluate);
+
+    if (m_Mode == pwd::EvaluationMode::Krylov)
+    {
+        // Propagate the symmetrized water V^(-1/2) * w from the closest known state
+        double Start = m_LastTime;
+        if (Time < m_LastTime)
+        {
+            Start = m_StartTime;
+            m_Water = m_StartWater;
+        }
+        m_KrylovIn = m_Water.cwiseQuotient(m_SqrtVolumes);
+        m_Krylov.Apply(Time - Start, m_KrylovIn, m_KrylovOut);
+        m_Water = m_KrylovOut.cwiseProduct(m_SqrtVolumes);
+        m_LastTime = Time;
+        return;
+    }
+
+    if (m_Mode == pwd::EvaluationMode::Adaptive)
+    {
+        if (Time < m_Adaptive.Time())
+            m_Adaptive.Reset(m_StartWater, m_StartTime);
+        m_Adaptive.Advance(Time);
+        m_Water = m_Adaptive.State();
+        m_LastTime = Time;
+        return;
+    }
+
+    if (m_Mode == pwd::EvaluationMode::Stepping)
+    {
+        Advance(Time);
+        return;
+    }
+
+    if (Time < m_SpectralTime)
+    {
+        // The truncated modes are not accurate yet, fall back to time stepping
+        if (Time < m_LastTime)
+        {
+            m_Water = m_StartWater;
+            m_LastTime = m_StartTime;
+            m_DT = 0.0;
+            ResetClock();
+        }
+        Advance(Time);
+        return;
+    }
+
+    m_LastTime = Time;
+    m_Xi2 = m_Xi.cwiseProduct((m_Evals * (m_LastTime - m_StartTime)).array().exp().matrix());
+    AddSourceModes(m_LastTime, m_Xi2);
+    DropDecayedModes(m_Xi2);
+    m_Water.noalias() = m_Evecs * m_Xi2;
+}
+
+void pwd::WaterModel::EvaluateMany(const std::vector<double>& Times,
+                                   Eigen::Ref<Eigen::MatrixXd> Out)
+{
+    int NumTimes = Times.size();
+    Assert(Out.rows() == m_Water.rows());
+    Assert(Out.cols() == NumTimes);
+    for (int j = 0; j < NumTimes; ++j)
+    {
+        Assert(Times[j] >= m_StartTime);
+        Assert(j == 0 || Times[j] >= Times[j - 1]);
+    }
+
+    // Time points evaluated one at a time, that is all of them unless the model is
+    // spectral, and those before the switch to the closed form otherwise
+    int First = NumTimes;
+    if (m_Mode == pwd::EvaluationMode::Spectral)
+    {
+        First = 0;
+        while (First < NumTimes && Times[First] < m_SpectralTime)
+            ++First;
+    }
+    for (int j = 0; j < First; ++j)
+    {
+        Propagate(Times[j]);
+        Out.col(j) = m_Water;
+    }
+    if (First < NumTimes)
+    {
+        pwd::PhaseTimer Timer(pwd::Phase::Evaluate);
+
+        // Coefficients Xi .* exp(L * (t_j - t_0)) of all the time points as a single block
+        int Count = NumTimes - First;
+        Eigen::Map<const Eigen::RowVectorXd> Elapsed(Times.data() + First, Count);
+        m_ModeCoeffs.resize(m_Evals.rows(), Count);
+        m_ModeCoeffs.noalias() = m_Evals * (Elapsed.array() - m_StartTime).matrix();
+        m_ModeCoeffs = m_ModeCoeffs.array().exp().colwise() * m_Xi.array();
+        for (int j = 0; j < Count && m_Sources.NumKnots() > 0; ++j)
+            AddSourceModes(Times[First + j], m_ModeCoeffs.col(j));
+        DropDecayedModes(m_ModeCoeffs);
+        Out.rightCols(Count).noalias() = m_Evecs * m_ModeCoeffs;
+
+        m_LastTime = Times.back();
+        m_Xi2 = m_ModeCoeffs.col(Count - 1);
+        m_Water = Out.col(NumTimes - 1);
+    }
+
+    // The rows are moved to the input order at once
+    if (!m_NodeIDs.empty() && NumTimes > 0)
+    {
+        m_Permuted.resize(Out.rows(), Out.cols());
+        m_Permuted.noalias() = Out(m_NodeIDs, Eigen::all);
+        Out = m_Permuted;
+    }
+    UpdateInputWater();
+}
+
+void pwd::WaterModel::Step(double Time)
+{
+    static const double Alpha = BDF6_ALPHA;
     // static Eigen::BiCGSTAB<Eigen::SparseMatrix<double>> Solver;
-    static Eigen::SparseLU<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>> Solver;
-    static double DT = 0.0;
-
-    if (!m_Spectral)
-    {
-        double dt = Time - m_LastTime;
-        if (dt < 1e-7)
-            return;
-        // Fwd Euler
-        // m_Water += dt * (m_S * m_Water);
-
-        // Bwd Euler
-        // Eigen::BiCGSTAB<Eigen::SparseMatrix<double>> Solver;
-        // Solver.compute(m_Eye - dt * m_S);
-        // m_Water = Solver.solve(m_Water);
-
-        // RK4
-        // m_RK[0] = m_S * m_Water;
-        // m_RK[1] = m_S * (m_Water + 0.5 * dt * m_RK[0]);
-        // m_RK[2] = m_S * (m_Water + 0.5 * dt * m_RK[1]);
-        // m_RK[3] = m_S * (m_Water + dt * m_RK[2]);
-        // m_Water += (dt / 6.0) * (m_RK[0] + 2 * m_RK[1] + 2 * m_RK[2] + m_RK[3]);
-
-        // BDF6
-        if (std::abs(dt - DT) > 1e-7)
+
+    double dt = Time - m_LastTime;
+    if (dt < 1e-7)
+        return;
+    // Fwd Euler
+    // m_Water += dt * (m_S * m_Water);
+
+    // Bwd Euler
+    // Eigen::BiCGSTAB<Eigen::SparseMatrix<double>> Solver;
+    // Solver.compute(m_Eye - dt * m_S);
+    // m_Water = Solver.solve(m_Water);
+
+    // RK4
+    // m_RK[0] = m_S * m_Water;
+    // m_RK[1] = m_S * (m_Water + 0.5 * dt * m_RK[0]);
+    // m_RK[2] = m_S * (m_Water + 0.5 * dt * m_RK[1]);
+    // m_RK[3] = m_S * (m_Water + dt * m_RK[2]);
+    // m_Water += (dt / 6.0) * (m_RK[0] + 2 * m_RK[1] + 2 * m_RK[2] + m_RK[3]);
+
+    // BDF6
+    bool NewStep = std::abs(dt - m_DT) > 1e-7;
+    if (NewStep)
+    {
+        m_DT = dt;
+        for (int i = 0; i < 6; ++i)
+            m_Spt.col(i) = m_Water;
+        m_SptHead = 0;
+        // The factorizations of the schedule are for the previous time step
+        for (auto& Solver : m_SegmentSolvers)
+            Solver->Clear();
+    }
+    pwd::LinearSolver* Solver;
+    if (m_Segment >= 0)
+    {
+        // The step uses the losses of the segment active at its beginning, with the
+        // same tolerance on the time points of the time step
+        int Segment = m_Schedule.SegmentAt(m_LastTime - m_ScheduleStart + 1e-7);
+        if (Segment != m_Segment)
         {
-            DT = dt;
-            for (int i = 0; i < 6; ++i)
-                m_Spt.col(i) = m_Water;
-            // Solver.compute(m_Eye - Alpha * DT * m_S);
-            Solver.analyzePattern(m_Eye - Alpha * DT * m_S);
-            Solver.factorize(m_Eye - Alpha * DT * m_S);
+            SetLosses(m_SegmentLosses[Segment]);
+            m_Segment = Segment;
         }
+        Solver = m_SegmentSolvers[m_Segment].get();
+        if (!Solver->IsFactorized() || Solver->GetBackend() != m_Backend)
+            FactorizeStep(*Solver, m_DT);
+    }
+    else
+    {
+        // The factorization of a recent time step is reused, and its time step replaces
+        // the one of the evaluation within the tolerance
+        Solver = &StepSolver(m_DT);
+    }
 
-        for (int i = 0; i < 5; ++i)
-            m_Spt.col(i) = m_Spt.col(i + 1);
-        m_Spt.col(5) = m_Water;
+    // The oldest state of the history is replaced by the current one while the
+    // right-hand side is built, in a single pass
+    double* History[6];
+    for (int i = 0; i < 6; ++i)
+        History[i] = m_Spt.col((m_SptHead + i) % 6).data();
+    m_StepRhs.resize(m_Water.rows());
+    pwd::BDFRhs<double>(m_Spt.cols(), History, m_Water.data(), m_StepRhs.data(), m_Water.rows());
+    m_SptHead = (m_SptHead + 1) % 6;
+    if (m_Sources.NumKnots() > 0)
+    {
+        // The left limit of the inflow, so that a step ending on a knot of a
+        // piecewise-constant profile uses the inflow of its own piece
+        m_Sources.Inflow(Time - 1e-7, m_Inflow);
+        m_StepRhs += (Alpha * m_DT) * m_Inflow;
+    }
+    Solver->SolveInPlace(m_StepRhs);
+    m_Water.swap(m_StepRhs);
 
-        m_Water = Solver.solve(m_Spt * VBeta);
+    m_LastTime = Time;
+}
 
-        m_LastTime = Time;
+void pwd::WaterModel::Advance(double Time)
+{
+    if (m_ClockStep == 0.0)
+    {
+        Step(Time);
+        return;
+    }
+    if (Time - m_LastTime < 1e-7)
         return;
+
+    // The clock steps from its own state, which is swapped in for Step()
+    m_Water.swap(m_ClockWater);
+    m_LastTime = m_ClockStart + m_ClockSteps * m_ClockStep;
+    while (m_LastTime < Time - 1e-7)
+    {
+        ++m_ClockSteps;
+        Step(m_ClockStart + m_ClockSteps * m_ClockStep);
     }
+    m_Water.swap(m_ClockWater);
 
+    // Dense output between the last two steps, the history holds the six before the
+    // last one from the oldest. After a restart of the clock the older slots are copies
+    // of its first state, hence only the states computed by the clock are interpolated.
+    const double* History[6];
+    for (int i = 0; i < 6; ++i)
+        History[i] = m_Spt.col((m_SptHead + i) % 6).data();
+    int Order = std::min<int64_t>(m_ClockSteps, 6);
+    double s = (Time - m_LastTime) / m_ClockStep;
+    pwd::BDFDenseOutput(Order, History + 6 - Order, m_ClockWater.data(), s, m_Water.data(), m_Water.rows());
     m_LastTime = Time;
-    for (int i = 0; i < m_Xi2.size(); ++i)
-        m_Xi2[i] = m_Xi[i] * std::exp(m_Evals[i] * m_LastTime);
-    m_Water = (m_Evecs * m_Xi2).real();
+}
+
+void pwd::WaterModel::ResetClock()
+{
+    m_ClockStart = m_LastTime;
+    m_ClockSteps = 0;
+    m_ClockWater = m_Water;
+    m_DT = 0.0;
+}
+
+void pwd::WaterModel::WiltingTimes(double Fraction,
+                                   double MaxTime,
+                                   double TimeStep,
+                                   Eigen::Ref<Eigen::VectorXd> Times)
+{
+    if (m_NodeIDs.empty())
+        FindWiltingTimes(Fraction, MaxTime, TimeStep, Times);
+    else
+    {
+        Assert(Times.size() == m_Water.rows());
+        Eigen::VectorXd NodeTimes(Times.size());
+        FindWiltingTimes(Fraction, MaxTime, TimeStep, NodeTimes);
+        Times = NodeTimes(m_NodeIDs);
+    }
+    UpdateInputWater();
+}
+
+void pwd::WaterModel::FindWiltingTimes(double Fraction,
+                                       double MaxTime,
+                                       double TimeStep,
+                                       Eigen::Ref<Eigen::VectorXd> Times)
+{
+    int n = m_Water.rows();
+    Assert(Fraction >= 0.0);
+    Assert(TimeStep > 0.0);
+    Assert(MaxTime >= m_LastTime);
+    Assert(Times.size() == n);
+
+    Eigen::VectorXd Threshold = Fraction * m_Water0;
+    std::vector<int> Alive;
+    Alive.reserve(n);
+    Times.setConstant(std::numeric_limits<double>::infinity());
+    for (int i = 0; i < n; ++i)
+    {
+        if (m_Water[i] < Threshold[i])
+            Times[i] = m_LastTime;
+        else
+            Alive.push_back(i);
+    }
+
+    // The model is advanced step by step, unless it is spectral, in which case only
+    // the time before the switch to the closed form is
+    double Switch = MaxTime;
+    if (m_Mode == pwd::EvaluationMode::Spectral)
+        Switch = std::min(std::max(m_SpectralTime, m_LastTime), MaxTime);
+    if (Switch > m_LastTime)
+    {
+        double t0 = m_LastTime;
+        int NumSteps = std::max(1, (int)std::ceil((Switch - t0) / TimeStep - 1e-9));
+        double dt = (Switch - t0) / NumSteps;
+        Eigen::VectorXd PrevWater = m_Water;
+        Eigen::VectorXd PrevRate(n);
+        Eigen::VectorXd Rate(n);
+        ApplySystem(PrevWater, PrevRate);
+        if (m_Sources.NumKnots() > 0)
+        {
+            m_Sources.Inflow(t0, Rate);
+            PrevRate += Rate;
+        }
+        for (int s = 1; s <= NumSteps; ++s)
+        {
+            double a = m_LastTime;
+            Propagate(s == NumSteps ? Switch : t0 + s * dt);
+            double b = m_LastTime;
+            double h = b - a;
+            ApplySystem(m_Water, Rate);
+            if (m_Sources.NumKnots() > 0)
+            {
+                m_Sources.Inflow(b, m_Inflow);
+                Rate += m_Inflow;
+            }
+
+            int NumAlive = 0;
+            for (int i : Alive)
+            {
+                if (m_Water[i] >= Threshold[i])
+                {
+                    Alive[NumAlive++] = i;
+                    continue;
+                }
+                // Cubic Hermite interpolant of the water at node i over the step
+                double y0 = PrevWater[i] - Threshold[i];
+                double y1 = m_Water[i] - Threshold[i];
+                double m0 = h * PrevRate[i];
+                double m1 = h * Rate[i];
+                auto Interp = [=](double t, double& dF)
+                {
+                    double x = (t - a) / h;
+                    double x2 = x * x;
+                    double x3 = x2 * x;
+                    dF = ((6.0 * x2 - 6.0 * x) * (y0 - y1) +
+                          (3.0 * x2 - 4.0 * x + 1.0) * m0 +
+                          (3.0 * x2 - 2.0 * x) * m1) / h;
+                    return (2.0 * x3 - 3.0 * x2 + 1.0) * y0 + (x3 - 2.0 * x2 + x) * m0 +
+                           (-2.0 * x3 + 3.0 * x2) * y1 + (x3 - x2) * m1;
+                };
+                Times[i] = FindCrossing(Interp, a, b);
+            }
+            Alive.resize(NumAlive);
+            PrevWater = m_Water;
+            PrevRate.swap(Rate);
+        }
+    }
+    if (MaxTime <= m_LastTime)
+        return;
+
+    // Water at the steps from the closed form, a block of steps at a time
+    const int BlockSize = 64;
+    double t0 = m_LastTime;
+    int NumSteps = std::max(1, (int)std::ceil((MaxTime - t0) / TimeStep - 1e-9));
+    double dt = (MaxTime - t0) / NumSteps;
+    Eigen::MatrixXd Block;
+    Eigen::VectorXd Coeffs(m_Evals.rows());
+    for (int s0 = 1; s0 <= NumSteps && !Alive.empty(); s0 += BlockSize)
+    {
+        int Count = std::min(BlockSize, NumSteps - s0 + 1);
+        Eigen::RowVectorXd Elapsed = Eigen::RowVectorXd::LinSpaced(Count, s0, s0 + Count - 1);
+        Elapsed = (Elapsed * dt).array() + (t0 - m_StartTime);
+        m_ModeCoeffs.resize(m_Evals.rows(), Count);
+        m_ModeCoeffs.noalias() = m_Evals * Elapsed;
+        m_ModeCoeffs = m_ModeCoeffs.array().exp().colwise() * m_Xi.array();
+        for (int j = 0; j < Count && m_Sources.NumKnots() > 0; ++j)
+            AddSourceModes(t0 + (s0 + j) * dt, m_ModeCoeffs.col(j));
+        DropDecayedModes(m_ModeCoeffs);
+        Block.noalias() = m_Evecs * m_ModeCoeffs;
+
+        int NumAlive = 0;
+        for (int i : Alive)
+        {
+            int j = 0;
+            while (j < Count && Block(i, j) >= Threshold[i])
+                ++j;
+            if (j == Count)
+            {
+                Alive[NumAlive++] = i;
+                continue;
+            }
+            // Sum of the exponentials of the modes at node i
+            auto Closed = [&](double t, double& dF)
+            {
+                Coeffs = m_Xi.cwiseProduct((m_Evals * (t - m_StartTime)).array().exp().matrix());
+                AddSourceModes(t, Coeffs);
+                dF = m_Evecs.row(i).dot(Coeffs.cwiseProduct(m_Evals));
+                if (m_Sources.NumKnots() > 0)
+                    dF += m_Sources.Inflow(t, i);
+                return m_Evecs.row(i).dot(Coeffs) - Threshold[i];
+            };
+            double a = t0 + (s0 + j - 1) * dt;
+            double b = s0 + j == NumSteps ? MaxTime : t0 + (s0 + j) * dt;
+            Times[i] = FindCrossing(Closed, a, b);
+        }
+        Alive.resize(NumAlive);
+    }
+    Evaluate(MaxTime);
 }
 
 double pwd::WaterModel::LastEvaluationTime() const { return m_LastTime; }
+pwd::EvaluationMode pwd::WaterModel::GetEvaluationMode() const { return m_Mode; }
+const pwd::AdaptiveBDF& pwd::WaterModel::GetAdaptiveIntegrator() const { return m_Adaptive; }
+
+pwd::SolverBackend pwd::WaterModel::GetSolverBackend() const { return m_Backend; }
+void pwd::WaterModel::SetSolverBackend(pwd::SolverBackend Backend)
+{
+    m_Backend = Backend;
+    m_Solvers.SetBackend(Backend);
+    m_Krylov.SetBackend(Backend);
+    m_Adaptive.SetBackend(Backend);
+}
+
+void pwd::WaterModel::SetThreadPool(pwd::ThreadPool* Pool)
+{
+    m_Pool = Pool;
+    m_Solvers.SetThreadPool(Pool);
+    for (auto& Solver : m_SegmentSolvers)
+        Solver->SetThreadPool(Pool);
+}
+
+int pwd::WaterModel::GetStepCacheSize() const { return m_Solvers.GetCapacity(); }
+double pwd::WaterModel::GetStepSize() const { return m_ClockStep; }
+
+void pwd::WaterModel::SetStepSize(double Step)
+{
+    Assert(Step == 0.0 || Step > 1e-7);
+    if (Step == m_ClockStep)
+        return;
+    m_ClockStep = Step;
+    ResetClock();
+}
+
+void pwd::WaterModel::SetStepCacheSize(int Size)
+{
+    m_Solvers.SetCapacity(Size);
+}
 
 void pwd::WaterModel::Initialize(double LossRate,
                                  double InitialWater)
@@ -162,7 +666,7 @@ void pwd::WaterModel::Initialize(double LossRate,
     Eigen::VectorXd LossRates;
     LossRates.resize(m_Graph->NumNodes());
     for (int i = 0; i < m_Graph->NumNodes(); ++i)
-        LossRates[i] = m_Graph->GetNode(i)->IsOnLeaf() ? LossRate : 0.0;
+        LossRates[m_Graph->InputID(i)] = m_Graph->GetNode(i)->IsOnLeaf() ? LossRate : 0.0;
     Initialize(LossRates, InitialWater, { });
 }
 
@@ -173,7 +677,7 @@ void pwd::WaterModel::Initialize(double LossRate,
     Eigen::VectorXd LossRates;
     LossRates.resize(m_Graph->NumNodes());
     for (int i = 0; i < m_Graph->NumNodes(); ++i)
-        LossRates[i] = m_Graph->GetNode(i)->IsOnLeaf() ? LossRate : 0.0;
+        LossRates[m_Graph->InputID(i)] = m_Graph->GetNode(i)->IsOnLeaf() ? LossRate : 0.0;
     Initialize(LossRates, InitialWater, DeadEdges);
 }
 
@@ -181,10 +685,27 @@ void pwd::WaterModel::Initialize(const Eigen::VectorXd& LossRates,
                                  double InitialWater,
                                  const std::vector<std::pair<int, int>>& DeadEdges)
 {
+    pwd::PhaseTimer Timer(pwd::Phase::Assembly);
+    // The state is stored in the order of the graph, the IDs of the input file are
+    // translated by the public methods
+    m_InputIDs.clear();
+    m_NodeIDs.clear();
+    if (m_Graph->GetOrdering() != pwd::NodeOrdering::Input)
+    {
+        m_InputIDs.resize(m_Graph->NumNodes());
+        m_NodeIDs.resize(m_Graph->NumNodes());
+        for (int i = 0; i < m_Graph->NumNodes(); ++i)
+        {
+            m_InputIDs[i] = m_Graph->InputID(i);
+            m_NodeIDs[i] = m_Graph->NodeID(i);
+        }
+    }
+
     // Compute an hash set of dead edges for fast computation
     std::unordered_set<std::pair<int, int>> DEMap;
     for (auto Edge : DeadEdges)
     {
+        Edge = { NodeID(Edge.first), NodeID(Edge.second) };
         // Dead edges are symmetrically dead, of course
         if (DEMap.find(Edge) == DEMap.end())
             DEMap.insert(Edge);
@@ -223,6 +744,13 @@ void pwd::WaterModel::Initialize(const Eigen::VectorXd& LossRates,
     // Rescale water
     m_Water0 *= InitialWater / m_Water0.sum();
     m_Water = m_Water0;
+    m_SqrtVolumes = Volumes.cwiseSqrt();
+    m_Volumes = Volumes;
+    m_FlowRes = FlowRes;
+    m_Losses = m_InputIDs.empty() ? LossRates.cwiseProduct(Areas)
+                                  : Eigen::VectorXd(LossRates(m_InputIDs).cwiseProduct(Areas));
+    m_InputWater0 = m_NodeIDs.empty() ? Eigen::VectorXd() : Eigen::VectorXd(m_Water0(m_NodeIDs));
+    UpdateInputWater();
 
     
     // Create the adjacency matrix with inverse of water flows
@@ -238,27 +766,36 @@ void pwd::WaterModel::Initialize(const Eigen::VectorXd& LossRates,
         for (int ch = 0; ch < N->Degree(); ++ch)
         {
             int j = m_Graph->GetNodeID(N->GetAdjacent(ch));
-            // If the connection is dead, ignore it
+            // If the connection is dead, keep it in the pattern with no flow, so that
+            // it can be revived without changing the pattern
             if (DEMap.find({ i, j }) != DEMap.end())
+            {
+                FResTrips.emplace_back(i, j, 0.0);
                 continue;
+            }
             // Otherwise, compute the average flow resistance and add it to the matrix
             double FResLoc = 0.5 * (FlowRes[i] + FlowRes[j]);
             // Adj(i, j) = FResLoc;
             FResTrips.emplace_back(i, j, FResLoc);
             FRes += FResLoc;
         }
-        if (FRes > 0.0)
-            // Adj(i, i) = -FRes;
-            FResTrips.emplace_back(i, i, -FRes);
+        // Adj(i, i) = -FRes;
+        FResTrips.emplace_back(i, i, -FRes);
     }
     Adj.setFromTriplets(FResTrips.begin(), FResTrips.end());
 
     // Compute the system matrix
     m_S = PRESS_CONST * Adj * Volumes.cwiseInverse().asDiagonal();
-    m_S -= Eigen::SparseMatrix<double>(LossRates.cwiseProduct(Areas).asDiagonal());
+    m_S -= Eigen::SparseMatrix<double>(m_Losses.asDiagonal());
+    m_Operator.Compute(m_Graph, Volumes, m_Losses);
+    UpdateOperator();
 
-    m_Eye.resize(m_S.rows(), m_S.cols());
-    m_Eye.setIdentity();
+    // The diagonal of S is always in the pattern, the step matrix shares it
+    m_DiagIdx.resize(m_S.cols());
+    for (int i = 0; i < m_S.cols(); ++i)
+        m_DiagIdx[i] = EntryIndex(m_S, i, i);
+    m_StepMatrix = m_S;
+    m_StepRhs.resize(m_S.rows());
     for (int i = 0; i < 4; ++i)
     {
         m_RK[i].resize(m_S.cols());
@@ -266,34 +803,815 @@ void pwd::WaterModel::Initialize(const Eigen::VectorXd& LossRates,
     }
     m_Spt.resize(m_S.rows(), 6);
     m_Spt.setZero();
+    m_SptHead = 0;
 
-    m_Spectral = false;
+    m_Mode = pwd::EvaluationMode::Stepping;
+    m_Solvers.Reset();
+    m_DT = 0.0;
     m_LastTime = 0.0;
+    m_StartWater = m_Water0;
+    m_StartTime = 0.0;
+    m_SpectralTime = 0.0;
+
+    m_Sources = pwd::SourceProfile();
+    m_InputSources = pwd::SourceProfile();
+    m_SourceCoeffs.resize(0, 0);
+    m_Inflow.setZero(m_Graph->NumNodes());
+    m_Schedule = pwd::LossSchedule();
+    m_ScheduleStart = 0.0;
+    m_SegmentLosses.clear();
+    m_SegmentSolvers.clear();
+    m_Segment = -1;
+    ResetClock();
 }
 
 
 void pwd::WaterModel::Build()
 {
-    m_Spectral = true;
-
-    // Compute the eigendecomposition
-    std::cout << "Generated ODE system has " << m_S.cols() << " variables." << std::endl;
-    std::cout << "Solving the eigendecomposition..." << std::endl;
-    std::chrono::system_clock::time_point Start, End;
-    Start = std::chrono::system_clock::now();
-    Eigen::MatrixXd Sys = m_S.toDense();
-    Eigen::EigenSolver<Eigen::MatrixXd> EigSolver;
-    EigSolver.compute(Sys);
-    m_Evals = EigSolver.eigenvalues();
-    m_Evecs = EigSolver.eigenvectors();
-    // m_InvEvecs = m_Evecs.inverse();
-    // m_Xi = m_InvEvecs * m_Water0;
-    m_Xi2 = m_Water0;
-    m_Xi = m_Evecs.colPivHouseholderQr().solve(m_Xi2);
+    ClearLossSchedule();
+    m_Mode = pwd::EvaluationMode::Spectral;
+
+    // Compute the eigendecomposition, unless it is in the cache
+    if (!LoadSpectralCache())
+    {
+        pwd::PhaseTimer Timer(pwd::Phase::Eigendecomposition);
+        // Symmetrize the system as H = V^(-1/2) * S * V^(1/2)
+        Eigen::VectorXd InvSqrtVolumes = m_SqrtVolumes.cwiseInverse();
+        Eigen::MatrixXd Sys = InvSqrtVolumes.asDiagonal() * m_S.toDense() * m_SqrtVolumes.asDiagonal();
+        Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> EigSolver;
+        EigSolver.compute(Sys);
+        Assert(EigSolver.info() == Eigen::Success);
+        m_Evals = EigSolver.eigenvalues();
+        // H = Q * L * Q^T, hence S = (V^(1/2) * Q) * L * (Q^T * V^(-1/2))
+        m_Evecs = m_SqrtVolumes.asDiagonal() * EigSolver.eigenvectors();
+        SaveSpectralCache();
+    }
+    m_StartWater = m_Water0;
+    m_StartTime = 0.0;
+    ProjectSpectral();
+}
+
+void pwd::WaterModel::Build(int NumModes, double Tolerance)
+{
+    Assert(NumModes > 0 && NumModes <= m_S.cols());
+    Assert(Tolerance > 0.0);
+    Assert(m_Sources.NumKnots() == 0);
+    ClearLossSchedule();
+    m_Mode = pwd::EvaluationMode::Spectral;
+    m_SpectralTol = Tolerance;
+
+    ComputeSlowModes(NumModes);
+    m_Water = m_Water0;
+    UpdateInputWater();
+    m_LastTime = 0.0;
+    m_DT = 0.0;
+    ResetClock();
+    m_StartWater = m_Water0;
+    m_StartTime = 0.0;
+    ProjectSpectral();
+}
+
+uint64_t pwd::WaterModel::SpectralCacheKey() const
+{
+    // The system matrix and the volumes depend on the geometry and the topology of
+    // the graph, the loss rates and the dead edges, and they define the decomposition
+    uint64_t Key = PWD_HASH_SEED;
+    int64_t Sizes[2] = { m_S.rows(), m_S.nonZeros() };
+    Key = pwd::HashBytes(Sizes, sizeof(Sizes), Key);
+    Key = pwd::HashBytes(m_S.outerIndexPtr(), (m_S.cols() + 1) * sizeof(int), Key);
+    Key = pwd::HashBytes(m_S.innerIndexPtr(), m_S.nonZeros() * sizeof(int), Key);
+    Key = pwd::HashBytes(m_S.valuePtr(), m_S.nonZeros() * sizeof(double), Key);
+    Key = pwd::HashBytes(m_SqrtVolumes.data(), m_SqrtVolumes.size() * sizeof(double), Key);
+    return Key;
+}
+
+std::string pwd::WaterModel::SpectralCachePath() const
+{
+    char Name[32];
+    std::snprintf(Name, sizeof(Name), "%016llx.pwdspec", (unsigned long long)SpectralCacheKey());
+    return (std::filesystem::path(m_CacheDir) / Name).string();
+}
+
+bool pwd::WaterModel::LoadSpectralCache()
+{
+    if (m_CacheDir.empty())
+        return false;
+
+    // An unreadable, damaged or stale entry is a miss, it is overwritten by the new
+    // decomposition
+    try
+    {
+        std::string Path = SpectralCachePath();
+        std::error_code Error;
+        if (!std::filesystem::is_regular_file(Path, Error))
+            return false;
+        pwd::BinaryReader Reader(Path);
+        if (Reader.Read<uint64_t>() != SPECTRAL_CACHE_MAGIC ||
+            Reader.Read<int32_t>() != SPECTRAL_CACHE_VERSION)
+            return false;
+        // The name of the file is only a hash, the entry must hold the same system
+        if (Reader.Read<uint64_t>() != SpectralCacheKey() ||
+            Reader.Read<int64_t>() != m_S.rows() ||
+            Reader.Read<int64_t>() != m_S.nonZeros())
+            return false;
+        Eigen::Map<const Eigen::VectorXd> Values = Reader.ReadVector();
+        Eigen::Map<const Eigen::VectorXd> SqrtVolumes = Reader.ReadVector();
+        if (Values.size() != m_S.nonZeros() || SqrtVolumes.size() != m_SqrtVolumes.size() ||
+            !std::equal(Values.data(), Values.data() + Values.size(), m_S.valuePtr()) ||
+            SqrtVolumes != m_SqrtVolumes)
+            return false;
+        Eigen::Map<const Eigen::VectorXd> Evals = Reader.ReadVector();
+        Eigen::Map<const Eigen::MatrixXd> Evecs = Reader.ReadMatrix();
+        if (Evals.size() != m_S.rows() || Evecs.rows() != m_S.rows() || Evecs.cols() != m_S.cols())
+            return false;
+        // The checksum detects the damaged bytes of the decomposition
+        uint64_t Checksum = pwd::HashBytes(Evals.data(), Evals.size() * sizeof(double));
+        Checksum = pwd::HashBytes(Evecs.data(), Evecs.size() * sizeof(double), Checksum);
+        if (Reader.Read<uint64_t>() != Checksum)
+            return false;
+        m_Evals = Evals;
+        m_Evecs = Evecs;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+    return true;
+}
+
+void pwd::WaterModel::SaveSpectralCache() const
+{
+    if (m_CacheDir.empty())
+        return;
+    pwd::BinaryWriter Writer;
+    Writer.Write<uint64_t>(SPECTRAL_CACHE_MAGIC);
+    Writer.Write<int32_t>(SPECTRAL_CACHE_VERSION);
+    Writer.Write<uint64_t>(SpectralCacheKey());
+    Writer.Write<int64_t>(m_S.rows());
+    Writer.Write<int64_t>(m_S.nonZeros());
+    Writer.WriteArray(m_S.valuePtr(), m_S.nonZeros(), 1);
+    Writer.WriteVector(m_SqrtVolumes);
+    Writer.WriteVector(m_Evals);
+    Writer.WriteMatrix(m_Evecs);
+    uint64_t Checksum = pwd::HashBytes(m_Evals.data(), m_Evals.size() * sizeof(double));
+    Writer.Write(pwd::HashBytes(m_Evecs.data(), m_Evecs.size() * sizeof(double), Checksum));
+    try
+    {
+        Writer.Save(SpectralCachePath());
+    }
+    catch (const std::exception&)
+    {
+        // A cache that cannot be written only costs the next decomposition
+    }
+}
+
+const std::string& pwd::WaterModel::GetCacheDirectory() const { return m_CacheDir; }
+void pwd::WaterModel::SetCacheDirectory(const std::string& Directory)
+{
+    if (!Directory.empty())
+        std::filesystem::create_directories(Directory);
+    m_CacheDir = Directory;
+}
+
+void pwd::WaterModel::ComputeSlowModes(int NumModes)
+{
+    pwd::PhaseTimer Timer(pwd::Phase::Eigendecomposition);
+    // The slowest modes of H = V^(-1/2) * S * V^(1/2) are the closest to any positive
+    // shift, since the spectrum is non-positive
+    m_SymS = m_SqrtVolumes.cwiseInverse().asDiagonal() * m_S * m_SqrtVolumes.asDiagonal();
+    double Shift = 1e-8 * m_SymS.diagonal().cwiseAbs().maxCoeff();
+    pwd::ShiftInvertEigensolver EigSolver(m_SpectralTol);
+    EigSolver.SetBackend(m_Backend);
+    EigSolver.Compute(m_SymS, NumModes, Shift);
+    m_Evals = EigSolver.Eigenvalues();
+    m_Evecs = m_SqrtVolumes.asDiagonal() * EigSolver.Eigenvectors();
+}
+
+void pwd::WaterModel::RefineSlowModes()
+{
+    // The updated eigenpairs are only accurate up to the rounding errors of the fastest
+    // mode, which are large for the slowest ones
+    double Threshold = std::sqrt(std::numeric_limits<double>::epsilon()) * m_Evals.cwiseAbs().maxCoeff();
+    std::vector<int> Slow;
+    for (int m = 0; m < m_Evals.size(); ++m)
+    {
+        if (std::abs(m_Evals[m]) <= Threshold)
+            Slow.push_back(m);
+    }
+    int K = Slow.size();
+    if (K == 0)
+        return;
+
+    // With the pressures y = V^(-1) * x of the modes x, the energy is the sum of
+    // c_ij * (y_i - y_j)^2 over the edges plus the sum of L_i * V_i * y_i^2, and the
+    // mass is the sum of V_i * y_i^2
+    int n = m_Evecs.rows();
+    const std::vector<int>& Parents = m_Operator.Parents();
+    Eigen::MatrixXd Y(n, K);
+    for (int a = 0; a < K; ++a)
+        Y.col(a) = m_Evecs.col(Slow[a]).cwiseQuotient(m_Volumes);
+    Eigen::MatrixXd Terms(2 * n, K);
+    Eigen::VectorXd Weights(2 * n);
+    for (int i = 0; i < n; ++i)
+    {
+        int j = Parents[i];
+        Terms.row(i) = Y.row(i) - Y.row(j);
+        Weights[i] = j != i ? m_Operator.GetConductance(i, j) : 0.0;
+        Terms.row(n + i) = Y.row(i);
+        Weights[n + i] = m_Losses[i] * m_Volumes[i];
+    }
+    Eigen::MatrixXd Energy = Terms.transpose() * Weights.asDiagonal() * Terms;
+    Eigen::MatrixXd Mass = Y.transpose() * m_Volumes.asDiagonal() * Y;
+    Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> Ritz(-Energy, Mass);
+
+    Eigen::MatrixXd Modes(n, K);
+    for (int a = 0; a < K; ++a)
+        Modes.col(a) = m_Evecs.col(Slow[a]);
+    Modes = Modes * Ritz.eigenvectors();
+    for (int a = 0; a < K; ++a)
+    {
+        m_Evecs.col(Slow[a]) = Modes.col(a);
+        m_Evals[Slow[a]] = Ritz.eigenvalues()[a];
+    }
+}
+
+void pwd::WaterModel::ProjectSpectral()
+{
+    // H = Q * L * Q^T, hence the coefficients of w are Q^T * V^(-1/2) * w = m_Evecs^T * V^(-1) * w
+    m_Xi = m_Evecs.transpose() * m_StartWater.cwiseQuotient(m_Volumes);
     m_Xi2 = m_Xi;
-    End = std::chrono::system_clock::now();
-    std::chrono::system_clock::duration ElapsTimeChrono = End - Start;
-    unsigned long long ElapsTime;
-    ElapsTime = std::chrono::duration_cast<std::chrono::microseconds>(ElapsTimeChrono).count();
-    std::cout << "Elapsed time:        " << (ElapsTime / 1.0e6) << " seconds" << std::endl;
-}
\ No newline at end of file
+    ProjectSources();
+    m_SpectralTime = m_StartTime;
+    if (m_Evecs.cols() == m_Evecs.rows())
+        return;
+
+    // The part of the water outside the computed modes decays at least as fast as the
+    // fastest computed mode. Until it falls below the tolerance, the model is stepped.
+    Eigen::VectorXd Rest = (m_StartWater - m_Evecs * m_Xi).cwiseQuotient(m_SqrtVolumes);
+    double RestNorm = Rest.norm();
+    double Norm = m_StartWater.cwiseQuotient(m_SqrtVolumes).norm();
+    if (RestNorm <= m_SpectralTol * Norm)
+        return;
+    double Fastest = m_Evals.minCoeff();
+    if (Fastest >= 0.0)
+        m_SpectralTime = std::numeric_limits<double>::infinity();
+    else
+        m_SpectralTime += std::log(m_SpectralTol * Norm / RestNorm) / Fastest;
+}
+
+void pwd::WaterModel::BuildKrylov(double Tolerance)
+{
+    Assert(m_Sources.NumKnots() == 0);
+    ClearLossSchedule();
+    // Symmetrize the system as H = V^(-1/2) * S * V^(1/2), keeping it sparse
+    m_SymS = m_SqrtVolumes.cwiseInverse().asDiagonal() * m_S * m_SqrtVolumes.asDiagonal();
+    m_Krylov.SetTolerance(Tolerance);
+    m_Krylov.SetBackend(m_Backend);
+    m_Krylov.SetMatrix(m_SymS);
+
+    m_Mode = pwd::EvaluationMode::Krylov;
+    m_Water = m_Water0;
+    UpdateInputWater();
+    m_LastTime = 0.0;
+    m_StartWater = m_Water0;
+    m_StartTime = 0.0;
+}
+
+void pwd::WaterModel::BuildAdaptive(double RelTol, double AbsTol)
+{
+    Assert(m_Sources.NumKnots() == 0);
+    ClearLossSchedule();
+    m_Adaptive.SetTolerances(RelTol, AbsTol);
+    m_Adaptive.SetBackend(m_Backend);
+    m_Adaptive.SetMatrix(m_S);
+    m_Adaptive.Reset(m_Water0);
+
+    m_Mode = pwd::EvaluationMode::Adaptive;
+    m_Water = m_Water0;
+    UpdateInputWater();
+    m_LastTime = 0.0;
+    m_StartWater = m_Water0;
+    m_StartTime = 0.0;
+}
+
+
+void pwd::WaterModel::KillEdge(int i, int j) { SetEdgeAlive(NodeID(i), NodeID(j), false); }
+void pwd::WaterModel::ReviveEdge(int i, int j) { SetEdgeAlive(NodeID(i), NodeID(j), true); }
+bool pwd::WaterModel::IsEdgeDead(int i, int j) const { return IsDead(NodeID(i), NodeID(j)); }
+
+void pwd::WaterModel::SaveCheckpoint(const std::string& Filename) const
+{
+    pwd::BinaryWriter Writer;
+    Writer.Write<uint64_t>(CHECKPOINT_MAGIC);
+    Writer.Write<int32_t>(CHECKPOINT_VERSION);
+    Writer.Write<int32_t>((int32_t)m_Mode);
+    Writer.Write<int32_t>((int32_t)m_Backend);
+    Writer.Write<int64_t>(m_S.rows());
+    Writer.Write<int64_t>(m_S.nonZeros());
+
+    Writer.Write(m_LastTime);
+    Writer.Write(m_DT);
+    Writer.Write(m_StartTime);
+    Writer.Write(m_SpectralTime);
+    Writer.Write(m_SpectralTol);
+    Writer.WriteVector(m_Water0);
+    Writer.WriteVector(m_Water);
+    Writer.WriteVector(m_StartWater);
+    Writer.WriteVector(m_Losses);
+    // The values of the system matrix hold the loss rates and the dead edges
+    Writer.WriteArray(m_S.valuePtr(), m_S.nonZeros(), 1);
+    // The history is stored from the oldest state
+    Eigen::Matrix<double, Eigen::Dynamic, 6> History(m_Spt.rows(), 6);
+    for (int i = 0; i < 6; ++i)
+        History.col(i) = m_Spt.col((m_SptHead + i) % 6);
+    Writer.WriteMatrix(History);
+    Writer.Write(m_ClockStep);
+    Writer.Write(m_ClockStart);
+    Writer.Write<int64_t>(m_ClockSteps);
+    Writer.WriteVector(m_ClockWater);
+    // The schedule, with the losses of its segments and the ones restored by clearing it
+    Writer.Write<int32_t>(m_Segment);
+    if (m_Segment >= 0)
+    {
+        m_Schedule.Save(Writer);
+        Writer.Write(m_ScheduleStart);
+        Writer.WriteVector(m_BaseLosses);
+        for (const Eigen::VectorXd& Losses : m_SegmentLosses)
+            Writer.WriteVector(Losses);
+    }
+    m_Sources.Save(Writer);
+
+    switch (m_Mode)
+    {
+    case pwd::EvaluationMode::Stepping:
+        break;
+    case pwd::EvaluationMode::Spectral:
+        Writer.WriteVector(m_Evals);
+        Writer.WriteMatrix(m_Evecs);
+        Writer.WriteVector(m_Xi);
+        Writer.WriteVector(m_Xi2);
+        break;
+    case pwd::EvaluationMode::Krylov:
+        Writer.Write(m_Krylov.GetTolerance());
+        Writer.Write<int32_t>(m_Krylov.GetMaxBasis());
+        // The symmetrized matrix is patched by the changes of the dead edges, hence it
+        // is stored rather than computed again
+        Writer.WriteArray(m_SymS.valuePtr(), m_SymS.nonZeros(), 1);
+        break;
+    case pwd::EvaluationMode::Adaptive:
+        m_Adaptive.Save(Writer);
+        break;
+    }
+
+    // The factors of the tree backend are three vectors, storing them avoids the
+    // factorization when loading
+    const pwd::LinearSolver* Solver = nullptr;
+    if (m_Segment >= 0)
+        Solver = m_SegmentSolvers[m_Segment].get();
+    else if (m_DT > 0.0)
+        Solver = m_Solvers.Lookup(m_DT);
+    bool HasFactorization = Solver != nullptr && Solver->IsFactorized() &&
+                            Solver->GetBackend() == pwd::SolverBackend::Tree;
+    Writer.Write<int32_t>(HasFactorization ? 1 : 0);
+    if (HasFactorization)
+        Solver->SaveFactorization(Writer);
+
+    Writer.Save(Filename);
+}
+
+void pwd::WaterModel::LoadCheckpoint(const std::string& Filename)
+{
+    pwd::BinaryReader Reader(Filename);
+    LoadCheckpoint(Reader);
+}
+
+void pwd::WaterModel::LoadCheckpoint(const void* Data, size_t Size)
+{
+    pwd::BinaryReader Reader(Data, Size);
+    LoadCheckpoint(Reader);
+}
+
+void pwd::WaterModel::LoadCheckpoint(pwd::BinaryReader& Reader)
+{
+    Assert(Reader.Read<uint64_t>() == CHECKPOINT_MAGIC);
+    Assert(Reader.Read<int32_t>() == CHECKPOINT_VERSION);
+    int32_t Mode = Reader.Read<int32_t>();
+    int32_t Backend = Reader.Read<int32_t>();
+    Assert(Mode >= (int32_t)pwd::EvaluationMode::Stepping && Mode <= (int32_t)pwd::EvaluationMode::Adaptive);
+    Assert(Backend >= (int32_t)pwd::SolverBackend::SparseLU && Backend <= (int32_t)pwd::SolverBackend::ParallelTree);
+    Assert(Reader.Read<int64_t>() == m_S.rows());
+    Assert(Reader.Read<int64_t>() == m_S.nonZeros());
+    int n = m_S.rows();
+
+    m_LastTime = Reader.Read<double>();
+    m_DT = Reader.Read<double>();
+    m_StartTime = Reader.Read<double>();
+    m_SpectralTime = Reader.Read<double>();
+    m_SpectralTol = Reader.Read<double>();
+    m_Water0 = Reader.ReadVector();
+    m_Water = Reader.ReadVector();
+    m_StartWater = Reader.ReadVector();
+    m_Losses = Reader.ReadVector();
+    Eigen::Map<const Eigen::VectorXd> Values = Reader.ReadVector();
+    m_Spt = Reader.ReadMatrix();
+    m_SptHead = 0;
+    m_ClockStep = Reader.Read<double>();
+    m_ClockStart = Reader.Read<double>();
+    m_ClockSteps = Reader.Read<int64_t>();
+    m_ClockWater = Reader.ReadVector();
+    m_Segment = Reader.Read<int32_t>();
+    m_SegmentLosses.clear();
+    m_SegmentSolvers.clear();
+    if (m_Segment >= 0)
+    {
+        m_Schedule.Load(Reader);
+        m_ScheduleStart = Reader.Read<double>();
+        m_BaseLosses = Reader.ReadVector();
+        Assert(m_Segment < m_Schedule.NumSegments() && m_BaseLosses.size() == n);
+        // The solvers of the segments are factorized again when needed
+        for (int s = 0; s < m_Schedule.NumSegments(); ++s)
+        {
+            m_SegmentLosses.push_back(Reader.ReadVector());
+            Assert(m_SegmentLosses.back().size() == n);
+            m_SegmentSolvers.push_back(std::make_unique<pwd::LinearSolver>((pwd::SolverBackend)Backend));
+            m_SegmentSolvers.back()->SetThreadPool(m_Pool);
+        }
+    }
+    m_Sources.Load(Reader);
+    Assert(m_Sources.NumKnots() == 0 || m_Sources.Size() == n);
+    if (!m_InputIDs.empty())
+    {
+        m_InputSources = pwd::SourceProfile(m_Sources.GetInterpolation());
+        for (int k = 0; k < m_Sources.NumKnots(); ++k)
+            m_InputSources.AddKnot(m_Sources.Time(k), m_Sources.Values().col(k)(m_NodeIDs));
+    }
+    Assert(m_Water0.size() == n && m_Water.size() == n && m_StartWater.size() == n);
+    Assert(m_ClockWater.size() == n);
+    Assert(m_Losses.size() == n && Values.size() == m_S.nonZeros() && m_Spt.rows() == n);
+    m_InputWater0 = m_NodeIDs.empty() ? Eigen::VectorXd() : Eigen::VectorXd(m_Water0(m_NodeIDs));
+    UpdateInputWater();
+    std::copy(Values.data(), Values.data() + Values.size(), m_S.valuePtr());
+    UpdateOperator();
+
+    m_Mode = (pwd::EvaluationMode)Mode;
+    SetSolverBackend((pwd::SolverBackend)Backend);
+    switch (m_Mode)
+    {
+    case pwd::EvaluationMode::Stepping:
+        break;
+    case pwd::EvaluationMode::Spectral:
+        m_Evals = Reader.ReadVector();
+        m_Evecs = Reader.ReadMatrix();
+        m_Xi = Reader.ReadVector();
+        m_Xi2 = Reader.ReadVector();
+        Assert(m_Evecs.rows() == n && m_Evecs.cols() == m_Evals.size());
+        Assert(m_Xi.size() == m_Evals.size() && m_Xi2.size() == m_Evals.size());
+        Assert(m_Sources.NumKnots() == 0 || m_Evecs.cols() == n);
+        m_SymS = m_SqrtVolumes.cwiseInverse().asDiagonal() * m_S * m_SqrtVolumes.asDiagonal();
+        ProjectSources();
+        break;
+    case pwd::EvaluationMode::Krylov:
+    {
+        double Tolerance = Reader.Read<double>();
+        m_Krylov.SetMaxBasis(Reader.Read<int32_t>());
+        m_SymS = m_SqrtVolumes.cwiseInverse().asDiagonal() * m_S * m_SqrtVolumes.asDiagonal();
+        Eigen::Map<const Eigen::VectorXd> SymValues = Reader.ReadVector();
+        Assert(SymValues.size() == m_SymS.nonZeros());
+        std::copy(SymValues.data(), SymValues.data() + SymValues.size(), m_SymS.valuePtr());
+        m_Krylov.SetTolerance(Tolerance);
+        m_Krylov.SetMatrix(m_SymS);
+        break;
+    }
+    case pwd::EvaluationMode::Adaptive:
+        m_Adaptive.SetMatrix(m_S);
+        m_Adaptive.Load(Reader);
+        break;
+    }
+    Assert(m_Sources.NumKnots() == 0 || m_Mode == pwd::EvaluationMode::Stepping ||
+           m_Mode == pwd::EvaluationMode::Spectral);
+
+    // The factorization of the time step is deterministic, computing it again gives
+    // the same steps of the saved model
+    bool HasFactorization = Reader.Read<int32_t>() != 0;
+    m_Solvers.Clear();
+    if (m_Segment >= 0 && HasFactorization)
+    {
+        pwd::LinearSolver* Solver = m_SegmentSolvers[m_Segment].get();
+        UpdateStepMatrix(m_DT);
+        m_Solvers.Analyze(*Solver, m_StepMatrix);
+        Solver->LoadFactorization(Reader);
+    }
+    else if (m_Segment < 0 && m_DT > 0.0)
+    {
+        pwd::LinearSolver* Solver = m_Solvers.Insert(m_DT);
+        if (HasFactorization)
+        {
+            Solver->SetBackend(m_Backend);
+            UpdateStepMatrix(m_DT);
+            if (!Solver->IsAnalyzed())
+                m_Solvers.Analyze(*Solver, m_StepMatrix);
+            Solver->LoadFactorization(Reader);
+        }
+        else
+            FactorizeStep(*Solver, m_DT);
+    }
+}
+
+void pwd::WaterModel::SetLossSchedule(const pwd::LossSchedule& Schedule)
+{
+    int n = m_Graph->NumNodes();
+    Assert(m_Mode == pwd::EvaluationMode::Stepping);
+    Assert(Schedule.NumSegments() > 0);
+    Assert(Schedule.LossRates(0).size() == n);
+
+    if (m_Segment < 0)
+        m_BaseLosses = m_Losses;
+    Eigen::VectorXd Areas(n);
+    for (int i = 0; i < n; ++i)
+        Areas[i] = m_Graph->GetNode(i)->Area();
+    m_Schedule = Schedule;
+    m_ScheduleStart = m_LastTime;
+    m_SegmentLosses.clear();
+    m_SegmentSolvers.clear();
+    for (int s = 0; s < Schedule.NumSegments(); ++s)
+    {
+        if (m_InputIDs.empty())
+            m_SegmentLosses.push_back(Schedule.LossRates(s).cwiseProduct(Areas));
+        else
+            m_SegmentLosses.push_back(Schedule.LossRates(s)(m_InputIDs).cwiseProduct(Areas));
+        m_SegmentSolvers.push_back(std::make_unique<pwd::LinearSolver>(m_Backend));
+        m_SegmentSolvers.back()->SetThreadPool(m_Pool);
+    }
+    m_Segment = 0;
+    SetLosses(m_SegmentLosses[0]);
+    // The time stepping solvers are factorized again when the schedule is cleared
+    m_Solvers.Clear();
+}
+
+void pwd::WaterModel::ClearLossSchedule()
+{
+    if (m_Segment < 0)
+        return;
+    SetLosses(m_BaseLosses);
+    m_SegmentLosses.clear();
+    m_SegmentSolvers.clear();
+    m_Segment = -1;
+    m_Solvers.Clear();
+}
+
+bool pwd::WaterModel::HasLossSchedule() const { return m_Segment >= 0; }
+
+
+void pwd::WaterModel::SetSources(const pwd::SourceProfile& Sources)
+{
+    bool FullSpectral = m_Mode == pwd::EvaluationMode::Spectral && m_Evecs.cols() == m_Evecs.rows();
+    Assert(m_Mode == pwd::EvaluationMode::Stepping || FullSpectral);
+    Assert(Sources.NumKnots() == 0 || Sources.Size() == m_Graph->NumNodes());
+    m_Sources = Sources;
+    if (!m_InputIDs.empty())
+    {
+        m_InputSources = Sources;
+        m_Sources = pwd::SourceProfile(Sources.GetInterpolation());
+        for (int k = 0; k < Sources.NumKnots(); ++k)
+            m_Sources.AddKnot(Sources.Time(k), Sources.Values().col(k)(m_InputIDs));
+    }
+
+    // The inflows apply from the last evaluated state
+    m_StartWater = m_Water;
+    m_StartTime = m_LastTime;
+    if (FullSpectral)
+        ProjectSpectral();
+}
+
+void pwd::WaterModel::ClearSources()
+{
+    if (m_Sources.NumKnots() > 0)
+        SetSources(pwd::SourceProfile());
+}
+
+const pwd::SourceProfile& pwd::WaterModel::GetSources() const
+{
+    return m_InputIDs.empty() ? m_Sources : m_InputSources;
+}
+
+void pwd::WaterModel::ProjectSources()
+{
+    if (m_Sources.NumKnots() == 0)
+        m_SourceCoeffs.resize(m_Evecs.cols(), 0);
+    else
+        m_SourceCoeffs = m_Evecs.transpose() * m_Sources.Values().cwiseQuotient(
+                             m_Volumes.replicate(1, m_Sources.NumKnots()));
+}
+
+void pwd::WaterModel::AddSourceModes(double Time, Eigen::Ref<Eigen::VectorXd> Coeffs) const
+{
+    int NumKnots = m_Sources.NumKnots();
+    bool Linear = m_Sources.GetInterpolation() == pwd::Interpolation::Linear;
+    for (int k = 0; k < NumKnots; ++k)
+    {
+        // The part of the piece k between the starting time and the evaluation time
+        double p = m_Sources.Time(k);
+        if (p >= Time)
+            break;
+        double u = std::max(p, m_StartTime);
+        double v = k + 1 < NumKnots ? std::min(m_Sources.Time(k + 1), Time) : Time;
+        if (v <= u)
+            continue;
+
+        // On the piece, the inflow of mode m is Beta + (s - p) * Gamma. With s = v - r,
+        // its convolution is exp((t - v) * L) * int_0^(v - u) exp(r * L) * b(v - r) dr.
+        double Slope = Linear && k + 1 < NumKnots ? 1.0 / (m_Sources.Time(k + 1) - p) : 0.0;
+        for (int m = 0; m < Coeffs.rows(); ++m)
+        {
+            double Beta = m_SourceCoeffs(m, k);
+            double Gamma = Slope == 0.0 ? 0.0 : Slope * (m_SourceCoeffs(m, k + 1) - Beta);
+            double Phi, Psi;
+            DuhamelWeights(m_Evals[m], v - u, Phi, Psi);
+            Coeffs[m] += std::exp(m_Evals[m] * (Time - v)) * ((Beta + (v - p) * Gamma) * Phi - Gamma * Psi);
+        }
+    }
+}
+
+void pwd::WaterModel::SetLosses(const Eigen::VectorXd& Losses)
+{
+    double* Vals = m_S.valuePtr();
+    for (int i = 0; i < m_S.cols(); ++i)
+        Vals[m_DiagIdx[i]] += m_Losses[i] - Losses[i];
+    m_Losses = Losses;
+    m_Operator.SetLosses(m_Losses);
+}
+
+void pwd::WaterModel::UpdateStepMatrix(double DT)
+{
+    const double* Vals = m_S.valuePtr();
+    double* StepVals = m_StepMatrix.valuePtr();
+    double Scale = -BDF6_ALPHA * DT;
+    for (int k = 0; k < m_S.nonZeros(); ++k)
+        StepVals[k] = Scale * Vals[k];
+    for (int i = 0; i < m_S.cols(); ++i)
+        StepVals[m_DiagIdx[i]] += 1.0;
+}
+
+void pwd::WaterModel::FactorizeStep(pwd::LinearSolver& Solver, double DT)
+{
+    Solver.SetBackend(m_Backend);
+    UpdateStepMatrix(DT);
+    // The pattern is analyzed once for the cache and the schedule
+    if (!Solver.IsAnalyzed())
+        m_Solvers.Analyze(Solver, m_StepMatrix);
+    Solver.Factorize(m_StepMatrix);
+}
+
+pwd::LinearSolver& pwd::WaterModel::StepSolver(double DT)
+{
+    pwd::LinearSolver* Solver = m_Solvers.Find(DT, 1e-7);
+    if (Solver == nullptr)
+    {
+        Solver = m_Solvers.Insert(DT);
+        FactorizeStep(*Solver, DT);
+    }
+    return *Solver;
+}
+
+void pwd::WaterModel::ReleaseEigenvectors(Eigen::MatrixXd& Evecs)
+{
+    Assert(m_Mode == pwd::EvaluationMode::Spectral);
+    Evecs.swap(m_Evecs);
+    m_Evecs.resize(0, 0);
+}
+
+void pwd::WaterModel::UpdateOperator()
+{
+    m_Operator.SetLosses(m_Losses);
+    const std::vector<int>& Parents = m_Operator.Parents();
+    for (int i = 0; i < m_Operator.Size(); ++i)
+    {
+        int j = Parents[i];
+        if (j == i)
+            continue;
+        double FResLoc = PRESS_CONST * 0.5 * (m_FlowRes[i] + m_FlowRes[j]);
+        m_Operator.SetConductance(i, j, IsDead(i, j) ? 0.0 : FResLoc);
+    }
+}
+
+void pwd::WaterModel::ApplySystem(const Eigen::Ref<const Eigen::VectorXd>& In,
+                                  Eigen::Ref<Eigen::VectorXd> Out) const
+{
+    m_Operator.Apply(In, Out);
+}
+
+bool pwd::WaterModel::IsDead(int i, int j) const
+{
+    Assert(i != j);
+    // Alive edges always have a positive flow
+    return m_S.valuePtr()[pwd::EntryIndex(m_S, i, j)] == 0.0;
+}
+
+int pwd::WaterModel::NodeID(int InputID) const
+{
+    Assert(InputID >= 0 && InputID < m_Graph->NumNodes());
+    return m_NodeIDs.empty() ? InputID : m_NodeIDs[InputID];
+}
+
+void pwd::WaterModel::UpdateInputWater()
+{
+    if (!m_NodeIDs.empty())
+        m_InputWater = m_Water(m_NodeIDs);
+}
+
+void pwd::WaterModel::SetEdgeAlive(int i, int j, bool Alive)
+{
+    Assert(i != j);
+    Assert(i >= 0 && i < m_Graph->NumNodes());
+    Assert(j >= 0 && j < m_Graph->NumNodes());
+    // Dead edges are kept in the pattern, hence any edge of the graph is found
+    int IdxII = pwd::EntryIndex(m_S, i, i);
+    int IdxIJ = pwd::EntryIndex(m_S, i, j);
+    int IdxJI = pwd::EntryIndex(m_S, j, i);
+    int IdxJJ = pwd::EntryIndex(m_S, j, j);
+    double* Vals = m_S.valuePtr();
+    if ((Vals[IdxIJ] != 0.0) == Alive)
+        return;
+
+    // Same entries of S = PRESS_CONST * Adj * V^(-1) - diag(Losses) built by Initialize(),
+    // with the same operations, so that the matrix only depends on the dead edges and
+    // not on the order they were killed and revived in
+    double FResLoc = 0.5 * (m_FlowRes[i] + m_FlowRes[j]);
+    Vals[IdxIJ] = Alive ? PRESS_CONST * FResLoc * (1.0 / m_Volumes[j]) : 0.0;
+    Vals[IdxJI] = Alive ? PRESS_CONST * FResLoc * (1.0 / m_Volumes[i]) : 0.0;
+    auto Diagonal = [&](int k) {
+        const pwd::Node* N = m_Graph->GetNode(k);
+        double FRes = 0.0;
+        for (int ch = 0; ch < N->Degree(); ++ch)
+        {
+            int l = m_Graph->GetNodeID(N->GetAdjacent(ch));
+            if (!IsDead(k, l))
+                FRes += 0.5 * (m_FlowRes[k] + m_FlowRes[l]);
+        }
+        return PRESS_CONST * -FRes * (1.0 / m_Volumes[k]) - m_Losses[k];
+    };
+    Vals[IdxII] = Diagonal(i);
+    Vals[IdxJJ] = Diagonal(j);
+    double Sign = Alive ? 1.0 : -1.0;
+    FResLoc *= PRESS_CONST;
+    m_Operator.SetConductance(i, j, Alive ? FResLoc : 0.0);
+    std::vector<int> Nodes = { i, j };
+
+    // The change applies from the last evaluated state
+    m_StartWater = m_Water;
+    m_StartTime = m_LastTime;
+
+    // Time stepping, also used by the truncated spectral mode. The factorization of
+    // the current time step is updated, the other ones are computed again when needed
+    pwd::LinearSolver* Solver = m_Segment < 0 ? m_Solvers.Find(m_DT, 1e-7) : nullptr;
+    if (Solver != nullptr)
+    {
+        UpdateStepMatrix(m_DT);
+        Solver->Refactorize(m_StepMatrix, Nodes);
+    }
+    m_Solvers.Clear(Solver);
+    // The factorizations of the schedule are computed again when needed
+    for (auto& Solver : m_SegmentSolvers)
+        Solver->Clear();
+
+    switch (m_Mode)
+    {
+    case pwd::EvaluationMode::Stepping:
+        break;
+
+    case pwd::EvaluationMode::Spectral:
+        if (m_Evecs.cols() < m_Evecs.rows())
+        {
+            // A partial decomposition cannot be updated, the slow modes are computed again
+            ComputeSlowModes(m_Evecs.cols());
+        }
+        else
+        {
+            // The symmetrized system changes by -Sign * FResLoc * u * u^T, with
+            // u = e_i / sqrt(V_i) - e_j / sqrt(V_j), and Q^T * u = m_Evecs^T * V^(-1) * u
+            Eigen::VectorXd z = m_Evecs.row(i).transpose() / m_Volumes[i] -
+                                m_Evecs.row(j).transpose() / m_Volumes[j];
+            pwd::RankOneEigenUpdate(m_Evals, m_Evecs, z, -Sign * FResLoc);
+            RefineSlowModes();
+        }
+        ProjectSpectral();
+        break;
+
+    case pwd::EvaluationMode::Krylov:
+    {
+        // Same entries of V^(-1/2) * S * V^(1/2) built by BuildKrylov()
+        double* SymVals = m_SymS.valuePtr();
+        SymVals[IdxII] = (1.0 / m_SqrtVolumes[i]) * Vals[IdxII] * m_SqrtVolumes[i];
+        SymVals[IdxIJ] = (1.0 / m_SqrtVolumes[i]) * Vals[IdxIJ] * m_SqrtVolumes[j];
+        SymVals[IdxJI] = (1.0 / m_SqrtVolumes[j]) * Vals[IdxJI] * m_SqrtVolumes[i];
+        SymVals[IdxJJ] = (1.0 / m_SqrtVolumes[j]) * Vals[IdxJJ] * m_SqrtVolumes[j];
+        m_Krylov.UpdateMatrix(m_SymS, Nodes);
+        break;
+    }
+
+    case pwd::EvaluationMode::Adaptive:
+        m_Adaptive.UpdateMatrix(m_S, Nodes);
+        m_Adaptive.Reset(m_Water, m_LastTime);
+        break;
+    }
+}
\ No newline at end of file